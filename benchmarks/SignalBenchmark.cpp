@@ -0,0 +1,452 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+// Compares the signal implementations of the library:
+//
+//   SignalBenchmark [--json FILE]
+//
+// Prints a table with the results, and writes them as JSON to FILE
+// (to compare releases). It does not use any widget, so it can be
+// built on any platform (see VACA_BUILD_BENCHMARKS).
+
+#include "Wg/Signal.hpp"
+#include "Wg/Signal2.hpp"
+#include "Wg/SignalN.hpp"
+#include "Wg/ConcurrentSignal.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Wg;
+
+// Number of slots to measure connect/disconnect and memory
+#define CONNECTIONS       1000
+
+// Minimum time of each measure (the best of MEASURE_RUNS is used)
+#define MEASURE_SECONDS   0.01
+#define MEASURE_RUNS      5
+
+// Threads that emit the same signal in the cross-thread benchmark
+#define EMITTER_THREADS   4
+
+//////////////////////////////////////////////////////////////////////
+// Memory accounting
+
+static std::atomic<long long> live_bytes(0);
+
+// Each block has a header with its size, so the freed bytes can be
+// subtracted (the header has the size of the biggest alignment)
+#define HEADER_SIZE       sizeof(std::max_align_t)
+
+void* operator new(std::size_t size)
+{
+  void* ptr = std::malloc(size + HEADER_SIZE);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+
+  *static_cast<std::size_t*>(ptr) = size;
+  live_bytes += static_cast<long long>(size);
+  return static_cast<char*>(ptr) + HEADER_SIZE;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  if (ptr != nullptr) {
+    void* block = static_cast<char*>(ptr) - HEADER_SIZE;
+    live_bytes -= static_cast<long long>(*static_cast<std::size_t*>(block));
+    std::free(block);
+  }
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { operator delete(ptr); }
+
+//////////////////////////////////////////////////////////////////////
+// Results
+
+struct Result {
+  std::string benchmark;
+  std::string signal;
+  double value;
+  const char* unit;
+};
+
+static std::vector<Result> results;
+static std::vector<std::string> benchmark_names;
+static std::vector<std::string> signal_names;
+
+static void add_unique(std::vector<std::string>& names, const std::string& name)
+{
+  for (const auto& other : names)
+    if (other == name)
+      return;
+  names.push_back(name);
+}
+
+static void add_result(const std::string& benchmark, const char* signal,
+                       double value, const char* unit)
+{
+  results.push_back(Result{ benchmark, signal, value, unit });
+  add_unique(benchmark_names, benchmark);
+  add_unique(signal_names, signal);
+}
+
+// Returns the nanoseconds that takes each call to "f" (the best time
+// of some runs, each one of at least MEASURE_SECONDS)
+template<typename F>
+static double measure(F f)
+{
+  typedef std::chrono::steady_clock clock;
+
+  double best = 0.0;
+  unsigned iterations = 1;
+
+  for (int run=0; run<MEASURE_RUNS; ) {
+    const clock::time_point start = clock::now();
+    for (unsigned i=0; i<iterations; ++i)
+      f();
+    const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+    // Calibrate the number of iterations in the first runs
+    if (seconds < MEASURE_SECONDS && iterations < (1u << 30)) {
+      iterations *= 2;
+      continue;
+    }
+
+    const double ns = seconds * 1e9 / iterations;
+    if (run == 0 || ns < best)
+      best = ns;
+    ++run;
+  }
+
+  return best;
+}
+
+//////////////////////////////////////////////////////////////////////
+// Adapters of the signals (all of them are void(int) signals
+// connected to Receiver::onValue)
+
+struct Receiver {
+  long sum = 0;
+  void onValue(int value) { sum += value; }
+};
+
+// Signal1<void, int> of Signal.hpp
+struct LegacyAdapter {
+  typedef Signal1<void, int> SignalType;
+  typedef Slot1<void, int>* Handle;
+  enum { Copyable = true, ThreadSafe = false };
+
+  static const char* getName() { return "Signal1"; }
+
+  static Handle connect(SignalType& s, Receiver* r) {
+    return s.connect(&Receiver::onValue, r);
+  }
+
+  static void disconnect(SignalType& s, Handle& h) {
+    s.disconnect(h);
+    delete h;                   // it is not deleted by the signal
+  }
+
+  static void emit(SignalType& s, int value) { s(value); }
+};
+
+// Signal<void(int)> of Signal2.hpp
+struct Signal2Adapter {
+  typedef UniqueSignal<void(int)> SignalType;
+  typedef Callback<void(int)> Handle;
+  enum { Copyable = false, ThreadSafe = false };
+
+  static const char* getName() { return "Signal2"; }
+
+  static Handle connect(SignalType& s, Receiver* r) {
+    Handle h;
+    h.Use<Receiver, &Receiver::onValue>(r);
+    s.Connect(h);
+    return h;
+  }
+
+  static void disconnect(SignalType& s, Handle& h) { s.Disconnect(h); }
+
+  static void emit(SignalType& s, int value) { s.Emit(value); }
+};
+
+struct SignalNAdapter {
+  typedef SignalN<void(int)> SignalType;
+  typedef Connection Handle;
+  enum { Copyable = true, ThreadSafe = false };
+
+  static const char* getName() { return "SignalN"; }
+
+  static Handle connect(SignalType& s, Receiver* r) {
+    return s.connect(&Receiver::onValue, r);
+  }
+
+  static void disconnect(SignalType&, Handle& h) { h.disconnect(); }
+
+  static void emit(SignalType& s, int value) { s(value); }
+};
+
+struct ConcurrentAdapter {
+  typedef ConcurrentSignal<void(int)> SignalType;
+  typedef Receiver* Handle;
+  enum { Copyable = false, ThreadSafe = true };
+
+  static const char* getName() { return "ConcurrentSignal"; }
+
+  static Handle connect(SignalType& s, Receiver* r) {
+    s.connect(&Receiver::onValue, r);
+    return r;
+  }
+
+  static void disconnect(SignalType& s, Handle& h) {
+    s.disconnect(&Receiver::onValue, h);
+  }
+
+  static void emit(SignalType& s, int value) { s(value); }
+};
+
+//////////////////////////////////////////////////////////////////////
+// Benchmarks
+
+template<class Adapter>
+static void bench_connect_disconnect()
+{
+  typedef typename Adapter::SignalType SignalType;
+  typedef typename Adapter::Handle Handle;
+
+  std::vector<Receiver> receivers(CONNECTIONS);
+  std::vector<Handle> handles(CONNECTIONS);
+  SignalType s;
+
+  // Connects all the slots and disconnects them in the same order
+  // (the worst case for an array that is searched)
+  double ns = measure([&] {
+      for (int i=0; i<CONNECTIONS; ++i)
+        handles[i] = Adapter::connect(s, &receivers[i]);
+      for (int i=0; i<CONNECTIONS; ++i)
+        Adapter::disconnect(s, handles[i]);
+    });
+
+  add_result("connect+disconnect (1000 slots)", Adapter::getName(),
+             ns / CONNECTIONS, "ns");
+}
+
+template<class Adapter>
+static void bench_emit(int slots)
+{
+  typedef typename Adapter::SignalType SignalType;
+
+  std::vector<Receiver> receivers(slots);
+  SignalType s;
+  for (int i=0; i<slots; ++i)
+    Adapter::connect(s, &receivers[i]);
+
+  int value = 0;
+  double ns = measure([&] { Adapter::emit(s, ++value); });
+
+  add_result("emit (" + std::to_string(slots) + " slots)", Adapter::getName(), ns, "ns");
+}
+
+template<class Adapter>
+static void bench_memory()
+{
+  typedef typename Adapter::SignalType SignalType;
+  typedef typename Adapter::Handle Handle;
+
+  std::vector<Receiver> receivers(CONNECTIONS);
+  std::vector<Handle> handles;
+  handles.reserve(CONNECTIONS);
+
+  SignalType* s = new SignalType;
+  const long long before = live_bytes;
+  for (int i=0; i<CONNECTIONS; ++i)
+    handles.push_back(Adapter::connect(*s, &receivers[i]));
+  const long long after = live_bytes;
+
+  add_result("memory per connection", Adapter::getName(),
+             static_cast<double>(after - before) / CONNECTIONS, "bytes");
+  add_result("signal size", Adapter::getName(),
+             static_cast<double>(sizeof(SignalType)), "bytes");
+
+  delete s;
+}
+
+template<class Adapter>
+static void bench_copy()
+{
+  typedef typename Adapter::SignalType SignalType;
+
+  if constexpr (Adapter::Copyable) {
+    std::vector<Receiver> receivers(8);
+    SignalType s;
+    for (auto& r : receivers)
+      Adapter::connect(s, &r);
+
+    double ns = measure([&] {
+        SignalType copy(s);
+        Adapter::emit(copy, 0);
+      });
+
+    add_result("copy + emit (8 slots)", Adapter::getName(), ns, "ns");
+  }
+}
+
+// Emission from EMITTER_THREADS threads at the same time while other
+// thread connects and disconnects a slot
+template<class Adapter>
+static void bench_cross_thread()
+{
+  typedef typename Adapter::SignalType SignalType;
+
+  if constexpr (Adapter::ThreadSafe) {
+    std::vector<Receiver> receivers(8);
+    SignalType s;
+    for (auto& r : receivers)
+      Adapter::connect(s, &r);
+
+    std::atomic<bool> start(false), stop(false);
+    std::atomic<long long> emissions(0);
+    std::vector<std::thread> threads;
+
+    for (int t=0; t<EMITTER_THREADS; ++t)
+      threads.emplace_back([&] {
+          long long count = 0;
+          while (!start)
+            std::this_thread::yield();
+          while (!stop) {
+            Adapter::emit(s, 1);
+            ++count;
+          }
+          emissions += count;
+        });
+
+    threads.emplace_back([&] {
+        Receiver r;
+        while (!start)
+          std::this_thread::yield();
+        while (!stop) {
+          auto h = Adapter::connect(s, &r);
+          Adapter::disconnect(s, h);
+        }
+      });
+
+    typedef std::chrono::steady_clock clock;
+    const clock::time_point t0 = clock::now();
+    start = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    stop = true;
+    for (auto& thread : threads)
+      thread.join();
+    const double seconds = std::chrono::duration<double>(clock::now() - t0).count();
+
+    // Time of each emission in each thread
+    add_result("emit from " + std::to_string(EMITTER_THREADS) + " threads (8 slots)",
+               Adapter::getName(),
+               seconds * 1e9 * EMITTER_THREADS / static_cast<double>(emissions),
+               "ns");
+  }
+}
+
+template<class Adapter>
+static void bench_all()
+{
+  bench_connect_disconnect<Adapter>();
+  bench_emit<Adapter>(0);
+  bench_emit<Adapter>(1);
+  bench_emit<Adapter>(8);
+  bench_emit<Adapter>(64);
+  bench_memory<Adapter>();
+  bench_copy<Adapter>();
+  bench_cross_thread<Adapter>();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Output
+
+static const Result* find_result(const std::string& benchmark, const std::string& signal)
+{
+  for (const auto& result : results)
+    if (result.benchmark == benchmark && result.signal == signal)
+      return &result;
+  return nullptr;
+}
+
+static void print_table()
+{
+  std::printf("%-40s", "benchmark");
+  for (const auto& signal : signal_names)
+    std::printf(" %18s", signal.c_str());
+  std::printf("\n");
+
+  for (const auto& benchmark : benchmark_names) {
+    std::printf("%-40s", benchmark.c_str());
+    for (const auto& signal : signal_names) {
+      const Result* result = find_result(benchmark, signal);
+      if (result != nullptr)
+        std::printf(" %12.1f %-5s", result->value, result->unit);
+      else
+        std::printf(" %18s", "-");
+    }
+    std::printf("\n");
+  }
+}
+
+static bool write_json(const char* filename)
+{
+  FILE* f = std::fopen(filename, "w");
+  if (f == nullptr)
+    return false;
+
+  std::fprintf(f, "{\n  \"version\": \"%d.%d.%d\",\n  \"results\": [\n",
+               VACA_VERSION, VACA_SUB_VERSION, VACA_WIP_VERSION);
+  for (std::size_t i=0; i<results.size(); ++i) {
+    const Result& result = results[i];
+    std::fprintf(f, "    { \"benchmark\": \"%s\", \"signal\": \"%s\", \"value\": %.3f, \"unit\": \"%s\" }%s\n",
+                 result.benchmark.c_str(), result.signal.c_str(),
+                 result.value, result.unit,
+                 i+1 < results.size() ? ",": "");
+  }
+  std::fprintf(f, "  ]\n}\n");
+
+  return std::fclose(f) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+  const char* json = nullptr;
+
+  for (int i=1; i<argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0 && i+1 < argc)
+      json = argv[++i];
+    else {
+      std::fprintf(stderr, "Usage: %s [--json FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  bench_all<LegacyAdapter>();
+  bench_all<Signal2Adapter>();
+  bench_all<SignalNAdapter>();
+  bench_all<ConcurrentAdapter>();
+
+  print_table();
+
+  if (json != nullptr && !write_json(json)) {
+    std::fprintf(stderr, "Error writing '%s'\n", json);
+    return 1;
+  }
+  return 0;
+}
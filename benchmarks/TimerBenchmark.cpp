@@ -0,0 +1,304 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+// Compares the TimerWheel used by the Timer thread (with and without
+// slack, see Timer::setSlack) with the linear scan that it replaced,
+// using 100k timers:
+//
+//   TimerBenchmark [--json FILE]
+//
+// The time of the timers is simulated (both schedulers receive the
+// same times), so only the cost of the scheduler is measured. It does
+// not use any widget, so it can be built on any platform (see
+// VACA_BUILD_BENCHMARKS).
+
+#include "Wg/TimerWheel.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace Wg;
+
+// Number of running timers
+#define TIMERS            100000
+
+// Timers stopped in the "stop" benchmark (the linear scheduler
+// removes each one in O(n))
+#define STOPPED_TIMERS    1000
+
+// Simulated time of the "run" benchmark
+#define SIMULATED_MSECS   2000
+
+// Slack of the timers in the "wheel+slack" scheduler
+#define SLACK_MSECS       50
+
+typedef std::chrono::steady_clock BenchmarkClock;
+
+static double get_seconds(BenchmarkClock::time_point start)
+{
+  return std::chrono::duration<double>(BenchmarkClock::now() - start).count();
+}
+
+//////////////////////////////////////////////////////////////////////
+// Results
+
+struct Result {
+  std::string benchmark;
+  std::string scheduler;
+  double value;
+  const char* unit;
+};
+
+static std::vector<Result> results;
+static std::vector<std::string> benchmark_names;
+static std::vector<std::string> scheduler_names;
+
+static void add_unique(std::vector<std::string>& names, const std::string& name)
+{
+  for (const auto& other : names)
+    if (other == name)
+      return;
+  names.push_back(name);
+}
+
+static void add_result(const std::string& benchmark, const char* scheduler,
+                       double value, const char* unit)
+{
+  results.push_back(Result{ benchmark, scheduler, value, unit });
+  add_unique(benchmark_names, benchmark);
+  add_unique(scheduler_names, scheduler);
+}
+
+//////////////////////////////////////////////////////////////////////
+// Schedulers. Each one has the intervals (in milliseconds) of the
+// timers, and counts the generated ticks.
+
+// The previous loop of Timer::run_timer_thread: each iteration
+// decrements the counter of all the timers, and stopping a timer
+// searches it in the vector
+struct LinearScheduler {
+  static const char* getName() { return "linear"; }
+
+  struct Item {
+    int id;
+    int interval;
+    int timeCounter;
+  };
+
+  std::vector<Item> items;
+  long long ticks = 0;
+  long long wakeups = 0;
+
+  void start(int id, int interval, int) {
+    items.push_back(Item{ id, interval, interval });
+  }
+
+  void stop(int id) {
+    for (auto it = items.begin(); it != items.end(); ++it)
+      if (it->id == id) {
+        items.erase(it);
+        break;
+      }
+  }
+
+  // The previous thread did an iteration each millisecond (at least,
+  // it did not sleep while there were running timers)
+  void run(int msecs) {
+    for (int now=1; now<=msecs; ++now) {
+      ++wakeups;
+      for (Item& item : items) {
+        item.timeCounter -= 1;
+        while (item.timeCounter <= 0) {
+          ++ticks;
+          item.timeCounter += item.interval;
+        }
+      }
+    }
+  }
+};
+
+template<int SlackMsecs>
+struct WheelScheduler {
+  static const char* getName() { return SlackMsecs == 0 ? "wheel": "wheel+slack"; }
+
+  struct Item {
+    TimerWheel::Entry entry;
+    TimerWheel::Nanoseconds interval;
+    TimerWheel::Nanoseconds deadline;
+  };
+
+  std::vector<Item> items;
+  TimerWheel wheel;
+  std::vector<TimerWheel::Entry*> expired;
+  long long ticks = 0;
+  long long wakeups = 0;
+
+  WheelScheduler() : items(TIMERS), wheel(1000000, 0) { }
+
+  void start(int id, int interval, int now) {
+    Item& item = items[id];
+    item.entry.data = &item;
+    item.interval = static_cast<TimerWheel::Nanoseconds>(interval) * 1000000;
+    item.deadline = static_cast<TimerWheel::Nanoseconds>(now) * 1000000 + item.interval;
+    wheel.schedule(&item.entry, item.deadline, slack());
+  }
+
+  void stop(int id) {
+    wheel.cancel(&items[id].entry);
+  }
+
+  static TimerWheel::Nanoseconds slack() {
+    return static_cast<TimerWheel::Nanoseconds>(SlackMsecs) * 1000000;
+  }
+
+  // Like the new Timer thread: it sleeps until the next wakeup of the
+  // wheel
+  void run(int msecs) {
+    const TimerWheel::Nanoseconds end = static_cast<TimerWheel::Nanoseconds>(msecs) * 1000000;
+
+    for (;;) {
+      TimerWheel::Nanoseconds now = wheel.getNextWakeup();
+      if (now > end)
+        break;
+
+      ++wakeups;
+      expired.clear();
+      wheel.advance(now, expired);
+
+      for (TimerWheel::Entry* entry : expired) {
+        auto item = static_cast<Item*>(entry->data);
+        TimerWheel::Nanoseconds count = 1 + (now - item->deadline) / item->interval;
+        ticks += static_cast<long long>(count);
+        item->deadline += count * item->interval;
+        wheel.schedule(entry, item->deadline, slack());
+      }
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////////
+// Benchmarks
+
+// Intervals from 10 ms to 10 s (like blinking cursors, polling, etc.)
+static std::vector<int> get_intervals()
+{
+  std::mt19937 random(1);
+  std::uniform_int_distribution<int> distribution(10, 10000);
+
+  std::vector<int> intervals(TIMERS);
+  for (int& interval : intervals)
+    interval = distribution(random);
+  return intervals;
+}
+
+template<class Scheduler>
+static void bench_all()
+{
+  const std::vector<int> intervals = get_intervals();
+  const char* name = Scheduler::getName();
+  Scheduler scheduler;
+
+  // Start
+  BenchmarkClock::time_point start = BenchmarkClock::now();
+  for (int i=0; i<TIMERS; ++i)
+    scheduler.start(i, intervals[i], 0);
+  add_result("start (100k timers)", name, get_seconds(start) * 1e9 / TIMERS, "ns");
+
+  // Run
+  start = BenchmarkClock::now();
+  scheduler.run(SIMULATED_MSECS);
+  double seconds = get_seconds(start);
+  add_result("run 2 s: CPU time", name, seconds * 1e3, "ms");
+  add_result("run 2 s: wakeups", name, static_cast<double>(scheduler.wakeups), "");
+  add_result("run 2 s: ticks", name, static_cast<double>(scheduler.ticks), "");
+
+  // Stop
+  start = BenchmarkClock::now();
+  for (int i=0; i<STOPPED_TIMERS; ++i)
+    scheduler.stop((i * 7919) % TIMERS);
+  add_result("stop (1k of 100k timers)", name, get_seconds(start) * 1e9 / STOPPED_TIMERS, "ns");
+}
+
+//////////////////////////////////////////////////////////////////////
+// Output
+
+static const Result* find_result(const std::string& benchmark, const std::string& scheduler)
+{
+  for (const auto& result : results)
+    if (result.benchmark == benchmark && result.scheduler == scheduler)
+      return &result;
+  return nullptr;
+}
+
+static void print_table()
+{
+  std::printf("%-30s", "benchmark");
+  for (const auto& scheduler : scheduler_names)
+    std::printf(" %18s", scheduler.c_str());
+  std::printf("\n");
+
+  for (const auto& benchmark : benchmark_names) {
+    std::printf("%-30s", benchmark.c_str());
+    for (const auto& scheduler : scheduler_names) {
+      const Result* result = find_result(benchmark, scheduler);
+      if (result != nullptr)
+        std::printf(" %12.1f %-5s", result->value, result->unit);
+      else
+        std::printf(" %18s", "-");
+    }
+    std::printf("\n");
+  }
+}
+
+static bool write_json(const char* filename)
+{
+  FILE* f = std::fopen(filename, "w");
+  if (f == nullptr)
+    return false;
+
+  std::fprintf(f, "{\n  \"version\": \"%d.%d.%d\",\n  \"results\": [\n",
+               VACA_VERSION, VACA_SUB_VERSION, VACA_WIP_VERSION);
+  for (std::size_t i=0; i<results.size(); ++i) {
+    const Result& result = results[i];
+    std::fprintf(f, "    { \"benchmark\": \"%s\", \"scheduler\": \"%s\", \"value\": %.3f, \"unit\": \"%s\" }%s\n",
+                 result.benchmark.c_str(), result.scheduler.c_str(),
+                 result.value, result.unit,
+                 i+1 < results.size() ? ",": "");
+  }
+  std::fprintf(f, "  ]\n}\n");
+
+  return std::fclose(f) == 0;
+}
+
+int main(int argc, char* argv[])
+{
+  const char* json = nullptr;
+
+  for (int i=1; i<argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0 && i+1 < argc)
+      json = argv[++i];
+    else {
+      std::fprintf(stderr, "Usage: %s [--json FILE]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  bench_all<LinearScheduler>();
+  bench_all<WheelScheduler<0> >();
+  bench_all<WheelScheduler<SLACK_MSECS> >();
+
+  print_table();
+
+  if (json != nullptr && !write_json(json)) {
+    std::fprintf(stderr, "Error writing '%s'\n", json);
+    return 1;
+  }
+  return 0;
+}
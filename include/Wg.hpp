@@ -24,6 +24,7 @@
 #include "Wg/CheckBox.hpp"
 #include "Wg/ClientLayout.hpp"
 #include "Wg/Clipboard.hpp"
+#include "Wg/Clock.hpp"
 #include "Wg/CloseEvent.hpp"
 #include "Wg/Color.hpp"
 #include "Wg/ColorDialog.hpp"
@@ -32,7 +33,9 @@
 #include "Wg/CommandEvent.hpp"
 #include "Wg/CommonDialog.hpp"
 #include "Wg/Component.hpp"
+#include "Wg/ConcurrentSignal.hpp"
 #include "Wg/ConditionVariable.hpp"
+#include "Wg/Connection.hpp"
 #include "Wg/Constraint.hpp"
 #include "Wg/ConsumableEvent.hpp"
 #include "Wg/Cursor.hpp"
@@ -41,12 +44,14 @@
 #include "Wg/DataGrid.hpp"
 #include "Wg/Debug.hpp"
 #include "Wg/Dialog.hpp"
+#include "Wg/DispatchProfiler.hpp"
 // #include "Wg/DockArea.h"
 // #include "Wg/DockBar.h"
 // #include "Wg/DockFrame.h"
 #include "Wg/DropFilesEvent.hpp"
 #include "Wg/Enum.hpp"
 #include "Wg/Event.hpp"
+#include "Wg/EventPool.hpp"
 #include "Wg/Exception.hpp"
 #include "Wg/FileDialog.hpp"
 #include "Wg/FindFiles.hpp"
@@ -56,12 +61,17 @@
 #include "Wg/FontDialog.hpp"
 #include "Wg/Frame.hpp"
 #include "Wg/GdiObject.hpp"
+#include "Wg/GlyphCache.hpp"
 #include "Wg/Graphics.hpp"
 #include "Wg/GraphicsPath.hpp"
 #include "Wg/GroupBox.hpp"
+#include "Wg/HangWatchdog.hpp"
 #include "Wg/HttpRequest.hpp"
 #include "Wg/Icon.hpp"
 #include "Wg/Image.hpp"
+#include "Wg/ImageAtlas.hpp"
+#include "Wg/ImageComparison.hpp"
+#include "Wg/ImageEffects.hpp"
 #include "Wg/ImageList.hpp"
 #include "Wg/KeyEvent.hpp"
 #include "Wg/Keys.hpp"
@@ -77,16 +87,20 @@
 #include "Wg/Menu.hpp"
 #include "Wg/MenuItemEvent.hpp"
 #include "Wg/Message.hpp"
+#include "Wg/MessageMap.hpp"
 #include "Wg/MouseEvent.hpp"
 #include "Wg/MsgBox.hpp"
 #include "Wg/Mutex.hpp"
 #include "Wg/NonCopyable.hpp"
 #include "Wg/PaintEvent.hpp"
+#include "Wg/PaintProfiler.hpp"
 #include "Wg/ParseException.hpp"
+#include "Wg/PathRasterizer.hpp"
 #include "Wg/Pen.hpp"
 #include "Wg/Point.hpp"
 #include "Wg/PreferredSizeEvent.hpp"
 #include "Wg/ProgressBar.hpp"
+#include "Wg/QueuedCall.hpp"
 #include "Wg/RadioButton.hpp"
 #include "Wg/ReBar.hpp"
 #include "Wg/Rect.hpp"
@@ -106,7 +120,9 @@
 #include "Wg/SetCursorEvent.hpp"
 #include "Wg/SharedPtr.hpp"
 #include "Wg/Signal.hpp"
+#include "Wg/SignalN.hpp"
 #include "Wg/Size.hpp"
+#include "Wg/SkylinePacker.hpp"
 #include "Wg/Slider.hpp"
 #include "Wg/Slot.hpp"
 #include "Wg/SpinButton.hpp"
@@ -117,10 +133,14 @@
 #include "Wg/Style.hpp"
 #include "Wg/System.hpp"
 #include "Wg/Tab.hpp"
+#include "Wg/Task.hpp"
 #include "Wg/TextEdit.hpp"
+#include "Wg/TextLayout.hpp"
 #include "Wg/Thread.hpp"
+#include "Wg/ThreadPool.hpp"
 #include "Wg/TimePoint.hpp"
 #include "Wg/Timer.hpp"
+#include "Wg/TimerWheel.hpp"
 #include "Wg/ToggleButton.hpp"
 #include "Wg/ToolBar.hpp"
 #include "Wg/TreeNode.hpp"
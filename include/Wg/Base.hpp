@@ -226,6 +226,34 @@ typedef Enum<TextAlignEnum> TextAlign;
 
 // ======================================================================
 
+/**
+   It's like a namespace for FillRule.
+
+   @see FillRule
+*/
+struct FillRuleEnum {
+    enum enumeration {
+        EvenOdd,
+        Winding
+    };
+    static const enumeration default_value = EvenOdd;
+};
+
+/**
+   How the interior of a polygon with self-intersections is filled.
+
+   One of the following values:
+   @li FillRule::EvenOdd (default): a point is inside if a ray from it
+       crosses the outline an odd number of times.
+   @li FillRule::Winding: a point is inside if the outline winds around
+       it a non-zero number of times.
+
+   @see Graphics#setFillRule, PathRasterizer#fill
+*/
+typedef Enum<FillRuleEnum> FillRule;
+
+// ======================================================================
+
 /**
    It's like a namespace for VerticalAlign.
 
@@ -397,12 +425,16 @@ class ButtonBase;
 
 class CancelableEvent;
 
+class CancellationToken;
+
 class CheckBox;
 
 class ClientLayout;
 
 class Clipboard;
 
+class Clock;
+
 class CloseEvent;
 
 class Color;
@@ -423,6 +455,8 @@ class Component;
 
 class ConditionVariable;
 
+class Connection;
+
 class Constraint;
 
 class Cursor;
@@ -433,6 +467,8 @@ class CustomLabel;
 
 class Dialog;
 
+class DispatchProfiler;
+
 class DockArea;
 
 class DockBar;
@@ -447,6 +483,8 @@ class DropFilesEvent;
 
 class Event;
 
+class EventPool;
+
 class Exception;
 
 class FileDialog;
@@ -463,12 +501,16 @@ class FontMetrics;
 
 class Frame;
 
+class GlyphCache;
+
 class Graphics;
 
 class GraphicsPath;
 
 class GroupBox;
 
+class HangWatchdog;
+
 class HttpRequest;
 
 class HttpRequestException;
@@ -477,6 +519,12 @@ class Icon;
 
 class Image;
 
+class ImageAtlas;
+
+class ImageComparison;
+
+class ImageEffects;
+
 class ImageHandle;
 
 class ImageList;
@@ -523,6 +571,8 @@ class MenuSeparator;
 
 class Message;
 
+class MessageMap;
+
 class MouseEvent;
 
 class MsgBox;
@@ -537,6 +587,10 @@ class OpenFileDialog;
 
 class PaintEvent;
 
+class PaintProfiler;
+
+class PathRasterizer;
+
 class Pen;
 
 class Point;
@@ -549,6 +603,8 @@ class ProgressBar;
 
 class Property;
 
+class QueuedCall;
+
 class RadioButton;
 
 class RadioGroup;
@@ -573,6 +629,8 @@ class SciEdit;
 
 class SciRegister;
 
+class ScopedConnection;
+
 class ScopedLock;
 
 class ScreenGraphics;
@@ -587,6 +645,8 @@ class SetCursorEvent;
 
 class Size;
 
+class SkylinePacker;
+
 class Slider;
 
 class SpinButton;
@@ -595,8 +655,12 @@ class Spinner;
 
 class SplitBar;
 
+struct StallReport;
+
 class StatusBar;
 
+class SteadyClock;
+
 class System;
 
 class Tab;
@@ -605,14 +669,22 @@ class TabBase;
 
 class TabPage;
 
+class TaskCanceledException;
+
 class TextEdit;
 
+class TextLayout;
+
 class Thread;
 
+class ThreadPool;
+
 class TimePoint;
 
 class Timer;
 
+class TimerWheel;
+
 class ToggleButton;
 
 class ToolBar;
@@ -629,6 +701,8 @@ class TreeViewEvent;
 
 class TreeViewIterator;
 
+class VirtualClock;
+
 class Widget;
 
 class WidgetClassName;
@@ -31,7 +31,7 @@ public:
     void setSelected(bool state);
 
     // Signals
-    Signal1<void, Event &> Click; ///< @see onClick
+    SignalN<void(Event &)> Click; ///< @see onClick
 
 protected:
     // Events
@@ -0,0 +1,94 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/NonCopyable.hpp"
+
+#include <atomic>
+#include <chrono>
+
+namespace Wg {
+
+/**
+   A monotonic clock. TimePoint, Timer and HangWatchdog ask the time to
+   the current clock (see #getCurrent), so the time can be replaced in
+   tests (see VirtualClock).
+*/
+class VACA_DLL Clock : private NonCopyable {
+public:
+
+    typedef std::chrono::nanoseconds Nanoseconds;
+
+    Clock();
+
+    virtual ~Clock();
+
+    /**
+       Returns the current time. It never goes backward.
+    */
+    [[nodiscard]] virtual Nanoseconds now() const = 0;
+
+    /**
+       Returns true if the time advances by itself (it is the real
+       time), so it is possible to wait for a time.
+    */
+    [[nodiscard]] virtual bool isRealTime() const = 0;
+
+    static Clock &getCurrent();
+
+    static void setCurrent(Clock *clock);
+
+};
+
+/**
+   The clock of the real time (@c std::chrono::steady_clock). It is the
+   default clock.
+*/
+class VACA_DLL SteadyClock : public Clock {
+public:
+
+    [[nodiscard]] Nanoseconds now() const override;
+
+    [[nodiscard]] bool isRealTime() const override;
+
+    static SteadyClock &getInstance();
+
+};
+
+/**
+   A clock whose time is advanced manually (e.g. from a test). It can
+   be used from several threads.
+
+   @code
+   VirtualClock clock;
+   Clock::setCurrent(&clock);
+   Timer timer(100);
+   timer.start();
+   clock.advance(std::chrono::milliseconds(250));
+   Timer::pollTimers();        // fires two ticks
+   Clock::setCurrent(nullptr);
+   @endcode
+*/
+class VACA_DLL VirtualClock : public Clock {
+    std::atomic<Nanoseconds::rep> m_now;
+
+public:
+
+    explicit VirtualClock(Nanoseconds now = Nanoseconds(0));
+
+    [[nodiscard]] Nanoseconds now() const override;
+
+    [[nodiscard]] bool isRealTime() const override;
+
+    void setTime(Nanoseconds now);
+
+    void advance(Nanoseconds time);
+
+};
+
+} // namespace Wg
@@ -58,8 +58,8 @@ public:
     Rect getDropDownBounds();
 
     // Signals
-    Signal1<void, Event &> SelChange;  ///< @see onSelChange
-    Signal1<void, Event &> EditChange; ///< @see onEditChange
+    SignalN<void(Event &)> SelChange;  ///< @see onSelChange
+    SignalN<void(Event &)> EditChange; ///< @see onEditChange
 
 protected:
     // Events
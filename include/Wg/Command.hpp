@@ -8,7 +8,7 @@
 
 #include "Wg/Base.hpp"
 #include "Wg/NonCopyable.hpp"
-#include "Wg/Signal.hpp"
+#include "Wg/SignalN.hpp"
 
 #include <vector>
 
@@ -88,16 +88,16 @@ public:
     void execute() override { Execute(); }
 
     bool isEnabled() override {
-        return Enabled(true);    // true by default
+        return Enabled.empty() ? true : Enabled();    // true by default
     }
 
     bool isChecked() override {
-        return Checked(false);    // false by default
+        return Checked.empty() ? false : Checked();    // false by default
     }
 
-    Signal0<void> Execute;
-    Signal0<bool> Enabled;
-    Signal0<bool> Checked;
+    SignalN<void()> Execute;
+    SignalN<bool()> Enabled;
+    SignalN<bool()> Checked;
 };
 
 /**
@@ -0,0 +1,390 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/Mutex.hpp"
+#include "Wg/NonCopyable.hpp"
+#include "Wg/QueuedCall.hpp"
+#include "Wg/ScopedLock.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Wg {
+
+/**
+   @defgroup signal_group Signal Classes
+   @{
+ */
+
+template<typename>
+class ConcurrentSignal;
+
+/**
+   Signal that can be emitted, connected and disconnected from any
+   thread at the same time.
+
+   The emitters iterate an immutable snapshot of the slots (a
+   reference counted array). #connect and #disconnect do not modify
+   the snapshot, they publish a new one (like @wikipedia{Read-copy-update,RCU}),
+   so the emission does not lock any mutex and does not wait for other
+   threads: it only increments and decrements a few atomic counters.
+   The connections are serialized with a Mutex, and the old snapshot
+   is released when no emitter can be taking a reference to it.
+
+   A slot can disconnect itself (or any other slot) while it is
+   running: the snapshot keeps it alive until the emission finishes,
+   and it is not called again. #disconnect waits the calls that other
+   threads are doing to the disconnected slots, so when it returns the
+   slots are not running and they will not be called anymore (the
+   objects that they use can be destroyed).
+
+   @warning
+     A thread must not disconnect a slot while it holds a lock that
+     the slot (running in other thread) could be waiting.
+
+   @code
+   ConcurrentSignal<void(double)> PriceChange;
+   PriceChange.connect(&Chart::onPriceChange, &chart);
+   // From a worker thread
+   PriceChange(price);
+   @endcode
+
+   @see SignalN
+*/
+template<typename R, typename... A>
+class ConcurrentSignal<R(A...)> : private NonCopyable {
+public:
+    typedef R ReturnType;
+
+private:
+
+    struct Slot {
+        std::atomic<int> refs;
+        std::atomic<bool> connected;
+        std::atomic<int> calls;  // emitters that are calling the slot
+        R (*invoke)(Slot *slot, A... args);
+        void (*destroy)(Slot *slot);
+
+        void ref() { refs.fetch_add(1, std::memory_order_relaxed); }
+
+        void unref() {
+            if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                destroy(this);
+        }
+    };
+
+    template<typename F>
+    struct FunctorSlot : public Slot {
+        F f;
+
+        explicit FunctorSlot(const F &f) : f(f) {
+            this->refs.store(1, std::memory_order_relaxed);
+            this->connected.store(true, std::memory_order_relaxed);
+            this->calls.store(0, std::memory_order_relaxed);
+            this->invoke = &FunctorSlot::invokeFunctor;
+            this->destroy = &FunctorSlot::destroyFunctor;
+        }
+
+        static R invokeFunctor(Slot *slot, A... args) {
+            return static_cast<FunctorSlot *>(slot)->f(std::forward<A>(args)...);
+        }
+
+        static void destroyFunctor(Slot *slot) {
+            delete static_cast<FunctorSlot *>(slot);
+        }
+    };
+
+    template<class T>
+    struct MemberBinding {
+        R (T::*m)(A...);
+        T *t;
+
+        R operator()(A... args) { return (t->*m)(std::forward<A>(args)...); }
+    };
+
+    // Immutable list of slots shared by the emitters
+    struct Snapshot {
+        std::atomic<int> refs;
+        std::vector<Slot *> slots;
+
+        Snapshot() : refs(1) {}
+
+        ~Snapshot() {
+            for (Slot *slot : slots)
+                slot->unref();
+        }
+
+        void ref() { refs.fetch_add(1, std::memory_order_relaxed); }
+
+        void unref() {
+            if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
+    };
+
+    std::atomic<Snapshot *> m_current;
+    std::atomic<unsigned> m_version;
+    std::atomic<int> m_readers[2];
+    Mutex m_mutex;
+
+public:
+
+    ConcurrentSignal()
+            : m_current(new Snapshot), m_version(0) {
+        m_readers[0].store(0);
+        m_readers[1].store(0);
+    }
+
+    /**
+       Destroys the signal. It must not be being emitted.
+    */
+    ~ConcurrentSignal() {
+        m_current.load()->unref();
+    }
+
+    template<typename F>
+    void connect(const F &f) {
+        addSlot(new FunctorSlot<F>(f));
+    }
+
+    template<class T>
+    void connect(R (T::*m)(A...), T *t) {
+        addSlot(new FunctorSlot<MemberBinding<T> >(MemberBinding<T>{m, t}));
+    }
+
+    /**
+       Connects the functor @a f to be called in the thread @a thread.
+
+       @param type
+         ConnectionType::Direct calls @a f in the thread that emits the
+         signal (like #connect(const F&)). ConnectionType::Queued and
+         ConnectionType::Coalesced post the call to the message queue of
+         @a thread (they can be used only if @a R is @c void).
+
+       @warning
+         The objects used by @a f must live until the calls that are
+         still in the queue are delivered.
+    */
+    template<typename F>
+    void connect(const F &f, ConnectionType type, ThreadId thread) {
+        if constexpr (std::is_void<R>::value) {
+            if (type != ConnectionType::Direct) {
+                connect(QueuedSlot<F, A...>(f, type, thread));
+                return;
+            }
+        }
+        else
+            assert(type == ConnectionType::Direct);
+
+        connect(f);
+    }
+
+    template<class T>
+    void connect(R (T::*m)(A...), T *t, ConnectionType type, ThreadId thread) {
+        connect(MemberBinding<T>{m, t}, type, thread);
+    }
+
+    /**
+       Disconnects all the slots that call the member function @a m of
+       the object @a t.
+    */
+    template<class T>
+    void disconnect(R (T::*m)(A...), T *t) {
+        typedef FunctorSlot<MemberBinding<T> > BindingSlot;
+
+        removeSlots([m, t](Slot *slot) {
+            if (slot->invoke != &BindingSlot::invokeFunctor)
+                return false;
+            const MemberBinding<T> &binding = static_cast<BindingSlot *>(slot)->f;
+            return binding.m == m && binding.t == t;
+        });
+    }
+
+    void disconnectAll() {
+        removeSlots([](Slot *) { return true; });
+    }
+
+    [[nodiscard]] bool empty() const {
+        return getSlotCount() == 0;
+    }
+
+    [[nodiscard]] unsigned getSlotCount() const {
+        Snapshot *snapshot = const_cast<ConcurrentSignal *>(this)->acquire();
+        unsigned count = static_cast<unsigned>(snapshot->slots.size());
+        snapshot->unref();
+        return count;
+    }
+
+    /**
+       Calls all the connected slots (in the current thread).
+
+       @return
+         The value returned by the last slot (or @c R() if there are no
+         slots).
+    */
+    R operator()(A... args) {
+        Snapshot *snapshot = acquire();
+        SnapshotHolder holder(snapshot);
+
+        if constexpr (std::is_void<R>::value) {
+            for (Slot *slot : snapshot->slots) {
+                CallScope call(slot);
+                if (slot->connected.load())
+                    slot->invoke(slot, args...);
+            }
+        }
+        else {
+            R result = R();
+            for (Slot *slot : snapshot->slots) {
+                CallScope call(slot);
+                if (slot->connected.load())
+                    result = slot->invoke(slot, args...);
+            }
+            return result;
+        }
+    }
+
+private:
+
+    // Releases a snapshot at the end of the emission (also if a slot
+    // throws an exception)
+    class SnapshotHolder {
+        Snapshot *m_snapshot;
+    public:
+        explicit SnapshotHolder(Snapshot *snapshot) : m_snapshot(snapshot) {}
+
+        ~SnapshotHolder() { m_snapshot->unref(); }
+    };
+
+    // Counts a call to a slot from its check of "connected" to its end
+    // (so #disconnect can wait it). The calls of the current thread are
+    // a stack, so a slot that disconnects itself does not wait itself
+    class CallScope {
+        Slot *m_slot;
+        CallScope *m_prev;
+    public:
+        explicit CallScope(Slot *slot) : m_slot(slot), m_prev(getTop()) {
+            // it is incremented before "connected" is checked (both are
+            // sequentially consistent), so #disconnect sees this call
+            // or this call sees the slot disconnected
+            m_slot->calls.fetch_add(1);
+            getTop() = this;
+        }
+
+        ~CallScope() {
+            getTop() = m_prev;
+            m_slot->calls.fetch_sub(1);
+        }
+
+        // Returns the calls to "slot" of the current thread
+        static int getCount(Slot *slot) {
+            int count = 0;
+            for (CallScope *call = getTop(); call != nullptr; call = call->m_prev)
+                if (call->m_slot == slot)
+                    ++count;
+            return count;
+        }
+
+    private:
+        static CallScope *&getTop() {
+            static thread_local CallScope *top = nullptr;
+            return top;
+        }
+    };
+
+    // Takes a reference to the current snapshot. It is wait-free: the
+    // counter of readers avoids that a writer releases the snapshot
+    // between the load and the ref()
+    Snapshot *acquire() {
+        const unsigned version = m_version.load();
+        std::atomic<int> &readers(m_readers[version & 1]);
+
+        readers.fetch_add(1);
+        Snapshot *snapshot = m_current.load();
+        snapshot->ref();
+        readers.fetch_sub(1);
+
+        return snapshot;
+    }
+
+    // Replaces the current snapshot and waits until no reader can be
+    // taking a reference to the old one. The counter of readers is
+    // flipped twice, so a reader that has read an old version (and is
+    // using the other counter) is waited too
+    void publish(Snapshot *snapshot) {
+        Snapshot *old = m_current.exchange(snapshot);
+
+        for (int i = 0; i < 2; ++i) {
+            const unsigned version = m_version.fetch_add(1);
+            while (m_readers[version & 1].load() != 0)
+                std::this_thread::yield();
+        }
+
+        old->unref();
+    }
+
+    void addSlot(Slot *slot) {
+        ScopedLock hold(m_mutex);
+        Snapshot *current = m_current.load();
+        Snapshot *snapshot = new Snapshot;
+
+        snapshot->slots.reserve(current->slots.size() + 1);
+        for (Slot *other : current->slots) {
+            other->ref();
+            snapshot->slots.push_back(other);
+        }
+        snapshot->slots.push_back(slot);
+
+        publish(snapshot);
+    }
+
+    template<typename Predicate>
+    void removeSlots(Predicate predicate) {
+        std::vector<Slot *> removed;
+
+        {
+            ScopedLock hold(m_mutex);
+            Snapshot *current = m_current.load();
+            Snapshot *snapshot = new Snapshot;
+
+            for (Slot *slot : current->slots) {
+                slot->ref();
+                if (predicate(slot)) {
+                    slot->connected.store(false);
+                    removed.push_back(slot);
+                }
+                else
+                    snapshot->slots.push_back(slot);
+            }
+
+            if (!removed.empty())
+                publish(snapshot);
+            else
+                delete snapshot;
+        }
+
+        // wait the calls of other threads (without the mutex, a slot
+        // could be connecting other one)
+        for (Slot *slot : removed) {
+            const int ownCalls = CallScope::getCount(slot);
+            while (slot->calls.load() != ownCalls)
+                std::this_thread::yield();
+            slot->unref();
+        }
+    }
+
+};
+
+/** @} */
+
+} // namespace Wg
@@ -26,14 +26,23 @@ public:
 
 };
 
+/**
+   A condition to wait in a thread until other thread notifies it. It
+   is used with a Mutex locked through a ScopedLock.
+
+   @win32
+     It is emulated with semaphores.
+   @endwin32
+
+   In other platforms it uses @c std::condition_variable_any.
+
+   @see Mutex, ScopedLock, Thread
+*/
 class VACA_DLL ConditionVariable : private NonCopyable {
-    HANDLE m_gate;
-    HANDLE m_queue;
-    HANDLE m_mutex;
-    unsigned m_gone;         // # threads that timed out and never made it to m_queue
-    unsigned long m_blocked; // # threads blocked on the condition
-    unsigned m_waiting;      // # threads no longer waiting for the condition but
-    // still waiting to be removed from m_queue
+    class ConditionVariableImpl;
+
+    ConditionVariableImpl *m_impl;
+
 public:
 
     ConditionVariable();
@@ -62,9 +71,6 @@ public:
         return true;
     }
 
-private:
-    void enterWait();
-
 };
 
 } // namespace Wg
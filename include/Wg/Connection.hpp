@@ -0,0 +1,126 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/NonCopyable.hpp"
+
+namespace Wg {
+
+/**
+   @defgroup signal_group Signal Classes
+   @{
+ */
+
+/**
+   Handle of a slot connected to a signal (returned by SignalN#connect).
+
+   It can be copied and kept after the signal is destroyed: in that
+   case #isConnected returns false and #disconnect does nothing. The
+   slot is identified by an index in the table of the signal plus a
+   generation number, so #disconnect is O(1) (it does not search the
+   slot) and a handle of a slot that was disconnected cannot remove a
+   new slot that reuses the same index.
+
+   @code
+   Connection conn = model.Change.connect(&View::onModelChange, view);
+   ...
+   conn.disconnect();
+   @endcode
+
+   @see ScopedConnection, #track
+*/
+class VACA_DLL Connection {
+public:
+
+    /**
+       Shared by a signal and its connections, so the connections know
+       if the signal is still alive.
+
+       @internal
+    */
+    struct Link {
+        unsigned refs;
+        void *signal; // nullptr when the signal is destroyed
+        bool (*isConnected)(void *signal, unsigned index, unsigned generation);
+        void (*disconnect)(void *signal, unsigned index, unsigned generation);
+
+        void ref() { ++refs; }
+
+        void unref() {
+            if (--refs == 0)
+                delete this;
+        }
+    };
+
+private:
+    Link *m_link;
+    unsigned m_index;
+    unsigned m_generation;
+
+public:
+
+    Connection();
+
+    Connection(Link *link, unsigned index, unsigned generation);
+
+    Connection(const Connection &conn);
+
+    ~Connection();
+
+    Connection &operator=(const Connection &conn);
+
+    [[nodiscard]] bool isConnected() const;
+
+    void disconnect();
+
+    Connection &track(Referenceable *object);
+
+};
+
+/**
+   Disconnects a slot when it is destroyed (e.g. a member of the
+   object that is called by the slot).
+
+   @code
+   class View : public Widget {
+     ScopedConnection m_modelChange;
+   public:
+     View(Model* model, Widget* parent) : Widget(parent) {
+       m_modelChange = model->Change.connect(&View::onModelChange, this);
+     }
+   };
+   @endcode
+
+   @see Connection
+*/
+class VACA_DLL ScopedConnection : private NonCopyable {
+    Connection m_connection;
+
+public:
+
+    ScopedConnection();
+
+    ScopedConnection(const Connection &conn);
+
+    ~ScopedConnection();
+
+    ScopedConnection &operator=(const Connection &conn);
+
+    [[nodiscard]] const Connection &getConnection() const;
+
+    [[nodiscard]] bool isConnected() const;
+
+    void disconnect();
+
+    Connection release();
+
+};
+
+/** @} */
+
+} // namespace Wg
@@ -36,6 +36,8 @@ public:
 
 protected:
 
+    void drawTextLayout(Graphics &g);
+
     // Reflected notifications
     bool onReflectedDrawItem(Graphics &g, LPDRAWITEMSTRUCT lpDrawItem) override;
 
@@ -119,8 +119,10 @@ public:
 
     Widget *getPreviousFocusableWidget(Widget *widget);
 
-    Signal0<void> Ok;       ///< @see onOk
-    Signal0<void> Cancel;   ///< @see onCancel
+    SignalN<void()> Ok;       ///< @see onOk
+    SignalN<void()> Cancel;   ///< @see onCancel
+
+    [[nodiscard]] static const MessageMap &getBaseMessageMap();
 
 protected:
     virtual void onOk();
@@ -0,0 +1,182 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/Mutex.hpp"
+#include "Wg/NonCopyable.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+namespace Wg {
+
+/**
+   Measures how long the messages take to be dispatched.
+
+   It records:
+   @li A latency histogram for each message ID, and for each class of
+       widget that receives messages.
+   @li How long the posted messages wait in the queue of the thread
+       (from the time of the message to CurrentThread#processMessage).
+   @li The re-entrancy depth of each dispatch (a message sent from the
+       handler of other message has a depth of 2).
+   @li The last dispatched messages, to see them in a timeline.
+
+   The recording points (in Widget#globalWndProc and
+   CurrentThread#processMessage) are compiled only if the library is
+   built with the @c VACA_DISPATCH_PROFILER option, so the dispatch
+   does not cost anything in normal builds. With the option, the
+   profiler is disabled until #setEnabled is called.
+
+   @code
+   DispatchProfiler& profiler(DispatchProfiler::getInstance());
+   profiler.setEnabled(true);
+   ...
+   // Write "trace.json" and open it in chrome://tracing
+   std::ofstream("trace.json") << profiler.getChromeTrace();
+   std::ofstream("dispatch.json") << profiler.getJson();
+   @endcode
+*/
+class VACA_DLL DispatchProfiler : private NonCopyable {
+public:
+
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+       Histogram of values (nanoseconds) with a relative precision of
+       1/16 (like a HDR histogram): the values from 2^n to 2^(n+1) are
+       counted in 16 buckets of the same size. It uses the same memory
+       for any number of values.
+    */
+    class VACA_DLL Histogram {
+    public:
+
+        enum {
+            SubBuckets = 16,
+            /**
+               Buckets for values up to 2^48 (about 78 hours in
+               nanoseconds), bigger values are counted in the last
+               bucket.
+            */
+            Buckets = (48 - 3) * SubBuckets
+        };
+
+    private:
+        unsigned long long m_count;
+        unsigned long long m_min;
+        unsigned long long m_max;
+        double m_sum;
+        unsigned m_buckets[Buckets];
+
+    public:
+
+        Histogram();
+
+        void reset();
+
+        void addValue(unsigned long long value);
+
+        void add(const Histogram &histogram);
+
+        [[nodiscard]] unsigned long long getCount() const { return m_count; }
+
+        [[nodiscard]] unsigned long long getMin() const { return m_min; }
+
+        [[nodiscard]] unsigned long long getMax() const { return m_max; }
+
+        [[nodiscard]] double getMean() const;
+
+        [[nodiscard]] unsigned long long getValueAtPercentile(double percentile) const;
+
+        static int getBucket(unsigned long long value);
+
+        static unsigned long long getBucketLimit(int bucket);
+
+    };
+
+    /**
+       Measures the dispatch of a message from its creation to its
+       destruction.
+
+       @internal
+    */
+    class VACA_DLL Scope : private NonCopyable {
+        bool m_active;
+        UINT m_message;
+        const std::type_info *m_type;
+        Clock::time_point m_start;
+        unsigned m_depth;
+
+    public:
+        Scope(UINT message, const std::type_info &type);
+
+        ~Scope();
+    };
+
+private:
+
+    // A dispatched message in the timeline
+    struct TraceEvent {
+        UINT message;
+        const std::type_info *type;
+        unsigned long long start;    // nanoseconds from m_origin
+        unsigned long long duration; // nanoseconds
+        unsigned depth;
+        unsigned thread;
+    };
+
+    std::atomic<bool> m_enabled;
+    std::map<UINT, Histogram> m_messages;
+    std::map<std::type_index, Histogram> m_classes;
+    Histogram m_queueWait;
+    std::vector<unsigned long long> m_depths;
+    std::vector<TraceEvent> m_trace;
+    std::size_t m_traceNext;
+    std::size_t m_traceCapacity;
+    Clock::time_point m_origin;
+    mutable Mutex m_mutex;
+
+    DispatchProfiler();
+
+public:
+
+    virtual ~DispatchProfiler();
+
+    static DispatchProfiler &getInstance();
+
+    [[nodiscard]] bool isEnabled() const;
+
+    void setEnabled(bool state);
+
+    void setTraceCapacity(std::size_t events);
+
+    void reset();
+
+    void addDispatch(UINT message, const std::type_info &type,
+                     Clock::time_point start, Clock::duration duration,
+                     unsigned depth);
+
+    void addQueueWait(unsigned long msecs);
+
+    [[nodiscard]] Histogram getMessageHistogram(UINT message) const;
+
+    [[nodiscard]] Histogram getQueueWaitHistogram() const;
+
+    [[nodiscard]] std::vector<unsigned long long> getDepthCounts() const;
+
+    [[nodiscard]] std::string getJson() const;
+
+    [[nodiscard]] std::string getChromeTrace() const;
+
+};
+
+} // namespace Wg
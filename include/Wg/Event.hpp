@@ -8,10 +8,17 @@
 
 #include "Wg/Base.hpp"
 
+#include <cstddef>
+
 namespace Wg {
 
 /**
    Base class for every kind of event.
+
+   Events are usually created in the stack (e.g. by Widget#wndProc).
+   The events that must live after the handler (deferred, queued, or
+   sent to other thread) can be created with @c new: they are
+   allocated from the EventPool of the thread.
 */
 class VACA_DLL Event {
     /**
@@ -28,6 +35,10 @@ public:
 
     Component *getSource();
 
+    static void *operator new(std::size_t size);
+
+    static void operator delete(void *ptr, std::size_t size);
+
 };
 
 } // namespace Wg
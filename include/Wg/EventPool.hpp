@@ -0,0 +1,72 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+
+#include <cstddef>
+
+namespace Wg {
+
+/**
+   Pool of memory blocks for the events that are allocated in the heap
+   (the events that are deferred, queued or sent to other thread) and
+   for the envelopes of queued signal connections (QueuedCall).
+
+   It is more like a namespace than a class, because all member
+   functions are static.
+
+   Each thread has its own lists of free blocks (one list for each
+   size of 16, 32, ... #MaxBlockSize bytes), so allocating and freeing
+   a block does not lock any mutex. When a thread frees many blocks
+   (e.g. the UI thread frees the events that a worker thread
+   allocates), they are moved in batches to a central list where the
+   other threads take them. So an application which creates events at
+   a constant rate does not allocate memory after a while.
+
+   The counters can be used to check that a path (like the dispatch of
+   the mouse input) does not allocate memory:
+
+   @code
+   EventPool::Stats before = EventPool::getStats();
+   ... // move the mouse
+   EventPool::Stats after = EventPool::getStats();
+   assert(after.heapAllocations == before.heapAllocations);
+   @endcode
+
+   @see Event#operator new
+*/
+class VACA_DLL EventPool {
+public:
+
+    enum {
+        /**
+           Bigger blocks are allocated directly from the heap.
+        */
+        MaxBlockSize = 256
+    };
+
+    /**
+       Counters of all the threads.
+    */
+    struct Stats {
+        unsigned long long poolAllocations; // served from a free list
+        unsigned long long heapAllocations; // blocks created with ::operator new
+        unsigned long long liveBlocks;      // blocks that are not freed yet
+    };
+
+    static void *allocate(std::size_t size);
+
+    static void deallocate(void *ptr, std::size_t size);
+
+    [[nodiscard]] static Stats getStats();
+
+    static void resetStats();
+
+};
+
+} // namespace Wg
@@ -8,7 +8,7 @@
 
 #include "Wg/Base.hpp"
 #include "Wg/Dialog.hpp"
-#include "Wg/Signal.hpp"
+#include "Wg/SignalN.hpp"
 
 namespace Wg {
 
@@ -44,9 +44,9 @@ public:
     bool isForward();
 
     // Signals
-    Signal1<void, Event &> FindNext;
-    Signal1<void, Event &> Replace;
-    Signal1<void, Event &> ReplaceAll;
+    SignalN<void(Event &)> FindNext;
+    SignalN<void(Event &)> Replace;
+    SignalN<void(Event &)> ReplaceAll;
 
 protected:
 
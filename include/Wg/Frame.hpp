@@ -73,13 +73,15 @@ public:
 
     virtual bool keepSynchronized();
 
-    Signal1<void, Event &> Activate;     ///< @see onActivate
-    Signal1<void, Event &> Deactivate;   ///< @see onDeactivate
-    Signal1<void, CloseEvent &> Close;   ///< @see onClose
-    Signal2<void, CardinalDirection, Rect &> Resizing; ///< @see onResizing
+    SignalN<void(Event &)> Activate;     ///< @see onActivate
+    SignalN<void(Event &)> Deactivate;   ///< @see onDeactivate
+    SignalN<void(CloseEvent &)> Close;   ///< @see onClose
+    SignalN<void(CardinalDirection, Rect &)> Resizing; ///< @see onResizing
 
     bool preTranslateMessage(Message &message) override;
 
+    [[nodiscard]] static const MessageMap &getBaseMessageMap();
+
 protected:
     // Events
     void onPreferredSize(PreferredSizeEvent &ev) override;
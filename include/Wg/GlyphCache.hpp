@@ -0,0 +1,147 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/Font.hpp"
+#include "Wg/ImagePixels.hpp"
+#include "Wg/NonCopyable.hpp"
+#include "Wg/Point.hpp"
+#include "Wg/Rect.hpp"
+#include "Wg/Size.hpp"
+#include "Wg/SkylinePacker.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Wg {
+
+/**
+   Keeps the rasterized glyphs of the used fonts so text can be drawn in
+   ImagePixels without asking the system to rasterize it each time.
+
+   Each glyph is identified by its font, its character, and its
+   subpixel offset: the horizontal pen position is tracked in
+   1/#SubpixelSteps pixel units, so the same character can start in
+   different fractions of a pixel and still look right. The coverage
+   (an 8-bit anti-aliasing mask) of all glyphs is packed in one big
+   buffer using a SkylinePacker. When the buffer is full, every glyph
+   is flushed and rasterized again on demand.
+
+   Fonts with the same LOGFONT share their glyphs, even if they are
+   different Font instances.
+
+   This class is not thread-safe, it should be used from the UI thread
+   (see #getInstance). A Graphics draws and measures its text with a
+   cache if it is set with Graphics#setGlyphCache.
+
+   @win32
+     The glyphs are rasterized with @msdn{GetGlyphOutline}. Other
+     platforms need their own source of glyph outlines.
+   @endwin32
+
+   @code
+   ImagePixels pixels(Size(200, 20));
+   GlyphCache& cache = GlyphCache::getInstance();
+   cache.drawString(pixels, font, L"Hello", Color::Black, Point(2, 2));
+   @endcode
+
+   @see Graphics#setGlyphCache, ImageAtlas
+*/
+class VACA_DLL GlyphCache : private NonCopyable {
+public:
+
+    /**
+       Number of different horizontal positions inside a pixel in
+       which a glyph can be rendered.
+    */
+    enum { SubpixelSteps = 4 };
+
+    /**
+       A rasterized glyph.
+    */
+    struct Glyph {
+        /**
+           Area of the coverage buffer with the mask of the glyph (it
+           is empty for blank glyphs like spaces).
+        */
+        Rect bounds;
+
+        /**
+           Position of the upper-left corner of the mask relative to
+           the pen position (the pen is at the top of the text line,
+           like in Graphics#drawString).
+        */
+        Point offset;
+
+        /**
+           Horizontal displacement of the pen after this glyph (in
+           1/#SubpixelSteps pixel units).
+        */
+        int advance;
+    };
+
+private:
+
+    struct FontEntry {
+        Font font;
+        LOGFONT logFont;
+        int ascent;
+        int height;
+    };
+
+    std::vector<FontEntry> m_fonts;
+    std::unordered_map<std::uint64_t, Glyph> m_glyphs;
+    std::vector<unsigned char> m_coverage;
+    SkylinePacker m_packer;
+    unsigned m_hits;
+    unsigned m_misses;
+    unsigned m_flushes;
+
+public:
+
+    explicit GlyphCache(const Size &sz = Size(512, 512));
+
+    virtual ~GlyphCache();
+
+    static GlyphCache &getInstance();
+
+    [[nodiscard]] Size getSize() const;
+
+    [[nodiscard]] const unsigned char *getCoverage() const;
+
+    [[nodiscard]] int getGlyphCount() const;
+
+    [[nodiscard]] unsigned getHitCount() const;
+
+    [[nodiscard]] unsigned getMissCount() const;
+
+    [[nodiscard]] unsigned getFlushCount() const;
+
+    const Glyph &getGlyph(const Font &font, Char chr, int subpixel = 0);
+
+    [[nodiscard]] int getLineHeight(const Font &font);
+
+    Size measureString(const Font &font, const String &str);
+
+    void drawString(ImagePixels &dst, const Font &font, const String &str, const Color &color, const Point &pt);
+
+    void clear();
+
+private:
+
+    int getFontIndex(const Font &font);
+
+    const Glyph &getGlyph(int fontIndex, Char chr, int subpixel);
+
+    bool rasterizeGlyph(const FontEntry &entry, Char chr, int subpixel,
+                        Glyph &glyph, std::vector<unsigned char> &mask);
+
+};
+
+} // namespace Wg
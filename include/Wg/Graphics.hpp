@@ -10,24 +10,13 @@
 #include "Wg/NonCopyable.hpp"
 #include "Wg/Rect.hpp"
 #include "Wg/Font.hpp"
+#include "Wg/ImageAtlas.hpp"
 
 #include <list>
 #include <vector>
 
 namespace Wg {
 
-// ======================================================================
-
-struct FillRuleEnum {
-    enum enumeration {
-        EvenOdd,
-        Winding
-    };
-    static const enumeration default_value = EvenOdd;
-};
-
-typedef Enum<FillRuleEnum> FillRule;
-
 /**
    Class to control a graphics context.
 
@@ -45,6 +34,7 @@ class VACA_DLL Graphics : private NonCopyable {
     bool m_autoDelete: 1;
     Font m_font;
     FillRule m_fillRule;
+    GlyphCache *m_glyphCache{};
 
 protected:
 
@@ -91,6 +81,10 @@ public:
 
     void getFontMetrics(FontMetrics &fontMetrics);
 
+    [[nodiscard]] GlyphCache *getGlyphCache() const;
+
+    void setGlyphCache(GlyphCache *glyphCache);
+
     // ======================================================================
     // Pîxel
 
@@ -134,6 +128,12 @@ public:
 
     void strokeAndFillPath(const GraphicsPath &path, const Pen &pen, const Brush &brush, const Point &pt);
 
+    void strokePathAA(const GraphicsPath &path, const Pen &pen, const Point &pt);
+
+    void fillPathAA(const GraphicsPath &path, const Brush &brush, const Point &pt);
+
+    void strokeAndFillPathAA(const GraphicsPath &path, const Pen &pen, const Brush &brush, const Point &pt);
+
     // ======================================================================
 
     void drawString(const String &str, const Color &color, const Point &pt);
@@ -165,6 +165,8 @@ public:
 
     void drawImageList(ImageList &imageList, int imageIndex, const Point &pt, int style);
 
+    void drawImageAtlas(const ImageAtlas &atlas, const std::vector<ImageAtlas::Item> &items);
+
     void drawLine(const Pen &pen, const Point &pt1, const Point &pt2);
 
     void drawLine(const Pen &pen, int x1, int y1, int x2, int y2);
@@ -268,6 +270,12 @@ private:
 
     void drawPolyline(const Pen &pen, CONST POINT *lppt, int numPoints);
 
+    void drawCachedString(const String &str, const Color &color, const Point &pt, const Rect &clip);
+
+    void blendPixels(const ImagePixels &pixels, const Rect &bounds);
+
+    void blendRasterizer(const PathRasterizer &ras, const Color &color, FillRule fillRule, const Point &pt);
+
 };
 
 /**
@@ -7,7 +7,9 @@
 #pragma once
 
 #include "Wg/Base.hpp"
+#include "Wg/Pen.hpp"
 #include "Wg/Point.hpp"
+#include "Wg/SharedPtr.hpp"
 
 #include <vector>
 
@@ -15,8 +17,17 @@ namespace Wg {
 
 /**
    Set of nodes to draw polygons and shapes in Graphics.
+
+   The path keeps a cache with its flattened figures and the cells of
+   its fill and stroke (see #getFigures, #getFillRasterizer and
+   #getStrokeRasterizer), so a path that is drawn each time a widget is
+   painted is flattened and rasterized just once. The cache is
+   discarded when the path is modified, and it is shared between
+   copies of the same path until one of them is modified.
 */
 class VACA_DLL GraphicsPath {
+    friend class PathRasterizer;
+
 public:
     // values that are acceptable for Node#m_flags
     enum {
@@ -62,8 +73,31 @@ public:
         [[nodiscard]] const Point &getPoint() const;
     };
 
+    /**
+       A point of a flattened figure (with subpixel precision).
+
+       @see #flatten(std::vector<Figure>&, double) const
+    */
+    struct Vertex {
+        double x, y;
+    };
+
+    /**
+       A sequence of connected lines obtained from a figure of the path
+       (from a MoveTo node to the next one).
+    */
+    struct Figure {
+        std::vector<Vertex> vertices;
+        bool closed;
+    };
+
 private:
+    class Cache;
+
     std::vector<Node> m_nodes;
+    mutable SharedPtr<Cache> m_cache;
+    mutable unsigned m_cacheHits;
+    mutable unsigned m_cacheMisses;
 
 public:
     typedef std::vector<Node>::iterator iterator;
@@ -71,8 +105,12 @@ public:
 
     GraphicsPath();
 
+    GraphicsPath(const GraphicsPath &path);
+
     virtual ~GraphicsPath();
 
+    GraphicsPath &operator=(const GraphicsPath &path);
+
     iterator begin();
 
     iterator end();
@@ -105,15 +143,38 @@ public:
 
     GraphicsPath &closeFigure();
 
+#ifdef VACA_ON_WINDOWS
     GraphicsPath &flatten();
+#endif
+
+    void flatten(std::vector<Figure> &figures, double tolerance = 0.25) const;
+
+    const std::vector<Figure> &getFigures(double tolerance = 0.25) const;
+
+    const PathRasterizer &getFillRasterizer(double tolerance = 0.25) const;
+
+    const PathRasterizer &getStrokeRasterizer(double width, PenJoin join, PenEndCap endCap,
+                                              double miterLimit = 10.0, double tolerance = 0.25) const;
 
+    [[nodiscard]] unsigned getCacheHits() const;
+
+    [[nodiscard]] unsigned getCacheMisses() const;
+
+#ifdef VACA_ON_WINDOWS
     GraphicsPath &widen(const Pen &pen);
 
     [[nodiscard]] Region toRegion() const;
+#endif
 
 private:
     void addNode(int type, const Point &pt);
 
+    void invalidateCache();
+
+    Cache &getCache() const;
+
+    const std::vector<Figure> &updateFigures(double tolerance) const;
+
 };
 
 } // namespace Wg
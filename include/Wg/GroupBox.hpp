@@ -27,6 +27,8 @@ public:
 
     Size getNonClientSize();
 
+    [[nodiscard]] static const MessageMap &getBaseMessageMap();
+
 protected:
 
     // Events
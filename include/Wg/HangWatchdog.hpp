@@ -0,0 +1,223 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/ConditionVariable.hpp"
+#include "Wg/Mutex.hpp"
+#include "Wg/NonCopyable.hpp"
+#include "Wg/SignalN.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace Wg {
+
+/**
+   Information about a message loop that did not respond in time,
+   generated by HangWatchdog.
+*/
+struct VACA_DLL StallReport {
+
+    typedef std::chrono::nanoseconds Nanoseconds;
+
+    /**
+       A message that was being processed when the stall was detected.
+    */
+    struct Frame {
+        unsigned message;
+        std::uintptr_t wParam;
+        std::intptr_t lParam;
+
+        /**
+           The widget which received the message (nullptr if the message
+           was not dispatched yet, e.g. in CurrentThread#processMessage).
+           It is used only to identify the widget, it could be already
+           destroyed when the report is read.
+        */
+        const void *widget;
+
+        /**
+           Name of the class of the widget (empty if it is unknown).
+        */
+        std::string className;
+
+        /**
+           Time since the message started to be processed.
+        */
+        Nanoseconds elapsed;
+
+        /**
+           Time spent in this message and not in the nested ones (the
+           time of the stall is in the frame with the biggest value).
+        */
+        Nanoseconds self;
+    };
+
+    /**
+       The nested messages from the outermost (the one which was taken
+       from the queue) to the innermost (the one that is stalled).
+    */
+    std::vector<Frame> frames;
+
+    /**
+       Time since the outermost message started (the stall time).
+    */
+    Nanoseconds duration;
+
+    /**
+       Time that the message loop was waiting for messages before the
+       stalled message (a small value means that the loop was busy).
+    */
+    Nanoseconds idleBefore;
+
+    /**
+       Messages processed by the loop before the stalled one.
+    */
+    unsigned long long messageCount;
+
+    [[nodiscard]] std::string getJson() const;
+
+};
+
+/**
+   Detects when the message loop of a thread does not process its
+   messages (the "Not responding" state of the windows).
+
+   The thread that is watched calls #beginMessage and #endMessage for
+   each processed message (a heartbeat), and an internal thread checks
+   the time spent in the current message periodically. When it exceeds
+   the threshold, a StallReport is generated with the messages that are
+   being processed, and the #Stall signal is fired (from the thread of
+   the watchdog, not from the stalled one). Each stall is reported only
+   once.
+
+   @code
+   HangWatchdog watchdog;
+   watchdog.Stall.connect([](const StallReport& report) {
+     log(report.getJson());
+   });
+   watchdog.attach();          // watch the current thread
+   watchdog.start(std::chrono::seconds(2));
+   CurrentThread::doMessageLoop();
+   @endcode
+
+   CurrentThread#processMessage and Widget#globalWndProc call
+   #beginMessage and #endMessage (through a HangWatchdog::Scope) for
+   the watchdog attached to the current thread, so only #attach is
+   needed for a UI thread. The core does not depend on Win32: other
+   loops (or a fake one) can call #beginMessage and #endMessage
+   directly, and the clock can be replaced to call #check with a
+   simulated time.
+*/
+class VACA_DLL HangWatchdog : private NonCopyable {
+public:
+
+    typedef std::chrono::nanoseconds Nanoseconds;
+
+    /**
+       Function that returns the current time of a monotonic clock.
+    */
+    typedef std::function<Nanoseconds()> ClockFunction;
+
+    /**
+       Calls #beginMessage in its constructor and #endMessage in its
+       destructor for the watchdog attached to the current thread. It
+       does nothing if the thread does not have a watchdog.
+
+       @internal
+    */
+    class VACA_DLL Scope : private NonCopyable {
+        HangWatchdog *m_watchdog;
+
+    public:
+        Scope(unsigned message, std::uintptr_t wParam, std::intptr_t lParam,
+              const void *widget, const std::type_info *type);
+
+        ~Scope();
+    };
+
+private:
+
+    struct Frame {
+        unsigned message;
+        std::uintptr_t wParam;
+        std::intptr_t lParam;
+        const void *widget;
+        const std::type_info *type;
+        Nanoseconds start;
+    };
+
+    ClockFunction m_clock;
+    Nanoseconds m_threshold;
+
+    // Messages in process (guarded by m_mutex)
+    std::vector<Frame> m_frames;
+    Nanoseconds m_lastBeat;
+    Nanoseconds m_idleBefore;
+    unsigned long long m_messageCount;
+    unsigned long long m_sequence;
+    unsigned long long m_reportedSequence;
+    unsigned long long m_stallCount;
+    mutable Mutex m_mutex;
+
+    Thread *m_thread;
+    bool m_stop;
+    ConditionVariable m_wakeUp;
+
+public:
+
+    HangWatchdog();
+
+    explicit HangWatchdog(const ClockFunction &clock);
+
+    virtual ~HangWatchdog();
+
+    void attach();
+
+    void detach();
+
+    static HangWatchdog *getCurrent();
+
+    void start(Nanoseconds threshold);
+
+    void stop();
+
+    [[nodiscard]] bool isRunning() const;
+
+    [[nodiscard]] Nanoseconds getThreshold() const;
+
+    void setThreshold(Nanoseconds threshold);
+
+    [[nodiscard]] unsigned long long getStallCount();
+
+    void beginMessage(unsigned message, std::uintptr_t wParam, std::intptr_t lParam,
+                      const void *widget = nullptr, const std::type_info *type = nullptr);
+
+    void endMessage();
+
+    bool check();
+
+    // Signals
+    SignalN<void(const StallReport &)> Stall; ///< @see onStall
+
+protected:
+
+    // Events
+    virtual void onStall(const StallReport &report);
+
+private:
+
+    void run();
+
+};
+
+} // namespace Wg
@@ -0,0 +1,100 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/ImagePixels.hpp"
+#include "Wg/NonCopyable.hpp"
+#include "Wg/Point.hpp"
+#include "Wg/Rect.hpp"
+#include "Wg/SkylinePacker.hpp"
+
+#include <vector>
+
+namespace Wg {
+
+/**
+   A big set of pixels where many small images (icons) are packed.
+
+   It is an alternative to ImageList when a lot of icons must be drawn
+   at the same time (e.g. tool bars or list views with hundreds of
+   items): all the icons of one frame are composed from the same
+   ImagePixels and copied to the screen in just one blit using
+   Graphics#drawImageAtlas.
+
+   Images are placed with a SkylinePacker, and each image is referenced
+   by the index returned from #addImage (like in ImageList).
+
+   @code
+   ImageAtlas atlas(Size(256, 256));
+   int open = atlas.addImage(openIcon.getPixels(), Color(255, 0, 255));
+   int save = atlas.addImage(saveIcon.getPixels(), Color(255, 0, 255));
+
+   std::vector<ImageAtlas::Item> items;
+   items.push_back(ImageAtlas::Item(open, Point(2, 2)));
+   items.push_back(ImageAtlas::Item(save, Point(20, 2)));
+   g.drawImageAtlas(atlas, items);
+   @endcode
+
+   @see ImageList, SkylinePacker, Graphics#drawImageAtlas
+*/
+class VACA_DLL ImageAtlas : private NonCopyable {
+public:
+
+    /**
+       An image of the atlas to be drawn in a specific position.
+    */
+    struct Item {
+        int index;
+        Point point;
+
+        Item(int index, const Point &point) : index(index), point(point) {}
+    };
+
+private:
+
+    ImagePixels m_pixels;
+    SkylinePacker m_packer;
+    std::vector<Rect> m_bounds;
+    int m_padding;
+    unsigned m_version;
+
+public:
+
+    explicit ImageAtlas(const Size &sz, int padding = 1);
+
+    virtual ~ImageAtlas();
+
+    [[nodiscard]] Size getSize() const;
+
+    [[nodiscard]] int getImageCount() const;
+
+    [[nodiscard]] Rect getImageBounds(int index) const;
+
+    [[nodiscard]] double getOccupancy() const;
+
+    [[nodiscard]] unsigned getVersion() const;
+
+    [[nodiscard]] const ImagePixels &getPixels() const;
+
+    int addImage(const ImagePixels &pixels);
+
+    int addImage(const ImagePixels &pixels, const Color &maskColor);
+
+    void removeAllImages();
+
+    [[nodiscard]] Rect getItemsBounds(const std::vector<Item> &items) const;
+
+    void drawImages(ImagePixels &dst, const std::vector<Item> &items, const Point &origin = Point(0, 0)) const;
+
+private:
+
+    int addImage(const ImagePixels &pixels, bool useMask, ImagePixels::pixel_type mask);
+
+};
+
+} // namespace Wg
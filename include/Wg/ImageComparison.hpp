@@ -0,0 +1,136 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/ImagePixels.hpp"
+#include "Wg/Rect.hpp"
+
+#include <vector>
+
+namespace Wg {
+
+// ======================================================================
+
+/**
+   It's like a namespace for ImageMetric.
+
+   @see ImageMetric
+*/
+struct ImageMetricEnum {
+    enum enumeration {
+        Exact,
+        Tolerance,
+        DeltaE,
+        Ssim
+    };
+    static const enumeration default_value = Exact;
+};
+
+/**
+   How two images are compared by ImageComparison.
+
+   One of the following values:
+   @li ImageMetric::Exact (default): all the channels of all the pixels
+       must be equal.
+   @li ImageMetric::Tolerance: a pixel is different if one of its
+       channels differs more than the tolerance.
+   @li ImageMetric::DeltaE: a pixel is different if the distance of
+       its colors in the CIE L*a*b* space (CIE76 delta-E) is greater
+       than the tolerance (2.3 is the just noticeable difference).
+   @li ImageMetric::Ssim: the images are equal if their mean
+       structural similarity (SSIM) is at least the threshold.
+
+   @see ImageComparison#setMetric
+*/
+typedef Enum<ImageMetricEnum> ImageMetric;
+
+// ======================================================================
+
+/**
+   Compares two ImagePixels to check that a change in the rendering
+   code did not change its output (e.g. against a golden image).
+
+   Rows that are exactly the same are detected with a fast comparison
+   (SSE2 when it is available) and skipped by the slower metrics, so
+   comparing images with small differences is cheap.
+
+   @code
+   ImageComparison cmp;
+   cmp.setMetric(ImageMetric::DeltaE);
+   cmp.setTolerance(2.3);
+   if (!cmp.compare(golden, rendered)) {
+     ImagePixels diff = cmp.createDiffImage(golden, rendered);
+     ...
+   }
+   @endcode
+
+   Perceptual metrics (ImageMetric::DeltaE and ImageMetric::Ssim) compare
+   the colors composed over a white background, so the color of fully
+   transparent pixels does not matter.
+*/
+class VACA_DLL ImageComparison {
+
+    ImageMetric m_metric;
+    double m_tolerance;
+    double m_threshold;
+    int m_maxDifferentPixels;
+
+    // Results of the last comparison
+    int m_differentPixels;
+    int m_identicalRows;
+    double m_maxDifference;
+    double m_ssim;
+    Rect m_differenceBounds;
+
+public:
+
+    ImageComparison();
+
+    virtual ~ImageComparison();
+
+    [[nodiscard]] ImageMetric getMetric() const;
+
+    void setMetric(ImageMetric metric);
+
+    [[nodiscard]] double getTolerance() const;
+
+    void setTolerance(double tolerance);
+
+    [[nodiscard]] double getThreshold() const;
+
+    void setThreshold(double threshold);
+
+    [[nodiscard]] int getMaxDifferentPixels() const;
+
+    void setMaxDifferentPixels(int count);
+
+    bool compare(const ImagePixels &a, const ImagePixels &b);
+
+    [[nodiscard]] int getDifferentPixels() const;
+
+    [[nodiscard]] int getIdenticalRows() const;
+
+    [[nodiscard]] double getMaxDifference() const;
+
+    [[nodiscard]] double getSsim() const;
+
+    [[nodiscard]] Rect getDifferenceBounds() const;
+
+    [[nodiscard]] ImagePixels createDiffImage(const ImagePixels &a, const ImagePixels &b) const;
+
+    static bool equalRows(const ImagePixels::pixel_type *a, const ImagePixels::pixel_type *b, int count);
+
+private:
+
+    [[nodiscard]] double getPixelDifference(ImagePixels::pixel_type a, ImagePixels::pixel_type b) const;
+
+    void compareSsim(const ImagePixels &a, const ImagePixels &b, const std::vector<bool> &identical);
+
+};
+
+} // namespace Wg
@@ -0,0 +1,57 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/ImagePixels.hpp"
+#include "Wg/Point.hpp"
+#include "Wg/Rect.hpp"
+
+namespace Wg {
+
+/**
+   Effects that can be applied to ImagePixels (blurs and shadows).
+
+   It is more like a namespace than a class, because all member
+   functions are static.
+
+   The blurs are separable and use a running sum, so their cost is
+   linear in the number of pixels and does not depend on the radius.
+   The Gaussian blur is approximated with three box blurs. Colors are
+   blurred with premultiplied alpha, so transparent pixels do not
+   darken their neighbours.
+
+   @code
+   // A shadow below a popup
+   ImagePixels popup = ...;
+   ImageEffects::drawDropShadow(screen, popup, Point(20, 20),
+                                Point(3, 3), 4.0, Color::Black, 128);
+   @endcode
+*/
+class VACA_DLL ImageEffects {
+public:
+
+    static void boxBlur(ImagePixels &pixels, int radius);
+
+    static void boxBlur(ImagePixels &pixels, const Rect &bounds, int radius);
+
+    static void gaussianBlur(ImagePixels &pixels, double sigma);
+
+    static void gaussianBlur(ImagePixels &pixels, const Rect &bounds, double sigma);
+
+    static int getShadowExtent(double sigma);
+
+    static ImagePixels createShadow(const ImagePixels &pixels, double sigma, const Color &color, int opacity = 255);
+
+    static void drawDropShadow(ImagePixels &dst, const ImagePixels &src, const Point &pt,
+                               const Point &shadowOffset, double sigma, const Color &color, int opacity = 128);
+
+    static void compose(ImagePixels &dst, const ImagePixels &src, const Point &pt);
+
+};
+
+} // namespace Wg
@@ -8,6 +8,8 @@
 
 #include <vector>
 #include <algorithm>
+#include <cassert>
+#include <cstdint>
 
 #include "Wg/Base.hpp"
 #include "Wg/Size.hpp"
@@ -18,7 +20,7 @@ namespace Wg {
 
 class ImagePixelsHandle : public Referenceable {
 public:
-    typedef UINT32 pixel_type;
+    typedef std::uint32_t pixel_type;
 
 private:
     int m_width{};
@@ -83,7 +85,8 @@ public:
     }
 
     void copyTo(ImagePixelsHandle &other) const {
-        std::copy(m_buffer.begin(), m_buffer.begin(), other.m_buffer.begin());
+        assert(other.m_buffer.size() == m_buffer.size());
+        std::copy(m_buffer.begin(), m_buffer.end(), other.m_buffer.begin());
     }
 
 private:
@@ -160,7 +163,7 @@ public:
 
     static int getB(pixel_type color) { return static_cast<int>(color & 0x000000ffu); }
 
-    static int getA(pixel_type color) { return static_cast<int>(color & 0xff000000u) >> 24; }
+    static int getA(pixel_type color) { return static_cast<int>((color & 0xff000000u) >> 24); }
 
     static pixel_type makePixel(int r, int g, int b, int a) {
         return
@@ -170,6 +173,26 @@ public:
                                         ((b & 0xff)));
     }
 
+    /**
+       Composes the @a src pixel over the @a dst pixel (both with
+       straight alpha, not premultiplied).
+    */
+    static pixel_type blendPixel(pixel_type dst, pixel_type src) {
+        int sa = getA(src);
+        if (sa == 255)
+            return src;
+        else if (sa == 0)
+            return dst;
+
+        int inv = getA(dst) * (255 - sa) / 255;
+        int a = sa + inv;
+
+        return makePixel((getR(src) * sa + getR(dst) * inv) / a,
+                         (getG(src) * sa + getG(dst) * inv) / a,
+                         (getB(src) * sa + getB(dst) * inv) / a,
+                         a);
+    }
+
 };
 
 } // namespace Wg
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "Wg/Base.hpp"
+#include "Wg/TextLayout.hpp"
 #include "Wg/Widget.hpp"
 
 namespace Wg {
@@ -23,6 +24,9 @@ namespace Wg {
      #getTextAlign and #getTextAlign member functions (like CustomLabel does).
 */
 class VACA_DLL Label : public Widget {
+    TextLayout m_textLayout;      // to paint the text
+    TextLayout m_measureLayout;   // to calculate the preferred size
+
 public:
 
     struct VACA_DLL Styles {
@@ -38,6 +42,8 @@ public:
 
     ~Label() override;
 
+    void setText(const String &str) override;
+
     [[nodiscard]] virtual TextAlign getTextAlign() const;
 
     virtual void setTextAlign(TextAlign align);
@@ -48,11 +54,17 @@ protected:
 
     int getFlagsForDrawString();
 
+    TextLayout &getTextLayout(int width);
+
     // Events
     void onPreferredSize(PreferredSizeEvent &ev) override;
 
     void onResize(ResizeEvent &ev) override;
 
+private:
+
+    void updateTextLayout(TextLayout &layout, int width);
+
 };
 
 } // namespace Wg
@@ -46,7 +46,7 @@ public:
 
     virtual Color getHoverColor();
 
-    Signal1<void, Event &> Click; ///< @see onClick
+    SignalN<void(Event &)> Click; ///< @see onClick
 
 protected:
 
@@ -48,8 +48,8 @@ public:
     std::vector<int> getSelectedItems();
 
     // Signals
-    Signal1<void, Event &> ItemDoubleClick; ///< @see onItemDoubleClick
-    Signal1<void, Event &> SelChange; ///< @see onSelChange
+    SignalN<void(Event &)> ItemDoubleClick; ///< @see onItemDoubleClick
+    SignalN<void(Event &)> SelChange; ///< @see onSelChange
 
 protected:
     // Events
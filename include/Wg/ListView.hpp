@@ -124,9 +124,9 @@ public:
 //   int getCurrentItem();
 
     // Signals
-    Signal1<void, ListViewEvent &> BeforeSelect;
-    Signal1<void, ListViewEvent &> AfterSelect;
-    Signal1<void, ListViewEvent &> ColumnClick;
+    SignalN<void(ListViewEvent &)> BeforeSelect;
+    SignalN<void(ListViewEvent &)> AfterSelect;
+    SignalN<void(ListViewEvent &)> ColumnClick;
 
 protected:
     // Events
@@ -44,6 +44,8 @@ public:
 
     ~MdiChild() override;
 
+    [[nodiscard]] static const MessageMap &getBaseMessageMap();
+
 protected:
     // Reflected notifications
     // virtual bool onReflectedCommand(int id, int code, LRESULT& lResult);
@@ -133,6 +135,8 @@ public:
 
     void refreshMenuBar();
 
+    [[nodiscard]] static const MessageMap &getBaseMessageMap();
+
 protected:
     bool wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT &lResult) override;
 //   virtual LRESULT defWndProc(UINT message, WPARAM wParam, LPARAM lParam);
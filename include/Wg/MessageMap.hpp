@@ -0,0 +1,189 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/NonCopyable.hpp"
+
+#include <atomic>
+#include <initializer_list>
+#include <typeinfo>
+#include <vector>
+
+namespace Wg {
+
+/**
+   Table of the messages that a class of widgets handles, used by
+   Widget#globalWndProc to dispatch the messages without walking the
+   chain of Widget#wndProc overrides.
+
+   Without a map, each message (even one that nobody handles like
+   @msdn{WM_NCHITTEST}) goes through the Widget#wndProc of each class
+   of the hierarchy before reaching Widget#defWndProc. A map is built
+   once for each class (the first time it is used) and it says what to
+   do with each message:
+   @li If the message has a handler, the handler is called directly.
+   @li If the message is handled by Widget#wndProc (see #forward), it
+       is passed to Widget#wndProc.
+   @li Other messages are passed directly to Widget#defWndProc.
+
+   A class of widgets uses a map calling Widget#setMessageMap from its
+   constructor. The map must be derived from the map of the base class
+   (the static getBaseMessageMap member function of each class, e.g.
+   Widget#getBaseMessageMap for a class derived from Widget):
+
+   @code
+   class Canvas : public Widget {
+   public:
+     Canvas(Widget* parent) : Widget(parent) {
+       static const MessageMap map(typeid(Canvas), Widget::getBaseMessageMap(), {
+         MessageMap::on<Canvas, &Canvas::onNcHitTest>(WM_NCHITTEST),
+         MessageMap::forward(WM_TIMER),
+       });
+       setMessageMap(map);
+     }
+   protected:
+     bool onNcHitTest(WPARAM wParam, LPARAM lParam, LRESULT& lResult) {
+       lResult = HTCLIENT;
+       return true;
+     }
+     bool wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lResult) override {
+       if (Widget::wndProc(message, wParam, lParam, lResult))
+         return true;
+       if (message == WM_TIMER) {
+         ...
+       }
+       return false;
+     }
+   };
+   @endcode
+
+   A handler returns true when the message was used (and lResult has the
+   value to return), or false to continue with Widget#wndProc (if the
+   message is forwarded) or Widget#defWndProc.
+
+   A map is used only for the widgets of the class specified in its
+   constructor: the widgets of a derived class that does not set its
+   own map receive all the messages in Widget#wndProc (as if no map
+   was used), so a derived class can override Widget#wndProc safely.
+   The classes of the library that override Widget#wndProc (like Frame)
+   have their own base map, and use it.
+
+   Each map counts how many times each message was dispatched through
+   it (see #getDispatchCount), so you can know which messages are worth
+   a handler.
+
+   @win32
+     The messages under @c WM_USER are found with a direct index. Other
+     messages (like the ones registered with
+     @msdn{RegisterWindowMessage}) are searched in a sorted list.
+   @endwin32
+*/
+class VACA_DLL MessageMap : private NonCopyable {
+public:
+
+    /**
+       Function called to handle a message.
+    */
+    typedef bool (*Handler)(Widget *widget, WPARAM wParam, LPARAM lParam, LRESULT &lResult);
+
+    /**
+       A message of the map.
+    */
+    struct Entry {
+        UINT message;
+        Handler handler;     // nullptr if it has not a handler
+        bool forward;        // true if Widget#wndProc handles the message
+    };
+
+private:
+
+    enum {
+        /**
+           Messages with a direct index (lower than @c WM_USER).
+        */
+        IndexedMessages = 0x0400
+    };
+
+    /**
+       Entries of the map (the index 0 is not used).
+    */
+    std::vector<Entry> m_entries;
+
+    /**
+       Class of the widgets that use this map.
+    */
+    const std::type_info &m_widgetClass;
+
+    /**
+       Position in #m_entries of each message lower than @c WM_USER
+       (0 if it is not in the map).
+    */
+    unsigned short m_index[IndexedMessages];
+
+    /**
+       Positions in #m_entries of the other messages (sorted by message).
+    */
+    std::vector<unsigned short> m_others;
+
+    /**
+       Number of times that each message lower than @c WM_USER was
+       dispatched, the last counter is for all the other messages.
+    */
+    mutable std::atomic<unsigned long> m_counts[IndexedMessages + 1];
+
+public:
+
+    MessageMap(const std::type_info &widgetClass, std::initializer_list<Entry> entries);
+
+    MessageMap(const std::type_info &widgetClass, const MessageMap &base, std::initializer_list<Entry> entries);
+
+    [[nodiscard]] bool isMapOf(const Widget *widget) const;
+
+    [[nodiscard]] bool contains(UINT message) const;
+
+    [[nodiscard]] unsigned long getDispatchCount(UINT message) const;
+
+    void resetDispatchCounts();
+
+    LRESULT dispatch(Widget *widget, UINT message, WPARAM wParam, LPARAM lParam) const;
+
+    /**
+       Creates an entry to call @a handler of the class @a T (which
+       must be derived from Widget) when @a message is received.
+
+       If the handler returns false, the message is passed to
+       Widget#wndProc (if the base map forwards it) or to
+       Widget#defWndProc.
+    */
+    template<class T, bool (T::*handler)(WPARAM, LPARAM, LRESULT &)>
+    static Entry on(UINT message) {
+        return Entry{message, &MessageMap::call<T, handler>, false};
+    }
+
+    /**
+       Creates an entry to pass @a message to Widget#wndProc (the
+       message is handled in an override of Widget#wndProc).
+    */
+    static Entry forward(UINT message) {
+        return Entry{message, nullptr, true};
+    }
+
+private:
+
+    void add(const Entry &entry);
+
+    [[nodiscard]] const Entry *find(UINT message) const;
+
+    template<class T, bool (T::*handler)(WPARAM, LPARAM, LRESULT &)>
+    static bool call(Widget *widget, WPARAM wParam, LPARAM lParam, LRESULT &lResult) {
+        return (static_cast<T *>(widget)->*handler)(wParam, lParam, lResult);
+    }
+
+};
+
+} // namespace Wg
@@ -56,6 +56,11 @@ typedef Enum<MouseButtonEnum> MouseButton;
 
    #getButton returns MouseButton::None if the event was produced by
    mouse movement (no button was pressed to trigger the event).
+
+   When the input coalescing of the thread is enabled (see
+   CurrentThread#setInputCoalescing), a mouse movement can represent
+   several positions of the mouse that were not received as individual
+   events (#getHistorySize and #getHistoryPoint).
 */
 class VACA_DLL MouseEvent : public ConsumableEvent {
     Point m_point;
@@ -63,6 +68,8 @@ class VACA_DLL MouseEvent : public ConsumableEvent {
     int m_flags;
     MouseButton m_trigger;
     int m_delta;
+    const Point *m_history;
+    int m_historySize;
 
 public:
 
@@ -94,6 +101,12 @@ public:
 
     [[nodiscard]] int getDelta() const;
 
+    [[nodiscard]] int getHistorySize() const;
+
+    [[nodiscard]] Point getHistoryPoint(int index) const;
+
+    void setHistory(const Point *points, int count);
+
 };
 
 } // namespace Wg
@@ -0,0 +1,139 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/ImagePixels.hpp"
+#include "Wg/Mutex.hpp"
+#include "Wg/NonCopyable.hpp"
+#include "Wg/Rect.hpp"
+#include "Wg/TimePoint.hpp"
+
+#include <map>
+#include <vector>
+
+namespace Wg {
+
+/**
+   Measures how often and how much each widget is painted.
+
+   It is disabled by default (so it does not cost anything). When it is
+   enabled, each paint of a widget (Widget#doPaint, and the
+   @msdn{WM_PAINT} messages of wrapped widgets, which are painted by the
+   system) is recorded:
+   @li how many times the widget was painted,
+   @li the time spent painting it (in its Widget#onPaint event and the
+       double-buffering),
+   @li the area that was painted and the visible area of the widget.
+
+   It also counts how many times each pixel of a window was painted, so
+   #createHeatmap can show where the widgets are overdrawing each other.
+
+   @code
+   PaintProfiler& profiler(PaintProfiler::getInstance());
+   profiler.setEnabled(true);
+   ...
+   // The widgets that need a cache are at the top of the report
+   String report = profiler.getReport();
+   ImagePixels heatmap = profiler.createHeatmap(&frame);
+   @endcode
+*/
+class VACA_DLL PaintProfiler : private NonCopyable {
+public:
+
+    /**
+       Paint statistics of a widget.
+    */
+    struct Stats {
+        /**
+           The widget that was painted, or nullptr for the sum of the
+           destroyed widgets of the same class (see #name).
+        */
+        Widget *widget;
+
+        /**
+           Name of the window class of the widget.
+        */
+        String name;
+
+        int paintCount;
+
+        /**
+           Seconds spent in all the paints.
+        */
+        double paintTime;
+
+        /**
+           Sum of the areas (in pixels) painted each time.
+        */
+        double paintedArea;
+
+        /**
+           Sum of the areas (in pixels) that were visible each time the
+           widget was painted. If it is equal to #paintedArea, each
+           paint covered the whole widget.
+        */
+        double visibleArea;
+    };
+
+    /**
+       Measures a paint from its creation to its destruction.
+
+       @internal
+    */
+    class Scope : private NonCopyable {
+        Widget *m_widget;
+        Rect m_bounds;
+        TimePoint m_time;
+
+    public:
+        Scope(Widget *widget, Graphics &g);
+
+        ~Scope();
+    };
+
+private:
+
+    // Counter of paints of each pixel of a top-level window
+    struct Heat {
+        Size size;
+        std::vector<unsigned short> counts;
+    };
+
+    bool m_enabled;
+    std::map<Widget *, Stats> m_stats;
+    std::map<String, Stats> m_destroyed; // stats of destroyed widgets by class
+    std::map<HWND, Heat> m_heat;
+    mutable Mutex m_mutex;
+
+    PaintProfiler();
+
+public:
+
+    virtual ~PaintProfiler();
+
+    static PaintProfiler &getInstance();
+
+    [[nodiscard]] bool isEnabled() const;
+
+    void setEnabled(bool state);
+
+    void reset();
+
+    void addPaint(Widget *widget, const Rect &bounds, double seconds);
+
+    void removeWidget(Widget *widget);
+
+    [[nodiscard]] std::vector<Stats> getStats() const;
+
+    [[nodiscard]] String getReport() const;
+
+    [[nodiscard]] ImagePixels createHeatmap(Widget *window) const;
+
+};
+
+} // namespace Wg
@@ -0,0 +1,116 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/GraphicsPath.hpp"
+#include "Wg/ImagePixels.hpp"
+#include "Wg/NonCopyable.hpp"
+#include "Wg/Pen.hpp"
+#include "Wg/Point.hpp"
+#include "Wg/Rect.hpp"
+
+#include <vector>
+
+namespace Wg {
+
+/**
+   Anti-aliased scanline rasterizer for GraphicsPath.
+
+   It draws paths in ImagePixels without the system (GDI paths are
+   aliased and need a device context). The outlines are accumulated as
+   sparse cells: each pixel crossed by an edge stores how much the
+   edge covers it, and the pixels between cells are filled in spans
+   with the accumulated winding of their scanline. So the cost depends
+   on the length of the outlines, not on the area of the shapes.
+
+   @code
+   PathRasterizer ras;
+   ras.addPath(path);
+   ras.fill(pixels, Color::Red, FillRule::Winding);
+
+   ras.reset();
+   ras.addStroke(path, pen, g.getMiterLimit());
+   ras.fill(pixels, pen.getColor(), FillRule::Winding);
+   @endcode
+
+   To draw the same path many times, use the rasterizers cached in the
+   path (GraphicsPath#getFillRasterizer and
+   GraphicsPath#getStrokeRasterizer) with a different @a offset in
+   #fill instead of accumulating the path again.
+
+   @see GraphicsPath#flatten(std::vector<GraphicsPath::Figure>&, double) const
+*/
+class VACA_DLL PathRasterizer : private NonCopyable {
+
+    struct Cell {
+        int x, y;
+        int cover;
+        int area;
+
+        bool operator<(const Cell &other) const {
+            return y < other.y || (y == other.y && x < other.x);
+        }
+    };
+
+    mutable std::vector<Cell> m_cells;
+    mutable bool m_sorted;
+    double m_tolerance;
+    bool m_started;
+    int m_x, m_y;            // current position (fixed point)
+    int m_startX, m_startY;  // first point of the current figure
+
+public:
+
+    explicit PathRasterizer(double tolerance = 0.25);
+
+    virtual ~PathRasterizer();
+
+    [[nodiscard]] double getTolerance() const;
+
+    void setTolerance(double tolerance);
+
+    [[nodiscard]] int getCellCount() const;
+
+    [[nodiscard]] Rect getBounds() const;
+
+    void reset();
+
+    void moveTo(double x, double y);
+
+    void lineTo(double x, double y);
+
+    void closeFigure();
+
+    void addPath(const GraphicsPath &path);
+
+#ifdef VACA_ON_WINDOWS
+    void addStroke(const GraphicsPath &path, const Pen &pen, double miterLimit = 10.0);
+#endif
+
+    void addStroke(const GraphicsPath &path, double width,
+                   PenJoin join, PenEndCap endCap, double miterLimit = 10.0);
+
+    void fill(ImagePixels &dst, const Color &color, FillRule fillRule, const Point &offset = Point(0, 0)) const;
+
+private:
+
+    void addPolygon(const std::vector<GraphicsPath::Vertex> &vertices);
+
+    void addCircle(const GraphicsPath::Vertex &center, double radius);
+
+    void renderLine(int x1, int y1, int x2, int y2);
+
+    void renderScanline(int ey, int x1, int y1, int x2, int y2);
+
+    void addCell(int ex, int ey, int cover, int area);
+
+    void sortCells() const;
+
+};
+
+} // namespace Wg
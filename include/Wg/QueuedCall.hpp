@@ -0,0 +1,208 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/Debug.hpp"
+#include "Wg/Mutex.hpp"
+#include "Wg/ScopedLock.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace Wg {
+
+// ======================================================================
+
+/**
+   It's like a namespace for ConnectionType.
+
+   @see ConnectionType
+*/
+struct ConnectionTypeEnum {
+    enum enumeration {
+        Direct,
+        Queued,
+        Coalesced
+    };
+    static const enumeration default_value = Direct;
+};
+
+/**
+   How a slot is called when a signal is emitted.
+
+   One of the following values:
+   @li ConnectionType::Direct (default): the slot is called immediately
+       in the thread that emits the signal.
+   @li ConnectionType::Queued: the arguments are copied, and the slot is
+       called later by the message loop of the target thread (once for
+       each emission).
+   @li ConnectionType::Coalesced: like ConnectionType::Queued, but the
+       emissions that are still pending are replaced by the last one (the
+       slot is called once with the latest arguments).
+
+   @see SignalN#connect, ConcurrentSignal#connect
+*/
+typedef Enum<ConnectionTypeEnum> ConnectionType;
+
+// ======================================================================
+
+/**
+   A call to a slot that is sent to the message queue of other thread
+   (the envelope of a queued connection).
+
+   The envelopes are allocated from the EventPool (so emitting a queued
+   signal many times does not use the general heap), and are posted with @msdn{PostThreadMessage} as a registered
+   Message. They are delivered by CurrentThread#processMessage.
+
+   @warning
+     The messages of a thread are not delivered while a modal loop of
+     the system (e.g. a MsgBox) is running in that thread.
+
+   @internal
+*/
+class VACA_DLL QueuedCall {
+public:
+
+    QueuedCall();
+
+    virtual ~QueuedCall();
+
+    virtual void deliver() = 0;
+
+    static bool post(ThreadId thread, QueuedCall *call);
+
+    static bool dispatch(Message &message);
+
+    static void discardPending();
+
+    static unsigned getPostedCount();
+
+    static void *operator new(std::size_t size);
+
+    static void operator delete(void *ptr, std::size_t size);
+
+};
+
+// ======================================================================
+
+/**
+   Functor that calls @a F through a queued connection. It is connected
+   to a signal by SignalN#connect(const F&, ConnectionType, ThreadId).
+
+   @internal
+*/
+template<typename F, typename... A>
+class QueuedSlot {
+    typedef std::tuple<typename std::decay<A>::type...> Arguments;
+
+    // Shared by the copies of the slot and the pending calls
+    struct State {
+        std::atomic<int> refs;
+        F f;
+        ThreadId thread;
+        ConnectionType type;
+        Mutex mutex;                    // for ConnectionType::Coalesced
+        std::optional<Arguments> latest; // last arguments not delivered yet
+
+        State(const F &f, ConnectionType type, ThreadId thread)
+                : refs(1), f(f), thread(thread), type(type) {}
+
+        void ref() { refs.fetch_add(1, std::memory_order_relaxed); }
+
+        void unref() {
+            if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                delete this;
+        }
+    };
+
+    // Delivers a copy of the arguments
+    class Call : public QueuedCall {
+        State *m_state;
+        Arguments m_args;
+    public:
+        Call(State *state, const Arguments &args) : m_state(state), m_args(args) { m_state->ref(); }
+
+        ~Call() override { m_state->unref(); }
+
+        void deliver() override { std::apply(m_state->f, m_args); }
+    };
+
+    // Delivers the latest arguments of the state
+    class CoalescedCall : public QueuedCall {
+        State *m_state;
+    public:
+        explicit CoalescedCall(State *state) : m_state(state) { m_state->ref(); }
+
+        ~CoalescedCall() override { m_state->unref(); }
+
+        void deliver() override {
+            std::optional<Arguments> args;
+            {
+                ScopedLock hold(m_state->mutex);
+                args.swap(m_state->latest);
+            }
+            if (args)
+                std::apply(m_state->f, *args);
+        }
+    };
+
+    State *m_state;
+
+public:
+
+    QueuedSlot(const F &f, ConnectionType type, ThreadId thread)
+            : m_state(new State(f, type, thread)) {
+    }
+
+    QueuedSlot(const QueuedSlot &other)
+            : m_state(other.m_state) {
+        m_state->ref();
+    }
+
+    ~QueuedSlot() {
+        m_state->unref();
+    }
+
+    QueuedSlot &operator=(const QueuedSlot &other) {
+        other.m_state->ref();
+        m_state->unref();
+        m_state = other.m_state;
+        return *this;
+    }
+
+    void operator()(A... args) {
+        if (m_state->type == ConnectionType::Coalesced) {
+            bool pending;
+            {
+                ScopedLock hold(m_state->mutex);
+                pending = m_state->latest.has_value();
+                m_state->latest.emplace(args...);
+            }
+            // Only the first emission posts a call, the next ones just
+            // replace the arguments until the call is delivered
+            if (!pending &&
+                !QueuedCall::post(m_state->thread, new CoalescedCall(m_state))) {
+                VACA_TRACE("QueuedSlot: thread %u cannot receive calls, the emission is lost\n",
+                           m_state->thread);
+                ScopedLock hold(m_state->mutex);
+                m_state->latest.reset();
+            }
+        }
+        else if (!QueuedCall::post(m_state->thread, new Call(m_state, Arguments(args...)))) {
+            VACA_TRACE("QueuedSlot: thread %u cannot receive calls, the emission is lost\n",
+                       m_state->thread);
+        }
+    }
+
+};
+
+} // namespace Wg
@@ -44,7 +44,7 @@ public:
     bool operator==(const RadioGroup &other) const;
 
     // Signals
-    Signal1<void, Event &> Change; ///< @see onChange
+    SignalN<void(Event &)> Change; ///< @see onChange
 
 protected:
     // New events
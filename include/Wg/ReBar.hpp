@@ -139,7 +139,7 @@ public:
 
 public:
     // Signals
-    Signal1<void, Event &> AutoSize;
+    SignalN<void(Event &)> AutoSize;
 
 protected:
     // Events
@@ -9,16 +9,23 @@
 #include "Wg/Base.hpp"
 #include "Wg/NonCopyable.hpp"
 
+#include <vector>
+
 namespace Wg {
 
 /**
    Class that counts references and can be wrapped by a SharedPtr.
+
+   The signal connections that track a Referenceable are disconnected
+   when it is destroyed (see Connection#track).
 */
 class VACA_DLL Referenceable : private NonCopyable {
     template<class> friend
     class SharedPtr;
+    friend class Connection;
 
     unsigned m_refCount;
+    std::vector<Connection> *m_connections;
 
 public:
 
@@ -38,6 +45,10 @@ public:
 
 private:
     void destroy();
+
+    void trackConnection(const Connection &conn);
+
+    void disconnectTrackedConnections();
 };
 
 } // namespace Wg
@@ -627,7 +627,7 @@ public:
     // Notifications
 
     // Signals
-    Signal0<void> UpdateUI; ///< @see onUpdateUI
+    SignalN<void()> UpdateUI; ///< @see onUpdateUI
 
 protected:
     // Reflected notifications
@@ -8,6 +8,10 @@
 
 #include "Wg/Base.hpp"
 
+#include <cstdint>
+#include <memory>
+#include <utility>
+
 namespace Wg {
 
 /**
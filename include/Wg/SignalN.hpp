@@ -0,0 +1,584 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/Connection.hpp"
+#include "Wg/QueuedCall.hpp"
+
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace Wg {
+
+/**
+   @defgroup signal_group Signal Classes
+   @{
+ */
+
+template<typename>
+class SignalN;
+
+/**
+   Signal with any number of arguments, e.g. @c SignalN<void(Event&)>.
+
+   Unlike Signal0 ... Signal4 (which allocate a Slot0 ... Slot4 for each
+   connection and call it through a virtual member function), the slots
+   are stored in one contiguous array:
+   @li Member function bindings and small functors (lambdas with a few
+       captures, Bind adapters) are stored inline in the slot (they
+       cannot be bigger than #InlineSize bytes). Only bigger functors
+       are allocated.
+   @li Each slot is called through a plain function pointer (like the
+       forwarders of Signal2.hpp).
+   @li Functors that can be copied with @c memcpy (the usual case) are
+       moved and copied without calling any of their member functions.
+
+   So connecting a slot does not allocate memory (except when the array
+   grows), and emitting the signal is a loop of indirect calls.
+
+   An empty signal is only two pointers and two integers (24 bytes in
+   64-bit platforms, like a @c std::vector). The state that is needed
+   only when there are slots (the table of connections, tombstones and
+   emissions) is allocated with the first slot.
+
+   Slots can be connected and disconnected while the signal is being
+   emitted (also the slot that is being executed): the new slots are
+   called in the next emission, and the disconnected slots are not
+   called anymore.
+
+   #connect returns a Connection that disconnects the slot in O(1): the
+   disconnected slot is only marked as a tombstone, and the array is
+   compacted when half of its slots are tombstones (or when it is full).
+
+   @code
+   SignalN<void(Event&)> Click;
+   Click.connect(&MyFrame::onClick, this);
+   Click.connect([this](Event& ev) { ... });
+   Click(ev);
+   @endcode
+*/
+template<typename R, typename... A>
+class SignalN<R(A...)> {
+public:
+    typedef R ReturnType;
+
+    enum {
+        /**
+           Maximum size of a functor that is stored inline.
+        */
+        InlineSize = 3 * sizeof(void *)
+    };
+
+private:
+
+    typedef R (*Invoker)(void *functor, A... args);
+
+    // How to copy and destroy a functor that is not trivially copyable
+    struct Manager {
+        void (*copy)(void *dst, const void *src);
+        void (*destroy)(void *functor);
+    };
+
+    struct Slot {
+        Invoker invoke;          // nullptr if the slot was disconnected
+        const Manager *manager;  // nullptr for trivially copyable functors
+        unsigned handle;         // index in the table of connections
+        alignas(void *) unsigned char storage[InlineSize];
+    };
+
+    // Entry of the table of connections. The generation is incremented
+    // each time the slot is disconnected, so old Connections do not
+    // match the next slot that uses the entry
+    struct Handle {
+        unsigned position;       // in m_slots (or next free entry)
+        unsigned generation;
+    };
+
+    // Array of slots that was replaced while the signal was being
+    // emitted (a slot could be running from it)
+    struct Retired {
+        Slot *slots;
+        unsigned count;
+        Retired *next;
+    };
+
+    // Binding of a member function to an object
+    template<class T>
+    struct MemberBinding {
+        R (T::*m)(A...);
+        T *t;
+
+        R operator()(A... args) { return (t->*m)(std::forward<A>(args)...); }
+    };
+
+    template<typename F>
+    struct IsInline {
+        enum {
+            value = sizeof(F) <= InlineSize && alignof(F) <= alignof(void *)
+        };
+    };
+
+    enum { NoHandle = ~0u };
+
+    // The state of a signal with slots (most signals do not have
+    // slots, so it is allocated with the first one)
+    struct Extra {
+        Retired *retired = nullptr;
+        Handle *handles = nullptr;
+        Connection::Link *link = nullptr;
+        unsigned dead = 0;       // tombstones
+        unsigned handleCount = 0;
+        unsigned handleCapacity = 0;
+        unsigned freeHandle = NoHandle;
+        unsigned short emitting = 0;
+    };
+
+    Slot *m_slots;
+    Extra *m_extra;
+    unsigned m_count;            // slots in the array (also tombstones)
+    unsigned m_capacity;
+
+public:
+
+    SignalN()
+            : m_slots(nullptr), m_extra(nullptr), m_count(0), m_capacity(0) {
+    }
+
+    SignalN(const SignalN &s)
+            : SignalN() {
+        copy(s);
+    }
+
+    ~SignalN() {
+        assert(getEmitting() == 0);
+        disconnectAll();
+        delete[] m_slots;
+
+        if (m_extra != nullptr) {
+            delete[] m_extra->handles;
+
+            if (m_extra->link != nullptr) {
+                m_extra->link->signal = nullptr;
+                m_extra->link->unref();
+            }
+            delete m_extra;
+        }
+    }
+
+    SignalN &operator=(const SignalN &s) {
+        if (this != &s) {
+            disconnectAll();
+            copy(s);
+        }
+        return *this;
+    }
+
+    template<typename F>
+    Connection connect(const F &f) {
+        return addSlot(f);
+    }
+
+    template<class T>
+    Connection connect(R (T::*m)(A...), T *t) {
+        return addSlot(MemberBinding<T>{m, t});
+    }
+
+    /**
+       Connects the functor @a f to be called in the thread @a thread.
+
+       @param type
+         ConnectionType::Direct calls @a f in the thread that emits the
+         signal (like #connect(const F&)). ConnectionType::Queued and
+         ConnectionType::Coalesced post the call to the message queue of
+         @a thread (they can be used only if @a R is @c void).
+
+       @warning
+         The objects used by @a f must live until the calls that are
+         still in the queue are delivered.
+    */
+    template<typename F>
+    Connection connect(const F &f, ConnectionType type, ThreadId thread) {
+        if constexpr (std::is_void<R>::value) {
+            if (type != ConnectionType::Direct)
+                return connect(QueuedSlot<F, A...>(f, type, thread));
+        }
+        else
+            assert(type == ConnectionType::Direct);
+
+        return connect(f);
+    }
+
+    template<class T>
+    Connection connect(R (T::*m)(A...), T *t, ConnectionType type, ThreadId thread) {
+        return connect(MemberBinding<T>{m, t}, type, thread);
+    }
+
+    /**
+       Disconnects all the slots that call the member function @a m of
+       the object @a t.
+    */
+    template<class T>
+    void disconnect(R (T::*m)(A...), T *t) {
+        for (unsigned i = 0; i < m_count; ++i) {
+            MemberBinding<T> *binding = getFunctor<MemberBinding<T> >(m_slots[i]);
+            if (binding != nullptr && binding->m == m && binding->t == t)
+                removeSlot(i);
+        }
+        compactLazily();
+    }
+
+    void disconnectAll() {
+        for (unsigned i = 0; i < m_count; ++i)
+            removeSlot(i);
+        compact();
+    }
+
+    [[nodiscard]] bool empty() const {
+        return m_count == getDead();
+    }
+
+    /**
+       Returns the number of connected slots.
+    */
+    [[nodiscard]] unsigned getSlotCount() const {
+        return m_count - getDead();
+    }
+
+    /**
+       Calls all the connected slots in the order they were connected.
+
+       @return
+         The value returned by the last slot (or @c R() if there are no
+         slots).
+    */
+    R operator()(A... args) {
+        if (m_count == 0)
+            return R();
+
+        EmitScope scope(this);
+        const unsigned count = m_count;
+
+        if constexpr (std::is_void<R>::value) {
+            for (unsigned i = 0; i < count; ++i) {
+                Slot &slot = m_slots[i];
+                if (slot.invoke != nullptr)
+                    slot.invoke(slot.storage, args...);
+            }
+        }
+        else {
+            R result = R();
+            for (unsigned i = 0; i < count; ++i) {
+                Slot &slot = m_slots[i];
+                if (slot.invoke != nullptr)
+                    result = slot.invoke(slot.storage, args...);
+            }
+            return result;
+        }
+    }
+
+private:
+
+    // Keeps the count of nested emissions
+    class EmitScope {
+        SignalN *m_signal;
+    public:
+        explicit EmitScope(SignalN *signal) : m_signal(signal) { ++m_signal->m_extra->emitting; }
+
+        ~EmitScope() {
+            if (--m_signal->m_extra->emitting == 0)
+                m_signal->endEmit();
+        }
+    };
+
+    Extra &getExtra() {
+        if (m_extra == nullptr)
+            m_extra = new Extra;
+        return *m_extra;
+    }
+
+    unsigned getDead() const {
+        return m_extra != nullptr ? m_extra->dead : 0;
+    }
+
+    unsigned getEmitting() const {
+        return m_extra != nullptr ? m_extra->emitting : 0;
+    }
+
+    template<typename F>
+    static R invokeInline(void *functor, A... args) {
+        return (*reinterpret_cast<F *>(functor))(std::forward<A>(args)...);
+    }
+
+    template<typename F>
+    static R invokeAllocated(void *functor, A... args) {
+        return (**reinterpret_cast<F **>(functor))(std::forward<A>(args)...);
+    }
+
+    template<typename F>
+    static void copyInline(void *dst, const void *src) {
+        new(dst) F(*reinterpret_cast<const F *>(src));
+    }
+
+    template<typename F>
+    static void destroyInline(void *functor) {
+        reinterpret_cast<F *>(functor)->~F();
+    }
+
+    template<typename F>
+    static void copyAllocated(void *dst, const void *src) {
+        *reinterpret_cast<F **>(dst) = new F(**reinterpret_cast<F *const *>(src));
+    }
+
+    template<typename F>
+    static void destroyAllocated(void *functor) {
+        delete *reinterpret_cast<F **>(functor);
+    }
+
+    template<typename F>
+    static const Manager *getManager() {
+        if constexpr (!IsInline<F>::value) {
+            static const Manager manager = {&copyAllocated<F>, &destroyAllocated<F>};
+            return &manager;
+        }
+        else if constexpr (!std::is_trivially_copyable<F>::value) {
+            static const Manager manager = {&copyInline<F>, &destroyInline<F>};
+            return &manager;
+        }
+        else
+            return nullptr;
+    }
+
+    // Returns the functor of the slot if it is of type F
+    template<typename F>
+    static F *getFunctor(Slot &slot) {
+        if constexpr (IsInline<F>::value)
+            return slot.invoke == &invokeInline<F> ? reinterpret_cast<F *>(slot.storage) : nullptr;
+        else
+            return slot.invoke == &invokeAllocated<F> ? *reinterpret_cast<F **>(slot.storage) : nullptr;
+    }
+
+    Connection::Link *getLink() {
+        Extra &extra = getExtra();
+        if (extra.link == nullptr)
+            extra.link = new Connection::Link{1, this, &isConnectedHandle, &disconnectHandle};
+        return extra.link;
+    }
+
+    static bool isConnectedHandle(void *signal, unsigned index, unsigned generation) {
+        const Extra *extra = static_cast<const SignalN *>(signal)->m_extra;
+        return extra != nullptr &&
+               index < extra->handleCount && extra->handles[index].generation == generation;
+    }
+
+    static void disconnectHandle(void *signal, unsigned index, unsigned generation) {
+        SignalN *s = static_cast<SignalN *>(signal);
+        if (isConnectedHandle(signal, index, generation)) {
+            s->removeSlot(s->m_extra->handles[index].position);
+            s->compactLazily();
+        }
+    }
+
+    // Returns an entry of the table of connections for the slot at "position"
+    unsigned allocHandle(unsigned position) {
+        Extra &extra = getExtra();
+        unsigned index;
+        if (extra.freeHandle != NoHandle) {
+            index = extra.freeHandle;
+            extra.freeHandle = extra.handles[index].position;
+        }
+        else {
+            if (extra.handleCount == extra.handleCapacity) {
+                unsigned newCapacity = extra.handleCapacity < 2 ? 2 : extra.handleCapacity * 2;
+                Handle *handles = new Handle[newCapacity];
+                if (extra.handleCount > 0)
+                    std::memcpy(handles, extra.handles, extra.handleCount * sizeof(Handle));
+                delete[] extra.handles;
+                extra.handles = handles;
+                extra.handleCapacity = newCapacity;
+            }
+            index = extra.handleCount++;
+            extra.handles[index].generation = 0;
+        }
+        extra.handles[index].position = position;
+        return index;
+    }
+
+    void freeHandle(unsigned index) {
+        Handle &handle = m_extra->handles[index];
+        ++handle.generation;
+        handle.position = m_extra->freeHandle;
+        m_extra->freeHandle = index;
+    }
+
+    template<typename F>
+    Connection addSlot(const F &f) {
+        reserve(m_count + 1);
+
+        Slot &slot = m_slots[m_count];
+        if constexpr (IsInline<F>::value) {
+            new(slot.storage) F(f);
+            slot.invoke = &invokeInline<F>;
+        }
+        else {
+            *reinterpret_cast<F **>(slot.storage) = new F(f);
+            slot.invoke = &invokeAllocated<F>;
+        }
+        slot.manager = getManager<F>();
+        slot.handle = allocHandle(m_count);
+        ++m_count;
+
+        return Connection(getLink(), slot.handle, m_extra->handles[slot.handle].generation);
+    }
+
+    // Disconnects the slot "i" (it is a tombstone until the next
+    // compaction). Its functor is destroyed later if the signal is
+    // being emitted (it could be running)
+    void removeSlot(unsigned i) {
+        Slot &slot = m_slots[i];
+        if (slot.invoke == nullptr)
+            return;
+
+        slot.invoke = nullptr;
+        if (m_extra->emitting == 0) {
+            if (slot.manager != nullptr)
+                slot.manager->destroy(slot.storage);
+            slot.manager = nullptr;
+        }
+        freeHandle(slot.handle);
+        ++m_extra->dead;
+    }
+
+    // Compacts the array if half of the slots are tombstones
+    void compactLazily() {
+        unsigned dead = getDead();
+        if (dead > 0 && dead * 2 >= m_count)
+            compact();
+    }
+
+    // Removes the tombstones from the array
+    void compact() {
+        if (getDead() == 0 || m_extra->emitting > 0)
+            return;
+
+        unsigned j = 0;
+        for (unsigned i = 0; i < m_count; ++i) {
+            Slot &slot = m_slots[i];
+            if (slot.invoke == nullptr) {
+                if (slot.manager != nullptr)
+                    slot.manager->destroy(slot.storage);
+            }
+            else {
+                if (i != j) {
+                    relocate(m_slots[j], slot);
+                    m_extra->handles[slot.handle].position = j;
+                }
+                ++j;
+            }
+        }
+        m_count = j;
+        m_extra->dead = 0;
+    }
+
+    void endEmit() {
+        while (m_extra->retired != nullptr) {
+            Retired *retired = m_extra->retired;
+            m_extra->retired = retired->next;
+
+            for (unsigned i = 0; i < retired->count; ++i) {
+                Slot &slot = retired->slots[i];
+                if (slot.manager != nullptr)
+                    slot.manager->destroy(slot.storage);
+            }
+            delete[] retired->slots;
+            delete retired;
+        }
+        compactLazily();
+    }
+
+    // Copies the functor of a slot to an uninitialized one
+    static void copySlot(Slot &dst, const Slot &src) {
+        if (src.manager != nullptr)
+            src.manager->copy(dst.storage, src.storage);
+        else
+            std::memcpy(dst.storage, src.storage, InlineSize);
+        dst.invoke = src.invoke;
+        dst.manager = src.manager;
+        dst.handle = src.handle;
+    }
+
+    // Moves a slot to an uninitialized one
+    static void relocate(Slot &dst, Slot &src) {
+        if (src.manager != nullptr) {
+            src.manager->copy(dst.storage, src.storage);
+            src.manager->destroy(src.storage);
+        }
+        else
+            std::memcpy(dst.storage, src.storage, InlineSize);
+        dst.invoke = src.invoke;
+        dst.manager = src.manager;
+        dst.handle = src.handle;
+    }
+
+    void reserve(unsigned capacity) {
+        if (capacity <= m_capacity)
+            return;
+
+        Extra &extra = getExtra();
+
+        // Reuse the space of the tombstones before growing the array
+        // (if there are enough tombstones to amortize the compaction)
+        if (extra.emitting == 0 && extra.dead * 4 >= m_count && extra.dead > 0) {
+            capacity -= extra.dead;
+            compact();
+            if (capacity <= m_capacity)
+                return;
+        }
+
+        unsigned newCapacity = max_value(capacity, m_capacity < 2 ? 2 : m_capacity * 2);
+        Slot *slots = new Slot[newCapacity];
+
+        if (extra.emitting == 0) {
+            for (unsigned i = 0; i < m_count; ++i)
+                relocate(slots[i], m_slots[i]);
+            delete[] m_slots;
+        }
+        else {
+            // A slot could be running from the old array, so its
+            // functors are copied and destroyed after the emission
+            for (unsigned i = 0; i < m_count; ++i)
+                copySlot(slots[i], m_slots[i]);
+            extra.retired = new Retired{m_slots, m_count, extra.retired};
+        }
+
+        m_slots = slots;
+        m_capacity = newCapacity;
+    }
+
+    void copy(const SignalN &s) {
+        reserve(m_count + s.getSlotCount());
+
+        for (unsigned i = 0; i < s.m_count; ++i) {
+            const Slot &src = s.m_slots[i];
+            if (src.invoke == nullptr)
+                continue;
+
+            Slot &dst = m_slots[m_count];
+            copySlot(dst, src);
+            dst.handle = allocHandle(m_count);
+            ++m_count;
+        }
+    }
+
+};
+
+/** @} */
+
+} // namespace Wg
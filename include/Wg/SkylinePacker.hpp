@@ -0,0 +1,62 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/Point.hpp"
+#include "Wg/Size.hpp"
+
+#include <vector>
+
+namespace Wg {
+
+/**
+   Packs rectangles inside a fixed area using the skyline bottom-left
+   heuristic.
+
+   The packer keeps the upper contour (the "skyline") of the already
+   placed rectangles as a list of horizontal segments. Each new
+   rectangle is placed at the position that leaves it lowest, with the
+   narrowest segment used to break ties. Insertion is O(n) in the
+   number of segments, which stays small for the typical use (icons
+   and glyphs of similar heights).
+
+   @see ImageAtlas
+*/
+class VACA_DLL SkylinePacker {
+
+    struct Segment {
+        int x, y, w;
+    };
+
+    Size m_size;
+    std::vector<Segment> m_skyline;
+    long m_usedArea;
+
+public:
+
+    explicit SkylinePacker(const Size &sz);
+
+    virtual ~SkylinePacker();
+
+    [[nodiscard]] Size getSize() const;
+
+    [[nodiscard]] double getOccupancy() const;
+
+    bool insert(const Size &sz, Point &origin);
+
+    void clear();
+
+private:
+
+    bool fits(size_t index, const Size &sz, int &y) const;
+
+    void addLevel(size_t index, const Point &origin, const Size &sz);
+
+};
+
+} // namespace Wg
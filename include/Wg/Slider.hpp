@@ -60,7 +60,7 @@ public:
     void setPageSize(int pageSize);
 
     // Signals
-    Signal1<void, Event &> Change; ///< @see onChange
+    SignalN<void(Event &)> Change; ///< @see onChange
 
 protected:
     // Events
@@ -79,9 +79,9 @@ public:
     void setBuddy(Widget *buddy);
 
     // Signals
-    Signal1<void, SpinButtonEvent &> Change;
-//   Signal1<void, SpinButtonEvent&> BeforeChange;
-//   Signal1<void, SpinButtonEvent&> AfterChange;
+    SignalN<void(SpinButtonEvent &)> Change;
+//   SignalN<void(SpinButtonEvent &)> BeforeChange;
+//   SignalN<void(SpinButtonEvent &)> AfterChange;
 
 protected:
     // Events
@@ -74,8 +74,8 @@ public:
     Size getNonClientSize();
 
     // Signals
-//   Signal1<void, Event&> PageChanging;
-    Signal1<void, Event &> PageChange; ///< @see onPageChange
+//   SignalN<void(Event &)> PageChanging;
+    SignalN<void(Event &)> PageChange; ///< @see onPageChange
 
 protected:
     // Events
@@ -0,0 +1,499 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/Exception.hpp"
+#include "Wg/ThreadPool.hpp"
+
+// The coroutines need C++20, with C++17 this header is empty
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+  #define VACA_HAS_COROUTINES
+#endif
+
+#ifdef VACA_HAS_COROUTINES
+
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace Wg {
+
+template<typename T = void>
+class Task;
+
+/**
+   This exception is thrown by the awaitables of a Task when its
+   CancellationToken was canceled (e.g. the Widget of the task was
+   destroyed), so the coroutine is unwound without reaching the code
+   after the @c co_await.
+
+   @see Task#setCancellationToken
+*/
+class VACA_DLL TaskCanceledException : public Exception {
+public:
+
+    TaskCanceledException() : Exception() {}
+
+    TaskCanceledException(const String &message) : Exception(message) {}
+
+    ~TaskCanceledException() noexcept override = default;
+
+};
+
+namespace details {
+
+/**
+   The part of the promise of a Task that does not depend of the type of
+   the result.
+
+   @internal
+*/
+class VACA_DLL TaskPromiseBase {
+    template<typename T> friend class Wg::Task;
+
+    std::coroutine_handle<> m_continuation; // who awaits this task
+    std::exception_ptr m_exception;
+    std::optional<CancellationToken> m_token;
+    bool m_detached = false;              // started with Task#start
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return handle.promise().finish(handle);
+        }
+        void await_resume() noexcept {}
+    };
+
+public:
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+
+    [[nodiscard]] bool isCanceled() const;
+
+    void throwIfCanceled() const;
+
+    void inheritToken(const TaskPromiseBase &parent);
+
+protected:
+
+    void rethrowException() const;
+
+private:
+
+    std::coroutine_handle<> finish(std::coroutine_handle<> handle) noexcept;
+
+};
+
+template<typename T>
+class TaskPromise : public TaskPromiseBase {
+    std::optional<T> m_value;
+
+public:
+
+    Task<T> get_return_object();
+
+    template<typename U>
+    void return_value(U &&value) { m_value.emplace(std::forward<U>(value)); }
+
+    T getResult() {
+        rethrowException();
+        return std::move(*m_value);
+    }
+
+};
+
+template<>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+
+    Task<void> get_return_object();
+
+    void return_void() {}
+
+    void getResult() { rethrowException(); }
+
+};
+
+// Returns the promise of a Task coroutine, or nullptr if the awaitable
+// is used from other kind of coroutine
+template<typename Promise>
+TaskPromiseBase *get_task_promise(std::coroutine_handle<Promise> handle)
+{
+    if constexpr (std::is_base_of_v<TaskPromiseBase, Promise>)
+        return &handle.promise();
+    else
+        return nullptr;
+}
+
+#ifdef VACA_ON_WINDOWS
+VACA_DLL CancellationToken get_lifetime_token(Widget *widget);
+#endif
+
+} // namespace details
+
+/**
+   A coroutine that returns a @a T (or nothing for @c Task<void>), so
+   the code that waits other threads, timers or the network can be
+   written without callbacks:
+
+   @code
+   Task<void> MainFrame::loadImage(String url)
+   {
+     HttpRequest request(url);
+     HttpResponse response = co_await sendAsync(request); // in the pool
+     co_await resumeOnPool();
+     Image image = decode(response.content);              // in the pool
+     co_await resumeOnThread(m_uiThread);
+     m_view.setImage(image);                              // in the UI thread
+   }
+   ...
+   loadImage(url).bindTo(this).start();
+   @endcode
+
+   The coroutine starts when it is awaited (@c co_await in other Task)
+   or when #start is called. The result (or the exception) is given to
+   the awaiting coroutine.
+
+   A task has an optional CancellationToken (see #setCancellationToken
+   and #bindTo). The tasks that it awaits use the same token (if they
+   do not have other one), so canceling it cancels the whole tree of
+   tasks: the next awaitable that is resumed throws a
+   TaskCanceledException instead of returning. The awaitables do not
+   abort the operation that they are waiting (a delay is completed, a
+   request is received), they only check the token when the coroutine
+   is resumed, so the check is done in the thread of the code after the
+   @c co_await (e.g. the UI thread, where the widget is destroyed).
+
+   @warning
+     It needs C++20 (@c VACA_HAS_COROUTINES is defined).
+
+   @see resumeOnPool, resumeOnThread, delay, sendAsync
+*/
+template<typename T>
+class Task {
+public:
+
+    typedef details::TaskPromise<T> promise_type;
+
+private:
+
+    typedef std::coroutine_handle<promise_type> Handle;
+
+    Handle m_handle;
+
+public:
+
+    class Awaiter {
+        Handle m_handle;
+
+    public:
+
+        explicit Awaiter(Handle handle) : m_handle(handle) {}
+
+        bool await_ready() const { return m_handle.done(); }
+
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> awaiting) {
+            details::TaskPromiseBase *parent = details::get_task_promise(awaiting);
+            if (parent)
+                m_handle.promise().inheritToken(*parent);
+
+            m_handle.promise().m_continuation = awaiting;
+            return m_handle;
+        }
+
+        T await_resume() { return m_handle.promise().getResult(); }
+
+    };
+
+    explicit Task(Handle handle) : m_handle(handle) {}
+
+    Task(Task &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+    Task(const Task &) = delete;
+
+    ~Task() {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    Task &operator=(Task &&other) noexcept {
+        if (this != &other) {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+
+    Task &operator=(const Task &) = delete;
+
+    [[nodiscard]] bool isDone() const { return !m_handle || m_handle.done(); }
+
+    /**
+       Sets the token to cancel this task and the tasks that it awaits.
+       It must be called before the task starts.
+    */
+    Task &setCancellationToken(const CancellationToken &token) {
+        assert(m_handle && !m_handle.done());
+        m_handle.promise().m_token = token;
+        return *this;
+    }
+
+#ifdef VACA_ON_WINDOWS
+    /**
+       Cancels the task when the @a widget is destroyed (it uses
+       Widget#getLifetimeToken). The code after each @c co_await in the
+       UI thread does not run if the widget was destroyed.
+    */
+    Task &bindTo(Widget *widget) {
+        return setCancellationToken(details::get_lifetime_token(widget));
+    }
+#endif
+
+    /**
+       Starts the coroutine in the current thread (until its first
+       suspension) and releases it: the coroutine is destroyed when it
+       finishes. If it finishes with a TaskCanceledException it is
+       ignored, other exceptions call @c std::terminate (like an
+       exception in a @c std::thread).
+    */
+    void start() {
+        assert(m_handle && !m_handle.done());
+        m_handle.promise().m_detached = true;
+        std::exchange(m_handle, nullptr).resume();
+    }
+
+    Awaiter operator co_await() const {
+        assert(m_handle);
+        return Awaiter(m_handle);
+    }
+
+};
+
+template<typename T>
+Task<T> details::TaskPromise<T>::get_return_object()
+{
+    return Task<T>(std::coroutine_handle<TaskPromise<T> >::from_promise(*this));
+}
+
+inline Task<void> details::TaskPromise<void>::get_return_object()
+{
+    return Task<void>(std::coroutine_handle<TaskPromise<void> >::from_promise(*this));
+}
+
+// ======================================================================
+// Awaitables
+
+/**
+   Resumes the coroutine in a thread of the @a pool.
+
+   @see resumeOnPool
+*/
+class VACA_DLL PoolAwaiter {
+    ThreadPool &m_pool;
+    TaskPriority m_priority;
+    details::TaskPromiseBase *m_promise = nullptr;
+
+public:
+
+    PoolAwaiter(ThreadPool &pool, TaskPriority priority)
+        : m_pool(pool), m_priority(priority) {}
+
+    bool await_ready() const { return false; }
+
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) {
+        // the coroutine can be resumed (and this awaiter destroyed)
+        // before post() returns
+        m_promise = details::get_task_promise(handle);
+        post(handle);
+    }
+
+    void await_resume() const;
+
+private:
+
+    void post(std::coroutine_handle<> handle);
+
+};
+
+/**
+   Waits @a msecs milliseconds using a Timer of the current thread (the
+   coroutine is resumed by the Tick of the timer, so the thread must
+   process its timers, see Timer#pollTimers). In a worker of a
+   ThreadPool, the coroutine is resumed by a task of the pool.
+
+   @see delay
+*/
+class VACA_DLL DelayAwaiter {
+    int m_msecs;
+    int m_slack;
+    Timer *m_timer = nullptr;
+    details::TaskPromiseBase *m_promise = nullptr;
+
+public:
+
+    DelayAwaiter(int msecs, int slack) : m_msecs(msecs), m_slack(slack) {}
+
+    DelayAwaiter(const DelayAwaiter &) = delete;
+
+    ~DelayAwaiter();
+
+    bool await_ready() const { return m_msecs <= 0; }
+
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> handle) {
+        m_promise = details::get_task_promise(handle);
+        startTimer(handle);
+    }
+
+    void await_resume() const;
+
+private:
+
+    void startTimer(std::coroutine_handle<> handle);
+
+};
+
+/**
+   Does not suspend the coroutine, it only throws a
+   TaskCanceledException if its task was canceled.
+
+   @see checkCanceled
+*/
+class VACA_DLL CancelCheckAwaiter {
+    details::TaskPromiseBase *m_promise = nullptr;
+
+public:
+
+    bool await_ready() const { return false; }
+
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) {
+        m_promise = details::get_task_promise(handle);
+        return false;
+    }
+
+    void await_resume() const;
+
+};
+
+/**
+   Continues the coroutine in a thread of the @a pool (e.g. to decode an
+   image without blocking the UI thread).
+
+   @code
+   co_await resumeOnPool();
+   @endcode
+*/
+inline PoolAwaiter resumeOnPool(ThreadPool &pool = ThreadPool::getDefault(),
+                                TaskPriority priority = TaskPriority::Normal)
+{
+    return PoolAwaiter(pool, priority);
+}
+
+/**
+   Continues the coroutine after @a msecs milliseconds in the same
+   thread (or in the same ThreadPool after #resumeOnPool). The @a slack
+   is the time that it can be delayed (see Timer#setSlack).
+*/
+inline DelayAwaiter delay(int msecs, int slack = 0)
+{
+    return DelayAwaiter(msecs, slack);
+}
+
+/**
+   Throws a TaskCanceledException if the task was canceled (e.g. to stop
+   a long loop in the pool).
+
+   @code
+   for (auto &file : files) {
+     co_await checkCanceled();
+     scan(file);
+   }
+   @endcode
+*/
+inline CancelCheckAwaiter checkCanceled()
+{
+    return CancelCheckAwaiter();
+}
+
+#ifdef VACA_ON_WINDOWS
+
+/**
+   Resumes the coroutine in the message loop of other thread.
+
+   @see resumeOnThread
+*/
+class VACA_DLL ThreadAwaiter {
+    ThreadId m_thread;
+    bool m_failed = false;
+    details::TaskPromiseBase *m_promise = nullptr;
+
+public:
+
+    explicit ThreadAwaiter(ThreadId thread) : m_thread(thread) {}
+
+    [[nodiscard]] bool await_ready() const;
+
+    template<typename Promise>
+    bool await_suspend(std::coroutine_handle<Promise> handle) {
+        m_promise = details::get_task_promise(handle);
+        return post(handle);
+    }
+
+    void await_resume() const;
+
+private:
+
+    bool post(std::coroutine_handle<> handle);
+
+};
+
+/**
+   Continues the coroutine in the message loop of the @a thread (e.g.
+   the UI thread to update the widgets). It uses
+   ThreadPool#postToThread, so the coroutine is resumed by
+   CurrentThread#processMessage. If the thread is the current one, the
+   coroutine is not suspended.
+
+   @throw TaskCanceledException
+     If the thread does not have a message queue.
+*/
+inline ThreadAwaiter resumeOnThread(ThreadId thread)
+{
+    return ThreadAwaiter(thread);
+}
+
+/**
+   Response of an HttpRequest received with sendAsync.
+*/
+struct HttpResponse {
+    int statusCode;
+    std::string content;
+};
+
+VACA_DLL Task<HttpResponse> sendAsync(HttpRequest &request,
+                                      String headers = L"",
+                                      std::string body = "");
+
+#endif
+
+} // namespace Wg
+
+#endif // VACA_HAS_COROUTINES
@@ -94,7 +94,7 @@ public:
     // ============================================================
 
     // Signals
-    Signal1<void, Event &> Change; ///< @see onChange
+    SignalN<void(Event &)> Change; ///< @see onChange
 
 protected:
     // Events
@@ -0,0 +1,165 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/Font.hpp"
+#include "Wg/Rect.hpp"
+#include "Wg/Size.hpp"
+
+#include <vector>
+
+namespace Wg {
+
+// ======================================================================
+
+/**
+   It's like a namespace for TextEllipsis.
+
+   @see TextEllipsis
+*/
+struct TextEllipsisEnum {
+    enum enumeration {
+        None,
+        Word,
+        End,
+        Path
+    };
+    static const enumeration default_value = None;
+};
+
+/**
+   How a line that does not fit in the available width is truncated.
+
+   One of the following values:
+   @li TextEllipsis::None (default): the line is clipped.
+   @li TextEllipsis::Word: the last fitting word is followed by "...".
+   @li TextEllipsis::End: the last fitting character is followed by "...".
+   @li TextEllipsis::Path: "..." replaces the middle of the line, so the
+       last component of the path is kept.
+
+   @see TextLayout#setEllipsis
+*/
+typedef Enum<TextEllipsisEnum> TextEllipsis;
+
+// ======================================================================
+
+/**
+   Line breaks, ellipsis truncation and character positions of a text.
+
+   The layout is calculated only once (when #getLines or #getSize are
+   called) and kept until the text, the font, the width, or the
+   wrapping options change. So a widget can hold a TextLayout to paint
+   and measure its text many times without asking the system to break
+   the lines again (like Graphics#drawString or Graphics#measureString
+   do each time with @msdn{DrawText}).
+
+   Like @msdn{DrawText}, a '&' character underlines the next one
+   (the mnemonic), and "&&" is shown as a single '&'.
+
+   @see Label#getTextLayout
+*/
+class VACA_DLL TextLayout {
+public:
+
+    /**
+       A line of the layout.
+    */
+    struct Line {
+        /**
+           Text to be drawn (with the ellipsis, and without '&').
+        */
+        String text;
+
+        /**
+           Horizontal position of each character, relative to the
+           start of the line. It has text.size()+1 elements, the last
+           one is the width of the line.
+        */
+        std::vector<int> positions;
+
+        /**
+           Index of the underlined character, or -1.
+        */
+        int mnemonic;
+
+        [[nodiscard]] int getWidth() const { return positions.back(); }
+    };
+
+private:
+
+    String m_text;
+    Font m_font;
+    int m_width;
+    bool m_wordWrap;
+    bool m_prefix;
+    TextEllipsis m_ellipsis;
+
+    // Cached layout
+    bool m_valid;
+    bool m_brokenLines;      // a line was wrapped or truncated to fit in m_width
+    std::vector<Line> m_lines;
+    Size m_size;
+    int m_lineHeight;
+    int m_ascent;
+    unsigned m_layoutCount;
+
+public:
+
+    TextLayout();
+
+    virtual ~TextLayout();
+
+    [[nodiscard]] const String &getText() const;
+
+    void setText(const String &str);
+
+    [[nodiscard]] Font getFont() const;
+
+    void setFont(const Font &font);
+
+    [[nodiscard]] int getWidth() const;
+
+    void setWidth(int width);
+
+    [[nodiscard]] bool getWordWrap() const;
+
+    void setWordWrap(bool state);
+
+    [[nodiscard]] bool getPrefix() const;
+
+    void setPrefix(bool state);
+
+    [[nodiscard]] TextEllipsis getEllipsis() const;
+
+    void setEllipsis(TextEllipsis ellipsis);
+
+    void invalidate();
+
+    const std::vector<Line> &getLines();
+
+    Size getSize();
+
+    int getLineHeight();
+
+    [[nodiscard]] unsigned getLayoutCount() const;
+
+    void draw(Graphics &g, const Color &color, const Rect &rc, TextAlign align);
+
+    void drawDisabled(Graphics &g, const Rect &rc, TextAlign align);
+
+private:
+
+    void layout();
+
+    void addParagraph(HDC hdc, const String &text, int mnemonic);
+
+    void addEllipsisLine(HDC hdc, const String &text, const std::vector<int> &positions, int mnemonic);
+
+};
+
+} // namespace Wg
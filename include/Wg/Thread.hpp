@@ -8,10 +8,15 @@
 
 #include "Wg/Base.hpp"
 #include "Wg/Exception.hpp"
-#include "Wg/Message.hpp"
 #include "Wg/NonCopyable.hpp"
 #include "Wg/Slot.hpp"
 
+#ifdef VACA_ON_WINDOWS
+#include "Wg/Message.hpp"
+#endif
+
+#include <vector>
+
 namespace Wg {
 
 // ======================================================================
@@ -73,6 +78,10 @@ public:
    the member function that gets messages from the OS and distributes
    them to widgets.
 
+   The threads themselves (creation, priority, join) do not depend on
+   Win32: in other platforms they are POSIX threads, and the messages
+   are not available.
+
    @see doMessageLoop
 */
 class VACA_DLL Thread : public NonCopyable {
@@ -80,8 +89,9 @@ class VACA_DLL Thread : public NonCopyable {
 
 private:
 
-    HANDLE m_handle;
-    ThreadId m_id;
+    class ThreadImpl;
+
+    ThreadImpl *m_impl;
 
 public:
 
@@ -93,7 +103,8 @@ public:
        Creates a new thread running the specified function or functor @a f.
 
        @throw CreateThreadException
-         If the thread couldn't be created by Win32's @c CreateThread.
+         If the thread couldn't be created (by Win32's @c CreateThread
+         or @c pthread_create).
     */
     template<typename F>
     explicit Thread(F f) {
@@ -108,11 +119,13 @@ public:
 
     void setThreadPriority(ThreadPriority priority);
 
+#ifdef VACA_ON_WINDOWS
     // ===============================================================
     // MESSAGES
     // ===============================================================
 
-    void enqueueMessage(const Message &message) const;
+    bool enqueueMessage(const Message &message) const;
+#endif
 
 private:
     void Thread_(const Slot0<void> &slot);
@@ -122,7 +135,12 @@ private:
 namespace CurrentThread {
 VACA_DLL ThreadId getId();
 
-VACA_DLL void enqueueMessage(const Message &message);
+VACA_DLL void yield();
+
+VACA_DLL void sleep(int msecs);
+
+#ifdef VACA_ON_WINDOWS
+VACA_DLL bool enqueueMessage(const Message &message);
 
 VACA_DLL void doMessageLoop();
 
@@ -132,16 +150,16 @@ VACA_DLL void pumpMessageQueue();
 
 VACA_DLL void breakMessageLoop();
 
-VACA_DLL void yield();
-
-VACA_DLL void sleep(int msecs);
-
 VACA_DLL bool getMessage(Message &msg);
 
 VACA_DLL bool peekMessage(Message &msg);
 
 VACA_DLL void processMessage(Message &msg);
 
+VACA_DLL bool isInputCoalescing();
+
+VACA_DLL void setInputCoalescing(bool state);
+
 namespace details {
 VACA_DLL bool preTranslateMessage(Message &message);
 
@@ -152,12 +170,17 @@ VACA_DLL void setOutsideWidget(Widget *widget);
 VACA_DLL void addFrame(Frame *frame);
 
 VACA_DLL void removeFrame(Frame *frame);
+
+VACA_DLL const std::vector<Point> *getMouseHistory(HWND hwnd, LPARAM lParam);
 }
+#endif
 
 }
 
+#ifdef VACA_ON_WINDOWS
 namespace details {
 VACA_DLL void removeAllThreadData();
 }
+#endif
 
 } // namespace Wg
@@ -0,0 +1,163 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/ConditionVariable.hpp"
+#include "Wg/Mutex.hpp"
+#include "Wg/NonCopyable.hpp"
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Wg {
+
+/**
+   It's like a namespace for TaskPriority.
+
+   @see TaskPriority
+*/
+struct TaskPriorityEnum {
+    enum enumeration {
+        Low,
+        Normal,
+        High,
+    };
+    static const enumeration default_value = Normal;
+};
+
+/**
+   Priority of a task in a ThreadPool: a task is not started while there
+   are tasks with a higher priority waiting.
+
+   One of the following values:
+   @li TaskPriority::Low (e.g. prefetching)
+   @li TaskPriority::Normal
+   @li TaskPriority::High (e.g. what the user is waiting to see)
+*/
+typedef Enum<TaskPriorityEnum> TaskPriority;
+
+/**
+   A flag to cancel tasks. The copies of a token share the same flag, so
+   the task can keep a copy to check if it was canceled while it runs.
+
+   @see ThreadPool#post
+*/
+class VACA_DLL CancellationToken {
+    friend class ThreadPool;
+
+    std::shared_ptr<std::atomic<bool> > m_canceled;
+
+public:
+
+    CancellationToken();
+
+    void cancel();
+
+    [[nodiscard]] bool isCanceled() const;
+
+};
+
+/**
+   A set of threads that run tasks, so the background jobs (decoding
+   images, scanning files, etc.) do not create their own threads.
+
+   Each worker has its own queues (one for each TaskPriority). The tasks
+   posted from a worker are added to its queues and it takes the newest
+   one first (the data of the task is still in its cache); when a worker
+   does not have tasks, it takes the oldest tasks of the pool queues or
+   steals them from other workers.
+
+   A task is a function without arguments. The results are given to the
+   UI thread with #postToThread:
+
+   @code
+   ThreadId uiThread = CurrentThread::getId();
+   CancellationToken token;
+   ThreadPool::getDefault().post([=] {
+     Image image = decode(fileName);
+     ThreadPool::postToThread(uiThread, [=] {
+       view->setImage(image);
+     }, token);
+   }, token);
+   ...
+   token.cancel();       // the view is closed
+   @endcode
+
+   @warning
+     The tasks must not throw exceptions.
+*/
+class VACA_DLL ThreadPool : private NonCopyable {
+public:
+
+    typedef std::function<void()> Task;
+
+private:
+
+    enum { Priorities = 3 };
+
+    struct Item {
+        Task task;
+        std::shared_ptr<std::atomic<bool> > canceled; // nullptr if it cannot be canceled
+    };
+
+    typedef std::deque<Item> Queue;
+
+    struct Worker;
+
+    std::vector<Worker *> m_workers;
+    Mutex m_queueMutex;             // for m_queues
+    Queue m_queues[Priorities];     // tasks posted from other threads
+    Mutex m_mutex;                  // to sleep and wait the workers
+    ConditionVariable m_wakeUp;
+    ConditionVariable m_idle;
+    std::atomic<int> m_pending;     // tasks in the queues
+    std::atomic<int> m_outstanding; // tasks posted that did not finish
+    bool m_stop;
+
+public:
+
+    explicit ThreadPool(int workers = 0);
+
+    ~ThreadPool();
+
+    [[nodiscard]] int getWorkerCount() const;
+
+    [[nodiscard]] int getPendingCount() const;
+
+    void post(const Task &task, TaskPriority priority = TaskPriority::Normal);
+
+    void post(const Task &task, const CancellationToken &token,
+              TaskPriority priority = TaskPriority::Normal);
+
+    void wait();
+
+    static ThreadPool &getDefault();
+
+    static ThreadPool *getCurrent();
+
+#ifdef VACA_ON_WINDOWS
+    static bool postToThread(ThreadId thread, const Task &task);
+
+    static bool postToThread(ThreadId thread, const Task &task,
+                             const CancellationToken &token);
+#endif
+
+private:
+
+    void push(Item &&item, TaskPriority priority);
+
+    bool take(int index, Item &item);
+
+    void run(int index);
+
+};
+
+} // namespace Wg
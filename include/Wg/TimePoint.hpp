@@ -7,15 +7,17 @@
 #pragma once
 
 #include "Wg/Base.hpp"
+#include "Wg/Clock.hpp"
 
 namespace Wg {
 
 /**
    Class to measure elapsed time, like a chronometer.
+
+   The time is asked to the current Clock (see Clock#getCurrent).
 */
 class VACA_DLL TimePoint {
-    LARGE_INTEGER m_point{};
-    LARGE_INTEGER m_freq{};
+    Clock::Nanoseconds m_point;
 
 public:
     TimePoint();
@@ -7,37 +7,57 @@
 #pragma once
 
 #include "Wg/Base.hpp"
-#include "Wg/Signal.hpp"
+#include "Wg/SignalN.hpp"
 #include "Wg/NonCopyable.hpp"
 #include "Wg/Thread.hpp"
+#include "Wg/TimerWheel.hpp"
 
 namespace Wg {
 
 /**
    Class to schedule events every @e x milliseconds.
 
+   A timer can have a @e slack (see #setSlack): a time that its ticks
+   can be delayed, so the timers with near deadlines expire together
+   and their threads are woken up once. It is useful for timers that do
+   not need precision (e.g. to refresh a view every second).
+
+   The time of the timers is the time of the current Clock (see
+   Clock#setCurrent), so a test can use a VirtualClock.
+
    @warning
      The Tick event is generated in the same thread which was
-     created the Timer.
+     created the Timer. The workers of a ThreadPool do not process
+     timers, so the ticks of a Timer created in a worker are generated
+     by a task of the pool (one task at a time for all the timers of
+     the pool).
 
    @win32
      It doesn't use @msdn{WM_TIMER} message. In Vaca all timers
      are controlled in a separated thread for this specific purpose.
+     That thread keeps the deadlines in a TimerWheel and sleeps until
+     the next one, so starting or stopping a timer is O(1) and the
+     thread does not use the CPU while no timer expires. Each thread
+     receives only one @msdn{WM_NULL} message for all its expired timers,
+     and it does not receive another one until it processes it.
    @endwin32
 */
 class VACA_DLL Timer : private NonCopyable {
     friend class Application;
 
     ThreadId m_threadOwnerId;
-    bool m_running: 1;
-    bool m_firstTick: 1;
+    ThreadPool *m_pool;          // the pool of the owner (if it is a worker)
+    bool m_running;
+    bool m_pending;              // it has ticks to be fired by its thread
     int m_interval;
-    int m_timeCounter;
+    int m_slack;
     int m_tickCounter;
+    TimerWheel::Nanoseconds m_deadline; // time of the next tick
+    TimerWheel::Entry m_entry;
 
 public:
 
-    Timer(int interval);
+    Timer(int interval, int slack = 0);
 
     virtual ~Timer();
 
@@ -45,6 +65,10 @@ public:
 
     void setInterval(int interval);
 
+    [[nodiscard]] int getSlack() const;
+
+    void setSlack(int slack);
+
     [[nodiscard]] bool isRunning() const;
 
     void start();
@@ -54,7 +78,7 @@ public:
     static void pollTimers();
 
     // Signals
-    Signal0<void> Tick;   ///< @see onTick
+    SignalN<void()> Tick;   ///< @see onTick
 
 protected:
 
@@ -71,8 +95,12 @@ private:
 
     static void remove_timer(Timer *t);
 
+    static void expire_timers(TimerWheel::Nanoseconds now);
+
     static void fire_timers_for_thread();
 
+    static void fire_timers(ThreadId thread, ThreadPool *pool);
+
 };
 
 } // namespace Wg
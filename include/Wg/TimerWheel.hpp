@@ -0,0 +1,118 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Base.hpp"
+#include "Wg/NonCopyable.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Wg {
+
+/**
+   Hierarchical timing wheel: a set of deadlines where adding and
+   removing a deadline is O(1), and advancing the time costs only the
+   deadlines that expire (plus a few cascades), not the number of
+   deadlines in the set.
+
+   The time (in nanoseconds) is divided in ticks of #getResolution
+   nanoseconds. The wheel has 8 levels of 256 slots: the level 0 has
+   one slot per tick, the level 1 one slot per 256 ticks, etc. A
+   deadline is put in the level of the highest digit (base 256) where
+   its tick differs from the current tick, and it is moved to a lower
+   level (a cascade) when the time reaches its slot. Empty slots are
+   skipped with a bitmap, so #advance does not iterate tick by tick.
+
+   A deadline never expires before its time: it expires in the first
+   tick after it. A deadline can be delayed (see the @a slack of
+   #schedule) to expire together with other deadlines in the same
+   tick.
+
+   It is not thread-safe and it does not depend on the operating
+   system, it is used by Timer (with its own thread and mutex).
+
+   @code
+   TimerWheel wheel(1000000, now);  // ticks of 1 ms
+   TimerWheel::Entry entry;
+   wheel.schedule(&entry, now + 50000000);
+   ...
+   std::vector<TimerWheel::Entry*> expired;
+   wheel.advance(now, expired);
+   @endcode
+*/
+class VACA_DLL TimerWheel : private NonCopyable {
+public:
+
+    typedef std::uint64_t Nanoseconds;
+
+    /**
+       A deadline in the wheel. It must live while it is scheduled.
+    */
+    struct Entry {
+        Entry *next{};
+        Entry **pprev{};          // nullptr if it is not scheduled
+        std::uint64_t tick{};     // deadline in ticks
+        void *data{};             // for the user of the wheel
+
+        [[nodiscard]] bool isScheduled() const { return pprev != nullptr; }
+    };
+
+    enum {
+        Levels = 8,
+        SlotBits = 8,
+        Slots = 1 << SlotBits
+    };
+
+private:
+
+    Nanoseconds m_resolution;
+    std::uint64_t m_now;         // current tick
+    std::size_t m_size;
+    Entry *m_slots[Levels][Slots];
+    std::uint64_t m_bitmap[Levels][Slots / 64]; // non-empty slots
+
+public:
+
+    explicit TimerWheel(Nanoseconds resolution = 1000000, Nanoseconds now = 0);
+
+    ~TimerWheel();
+
+    [[nodiscard]] Nanoseconds getResolution() const { return m_resolution; }
+
+    [[nodiscard]] Nanoseconds getTime() const;
+
+    [[nodiscard]] std::size_t size() const { return m_size; }
+
+    [[nodiscard]] bool empty() const { return m_size == 0; }
+
+    void reset(Nanoseconds now);
+
+    void schedule(Entry *entry, Nanoseconds deadline);
+
+    void schedule(Entry *entry, Nanoseconds deadline, Nanoseconds slack);
+
+    void cancel(Entry *entry);
+
+    void advance(Nanoseconds now, std::vector<Entry *> &expired);
+
+    [[nodiscard]] Nanoseconds getNextWakeup() const;
+
+private:
+
+    void insert(Entry *entry);
+
+    void unlink(Entry *entry);
+
+    [[nodiscard]] std::uint64_t getNextEvent() const;
+
+    [[nodiscard]] int findSlot(int level, int from) const;
+
+};
+
+} // namespace Wg
@@ -133,6 +133,8 @@ public:
 
     void updatePreferredSizes();
 
+    [[nodiscard]] static const MessageMap &getBaseMessageMap();
+
 protected:
     // Events
     void onPreferredSize(PreferredSizeEvent &ev) override;
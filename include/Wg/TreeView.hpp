@@ -153,16 +153,16 @@ public:
     void setBgColor(const Color &color) override;
 
     // Signals
-    Signal1<void, TreeViewEvent &> BeforeExpand;
-    Signal1<void, TreeViewEvent &> BeforeCollapse;
-    Signal1<void, TreeViewEvent &> BeforeSelect;
-    Signal1<void, TreeViewEvent &> BeforeLabelEdit;
-    Signal1<void, TreeViewEvent &> AfterExpand;
-    Signal1<void, TreeViewEvent &> AfterCollapse;
-    Signal1<void, TreeViewEvent &> AfterSelect;
-    Signal1<void, TreeViewEvent &> AfterLabelEdit;
-//   Signal1<void, TreeViewEvent&> BeginDrag;
-//   Signal1<void, TreeViewEvent&> EndDrag;
+    SignalN<void(TreeViewEvent &)> BeforeExpand;
+    SignalN<void(TreeViewEvent &)> BeforeCollapse;
+    SignalN<void(TreeViewEvent &)> BeforeSelect;
+    SignalN<void(TreeViewEvent &)> BeforeLabelEdit;
+    SignalN<void(TreeViewEvent &)> AfterExpand;
+    SignalN<void(TreeViewEvent &)> AfterCollapse;
+    SignalN<void(TreeViewEvent &)> AfterSelect;
+    SignalN<void(TreeViewEvent &)> AfterLabelEdit;
+//   SignalN<void(TreeViewEvent &)> BeginDrag;
+//   SignalN<void(TreeViewEvent &)> EndDrag;
 
 protected:
     // Events
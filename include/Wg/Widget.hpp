@@ -14,7 +14,7 @@
 #include "Wg/Graphics.hpp"
 #include "Wg/Rect.hpp"
 #include "Wg/Register.hpp"
-#include "Wg/Signal.hpp"
+#include "Wg/SignalN.hpp"
 #include "Wg/Size.hpp"
 #include "Wg/Style.hpp"
 #include "Wg/WidgetClass.hpp"
@@ -58,6 +58,7 @@ public:
 */
 class VACA_DLL Widget : public Register<WidgetClass>, public Component {
     friend class MakeWidgetRef;
+    friend class MessageMap;
 
     friend VACA_DLL void delete_widget(Widget *widget);
 
@@ -140,6 +141,26 @@ private:
     */
     bool m_doubleBuffered: 1;
 
+    /**
+       Indicates that the widget paints all its pixels, so the siblings
+       that are below it do not need to be painted.
+
+       @see #setOpaque, #isOccluded
+    */
+    bool m_opaque: 1;
+
+    /**
+       A WM_SIZE was received and #onResize will be called when the
+       deferred message is received (see CurrentThread#setInputCoalescing).
+    */
+    bool m_resizePending: 1;
+
+    /**
+       Number of children that are opaque, used to know quickly if
+       #isOccluded has to walk the z-order.
+    */
+    int m_opaqueChildren;
+
     /**
        Current font of the Widget (used mainly to draw the text of the widget).
 
@@ -190,6 +211,20 @@ private:
     */
     void (*m_destroyHandleProc)(HWND hwnd){};
 
+    /**
+       Table used by #globalWndProc to dispatch the messages (nullptr
+       to call #wndProc with every message).
+
+       @see #setMessageMap
+    */
+    const MessageMap *m_messageMap{};
+
+    /**
+       Token canceled when the widget is destroyed (it is created by
+       #getLifetimeToken the first time that it is used).
+    */
+    CancellationToken *m_lifetimeToken{};
+
 public:
 
     // ============================================================
@@ -204,6 +239,8 @@ public:
 
     ~Widget() override;
 
+    CancellationToken getLifetimeToken();
+
     // ============================================================
     // PARENT & CHILDREN RELATIONSHIP
     // ============================================================
@@ -330,6 +367,14 @@ public:
 
     void setDoubleBuffered(bool doubleBuffered);
 
+    [[nodiscard]] bool isOpaque() const;
+
+    void setOpaque(bool opaque);
+
+    [[nodiscard]] bool isOccluded() const;
+
+    [[nodiscard]] bool isOccluded(const Rect &rc) const;
+
     void validate();
 
     void validate(const Rect &rc);
@@ -432,19 +477,19 @@ public:
     // SIGNALS (signals are public, see TN004)
     // ===============================================================
 
-    Signal1<void, ResizeEvent &> Resize; ///< @see onResize
-    Signal1<void, MouseEvent &> MouseEnter; ///< @see onMouseEnter
-    Signal1<void, MouseEvent &> MouseLeave; ///< @see onMouseLeave
-    Signal1<void, MouseEvent &> MouseDown; ///< @see onMouseDown
-    Signal1<void, MouseEvent &> MouseUp; ///< @see onMouseUp
-    Signal1<void, MouseEvent &> MouseMove; ///< @see onMouseMove
-    Signal1<void, MouseEvent &> MouseWheel; ///< @see onMouseWheel
-    Signal1<void, MouseEvent &> DoubleClick; ///< @see onDoubleClick
-    Signal1<void, KeyEvent &> KeyUp; ///< @see onKeyUp
-    Signal1<void, KeyEvent &> KeyDown; ///< @see onKeyDown
-    Signal1<void, FocusEvent &> FocusEnter; ///< @see onFocusEnter
-    Signal1<void, FocusEvent &> FocusLeave; ///< @see onFocusLeave
-    Signal1<void, DropFilesEvent &> DropFiles; ///< @see onDropFiles
+    SignalN<void(ResizeEvent &)> Resize; ///< @see onResize
+    SignalN<void(MouseEvent &)> MouseEnter; ///< @see onMouseEnter
+    SignalN<void(MouseEvent &)> MouseLeave; ///< @see onMouseLeave
+    SignalN<void(MouseEvent &)> MouseDown; ///< @see onMouseDown
+    SignalN<void(MouseEvent &)> MouseUp; ///< @see onMouseUp
+    SignalN<void(MouseEvent &)> MouseMove; ///< @see onMouseMove
+    SignalN<void(MouseEvent &)> MouseWheel; ///< @see onMouseWheel
+    SignalN<void(MouseEvent &)> DoubleClick; ///< @see onDoubleClick
+    SignalN<void(KeyEvent &)> KeyUp; ///< @see onKeyUp
+    SignalN<void(KeyEvent &)> KeyDown; ///< @see onKeyDown
+    SignalN<void(FocusEvent &)> FocusEnter; ///< @see onFocusEnter
+    SignalN<void(FocusEvent &)> FocusLeave; ///< @see onFocusLeave
+    SignalN<void(DropFilesEvent &)> DropFiles; ///< @see onDropFiles
 
 protected:
 
@@ -520,6 +565,14 @@ protected:
 
     void setDestroyHandleProc(void (*proc)(HWND));
 
+    void setMessageMap(const MessageMap &map);
+
+public:
+
+    [[nodiscard]] const MessageMap *getMessageMap() const;
+
+    [[nodiscard]] static const MessageMap &getBaseMessageMap();
+
 private:
 
     void initialize();
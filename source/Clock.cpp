@@ -0,0 +1,106 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/Clock.hpp"
+#include "Wg/Debug.hpp"
+
+using namespace Wg;
+
+// The clock set with Clock::setCurrent (nullptr means the SteadyClock)
+static std::atomic<Clock*> current_clock(nullptr);
+
+Clock::Clock()
+= default;
+
+/**
+   If it is the current clock, the SteadyClock is used again.
+*/
+Clock::~Clock()
+{
+  Clock* clock = this;
+  current_clock.compare_exchange_strong(clock, nullptr);
+}
+
+/**
+   Returns the clock used by TimePoint, Timer and HangWatchdog.
+
+   @see #setCurrent
+*/
+Clock& Clock::getCurrent()
+{
+  Clock* clock = current_clock.load(std::memory_order_acquire);
+  if (clock != nullptr)
+    return *clock;
+  else
+    return SteadyClock::getInstance();
+}
+
+/**
+   Replaces the current clock. Use nullptr to use the SteadyClock
+   again.
+
+   @warning
+     The clock should be replaced when there are not running timers
+     (the time of two clocks cannot be compared).
+*/
+void Clock::setCurrent(Clock* clock)
+{
+  current_clock.store(clock, std::memory_order_release);
+}
+
+// ======================================================================
+
+Clock::Nanoseconds SteadyClock::now() const
+{
+  return std::chrono::duration_cast<Nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch());
+}
+
+bool SteadyClock::isRealTime() const
+{
+  return true;
+}
+
+SteadyClock& SteadyClock::getInstance()
+{
+  static SteadyClock instance;
+  return instance;
+}
+
+// ======================================================================
+
+VirtualClock::VirtualClock(Nanoseconds now)
+  : m_now(now.count())
+{
+}
+
+Clock::Nanoseconds VirtualClock::now() const
+{
+  return Nanoseconds(m_now.load());
+}
+
+bool VirtualClock::isRealTime() const
+{
+  return false;
+}
+
+/**
+   Changes the time of the clock (it cannot go backward).
+*/
+void VirtualClock::setTime(Nanoseconds now)
+{
+  assert(now.count() >= m_now.load());
+  m_now.store(now.count());
+}
+
+/**
+   Advances the time of the clock.
+*/
+void VirtualClock::advance(Nanoseconds time)
+{
+  assert(time.count() >= 0);
+  m_now.fetch_add(time.count());
+}
@@ -1,253 +1,74 @@
-// -------------------- Original code from Boost --------------------
-// Copyright (C) 2001-2003
-// William E. Kempf
-//
-//  Distributed under the Boost Software License, Version 1.0. (See accompanying
-//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
-//
-// Boost Software License - Version 1.0 - August 17th, 2003
-//
-// Permission is hereby granted, free of charge, to any person or organization
-// obtaining a copy of the software and accompanying documentation covered by
-// this license (the "Software") to use, reproduce, display, distribute,
-// execute, and transmit the Software, and to prepare derivative works of the
-// Software, and to permit third-parties to whom the Software is furnished to
-// do so, all subject to the following:
-//
-// The copyright notices in the Software and this entire statement, including
-// the above license grant, this restriction and the following disclaimer,
-// must be included in all copies of the Software, in whole or in part, and
-// all derivative works of the Software, unless such copies or derivative
-// works are solely in the form of machine-executable object code generated by
-// a source language processor.
-//
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
-// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
-// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
-// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
-// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
-// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
-// DEALINGS IN THE SOFTWARE.
-// ------------------------------------------------------------------
-//
 // Vaca - Visual Application Components Abstraction
-// Adapted by David Capello
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
 
 #include "Wg/ConditionVariable.hpp"
-#include "Wg/ScopedLock.hpp"
 
-#include <limits>
+#if defined(VACA_ON_WINDOWS)
+  #include "Win32/ConditionVariableImpl.hpp"
+#elif defined(VACA_ON_UNIXLIKE)
+  #include "Unix/ConditionVariableImpl.hpp"
+#else
+  #error Your platform does not support condition variables
+#endif
 
 using namespace Wg;
 
-class ScopedUnlock : private NonCopyable
-{
-  ScopedLock& m_lock;
-public:
-  ScopedUnlock(ScopedLock& lock) : m_lock(lock) {
-    m_lock.getMutex().unlock();
-  }
-  ~ScopedUnlock() {
-    m_lock.getMutex().lock();
-  }
-};
-
 /**
    Creates a new ConditionVariable.
 
    @throw CreateConditionVariableException
      If the creation of the ConditionVariable fails.
+
+   @win32
+     It is emulated with semaphores (like Boost.Thread), so it works
+     in Windows 2000 and XP.
+   @endwin32
 */
 ConditionVariable::ConditionVariable()
-  : m_gone(0)
-  , m_blocked(0)
-  , m_waiting(0)
 {
-  m_gate = CreateSemaphore(nullptr, 1, 1, nullptr);
-  m_queue = CreateSemaphore(nullptr, 0, (std::numeric_limits<long>::max)(), nullptr);
-  m_mutex = CreateMutex(nullptr, 0, nullptr);
-
-  if (!m_gate || !m_queue || !m_mutex) {
-    if (m_gate) CloseHandle(m_gate);
-    if (m_queue) CloseHandle(m_queue);
-    if (m_mutex) CloseHandle(m_mutex);
-    throw CreateConditionVariableException();
-  }
+  m_impl = new ConditionVariableImpl();
 }
 
 ConditionVariable::~ConditionVariable()
 {
-  CloseHandle(m_gate);
-  CloseHandle(m_queue);
-  CloseHandle(m_mutex);
+  delete m_impl;
 }
 
+/**
+   Wakes up one thread that is waiting the condition.
+*/
 void ConditionVariable::notifyOne()
 {
-  unsigned signals = 0;
-
-  WaitForSingleObject(m_mutex, INFINITE);
-  if (m_waiting != 0) { // the m_gate is already closed
-    if (m_blocked == 0) {
-      ReleaseMutex(m_mutex);
-      return;
-    }
-
-    ++m_waiting;
-    --m_blocked;
-    signals = 1;
-  }
-  else {
-    WaitForSingleObject(m_gate, INFINITE);
-    if (m_blocked > m_gone) {
-      if (m_gone != 0) {
-	m_blocked -= m_gone;
-	m_gone = 0;
-      }
-      signals = m_waiting = 1;
-      --m_blocked;
-    }
-    else
-      ReleaseSemaphore(m_gate, 1, nullptr);
-  }
-
-  ReleaseMutex(m_mutex);
-  if (signals)
-    ReleaseSemaphore(m_queue, static_cast<LONG>(signals), nullptr);
+  m_impl->notifyOne();
 }
 
+/**
+   Wakes up all the threads that are waiting the condition.
+*/
 void ConditionVariable::notifyAll()
 {
-  unsigned signals = 0;
-
-  WaitForSingleObject(m_mutex, INFINITE);
-  if (m_waiting != 0) { // the m_gate is already closed
-    if (m_blocked == 0) {
-      ReleaseMutex(m_mutex);
-      return;
-    }
-
-    m_waiting += (signals = m_blocked);
-    m_blocked = 0;
-  }
-  else {
-    WaitForSingleObject(m_gate, INFINITE);
-    if (m_blocked > m_gone) {
-      if (m_gone != 0) {
-	m_blocked -= m_gone;
-	m_gone = 0;
-      }
-      signals = m_waiting = m_blocked;
-      m_blocked = 0;
-    }
-    else
-      ReleaseSemaphore(m_gate, 1, nullptr);
-  }
-
-  ReleaseMutex(m_mutex);
-  if (signals)
-    ReleaseSemaphore(m_queue, static_cast<LONG>(signals), nullptr);
+  m_impl->notifyAll();
 }
 
+/**
+   Unlocks the mutex of @a lock and waits the condition. The mutex is
+   locked again before returning.
+*/
 void ConditionVariable::wait(ScopedLock& lock)
 {
-  enterWait();
-  ScopedUnlock unlock(lock);
-
-  WaitForSingleObject(m_queue, INFINITE);
-
-  unsigned was_waiting = 0;
-  unsigned was_gone = 0;
-
-  WaitForSingleObject(m_mutex, INFINITE);
-  was_waiting = m_waiting;
-  was_gone = m_gone;
-  if (was_waiting != 0) {
-    if (--m_waiting == 0) {
-      if (m_blocked != 0) {
-	ReleaseSemaphore(m_gate, 1, nullptr); // open m_gate
-	was_waiting = 0;
-      }
-      else if (m_gone != 0)
-	m_gone = 0;
-    }
-  }
-  else if (++m_gone == ((std::numeric_limits<unsigned>::max)() / 2)) {
-    // timeout occured, normalize the m_gone count
-    // this may occur if many calls to wait with a timeout are made and
-    // no call to notify_* is made
-    WaitForSingleObject(m_gate, INFINITE);
-    m_blocked -= m_gone;
-    ReleaseSemaphore(m_gate, 1, nullptr);
-    m_gone = 0;
-  }
-  ReleaseMutex(m_mutex);
-
-  if (was_waiting == 1) {
-    for (; was_gone; --was_gone) {
-      // better now than spurious later
-      WaitForSingleObject(m_queue, INFINITE);
-    }
-    ReleaseSemaphore(m_gate, 1, nullptr);
-  }
+  m_impl->wait(lock);
 }
 
-bool ConditionVariable::waitFor(ScopedLock& lock, double seconds)
-{
-  enterWait();
-  ScopedUnlock unlock(lock);
-
-  int milliseconds = static_cast<int>(seconds*1000.0);
-
-  bool ret = (WaitForSingleObject(m_queue, static_cast<DWORD>(milliseconds)) == WAIT_OBJECT_0);
-
-  unsigned was_waiting = 0;
-  unsigned was_gone = 0;
-
-  WaitForSingleObject(m_mutex, INFINITE);
-  was_waiting = m_waiting;
-  was_gone = m_gone;
-  if (was_waiting != 0) {
-    if (!ret) { // timeout
-      if (m_blocked != 0)
-	--m_blocked;
-      else
-	++m_gone; // count spurious wakeups
-    }
-    if (--m_waiting == 0) {
-      if (m_blocked != 0) {
-	ReleaseSemaphore(m_gate, 1, nullptr); // open m_gate
-	was_waiting = 0;
-      }
-      else if (m_gone != 0)
-	m_gone = 0;
-    }
-  }
-  else if (++m_gone == ((std::numeric_limits<unsigned>::max)() / 2)) {
-    // timeout occured, normalize the m_gone count
-    // this may occur if many calls to wait with a timeout are made and
-    // no call to notify_* is made
-    WaitForSingleObject(m_gate, INFINITE);
-    m_blocked -= m_gone;
-    ReleaseSemaphore(m_gate, 1, nullptr);
-    m_gone = 0;
-  }
-  ReleaseMutex(m_mutex);
-
-  if (was_waiting == 1) {
-    for (; was_gone; --was_gone) {
-      // better now than spurious later
-      WaitForSingleObject(m_queue, INFINITE);
-    }
-    ReleaseSemaphore(m_gate, 1, nullptr);
-  }
-
-  return ret;
-}
+/**
+   Like #wait, but it waits @a seconds at most.
 
-void ConditionVariable::enterWait()
+   @return
+     False if the time was exceeded.
+*/
+bool ConditionVariable::waitFor(ScopedLock& lock, double seconds)
 {
-  WaitForSingleObject(m_gate, INFINITE);
-  ++m_blocked;
-  ReleaseSemaphore(m_gate, 1, nullptr);
+  return m_impl->waitFor(lock, seconds);
 }
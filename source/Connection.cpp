@@ -0,0 +1,160 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/Connection.hpp"
+#include "Wg/Referenceable.hpp"
+
+using namespace Wg;
+
+/**
+   Creates an empty connection (it is not connected to any signal).
+*/
+Connection::Connection()
+  : m_link(nullptr)
+  , m_index(0)
+  , m_generation(0)
+{
+}
+
+/**
+   @internal
+*/
+Connection::Connection(Link* link, unsigned index, unsigned generation)
+  : m_link(link)
+  , m_index(index)
+  , m_generation(generation)
+{
+  if (m_link != nullptr)
+    m_link->ref();
+}
+
+Connection::Connection(const Connection& conn)
+  : m_link(conn.m_link)
+  , m_index(conn.m_index)
+  , m_generation(conn.m_generation)
+{
+  if (m_link != nullptr)
+    m_link->ref();
+}
+
+/**
+   Destroys the handle. It does not disconnect the slot (see
+   ScopedConnection).
+*/
+Connection::~Connection()
+{
+  if (m_link != nullptr)
+    m_link->unref();
+}
+
+Connection& Connection::operator=(const Connection& conn)
+{
+  if (conn.m_link != nullptr)
+    conn.m_link->ref();
+  if (m_link != nullptr)
+    m_link->unref();
+
+  m_link = conn.m_link;
+  m_index = conn.m_index;
+  m_generation = conn.m_generation;
+  return *this;
+}
+
+/**
+   Returns true if the signal is alive and the slot was not
+   disconnected.
+*/
+bool Connection::isConnected() const
+{
+  return
+    m_link != nullptr &&
+    m_link->signal != nullptr &&
+    m_link->isConnected(m_link->signal, m_index, m_generation);
+}
+
+/**
+   Disconnects the slot from the signal. It does nothing if the slot
+   was already disconnected or the signal was destroyed.
+*/
+void Connection::disconnect()
+{
+  if (m_link != nullptr) {
+    if (m_link->signal != nullptr)
+      m_link->disconnect(m_link->signal, m_index, m_generation);
+
+    m_link->unref();
+    m_link = nullptr;
+  }
+}
+
+/**
+   Disconnects the slot automatically when @a object is destroyed
+   (usually the object which member function is called by the slot).
+
+   @code
+   model->Change.connect(&View::onModelChange, view).track(view);
+   @endcode
+*/
+Connection& Connection::track(Referenceable* object)
+{
+  if (isConnected())
+    object->trackConnection(*this);
+  return *this;
+}
+
+// ======================================================================
+
+ScopedConnection::ScopedConnection()
+= default;
+
+ScopedConnection::ScopedConnection(const Connection& conn)
+  : m_connection(conn)
+{
+}
+
+/**
+   Disconnects the slot.
+*/
+ScopedConnection::~ScopedConnection()
+{
+  m_connection.disconnect();
+}
+
+/**
+   Disconnects the current slot and takes the new one.
+*/
+ScopedConnection& ScopedConnection::operator=(const Connection& conn)
+{
+  m_connection.disconnect();
+  m_connection = conn;
+  return *this;
+}
+
+const Connection& ScopedConnection::getConnection() const
+{
+  return m_connection;
+}
+
+bool ScopedConnection::isConnected() const
+{
+  return m_connection.isConnected();
+}
+
+void ScopedConnection::disconnect()
+{
+  m_connection.disconnect();
+}
+
+/**
+   Returns the connection without disconnecting it (the slot is not
+   disconnected when the ScopedConnection is destroyed).
+*/
+Connection ScopedConnection::release()
+{
+  Connection conn = m_connection;
+  m_connection = Connection();
+  return conn;
+}
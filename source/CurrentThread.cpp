@@ -0,0 +1,547 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+
+#include "Wg/Thread.hpp"
+#include "Wg/Debug.hpp"
+#include "Wg/DispatchProfiler.hpp"
+#include "Wg/Frame.hpp"
+#include "Wg/HangWatchdog.hpp"
+#include "Wg/Signal.hpp"
+#include "Wg/Timer.hpp"
+#include "Wg/Mutex.hpp"
+#include "Wg/Point.hpp"
+#include "Wg/QueuedCall.hpp"
+#include "Wg/ScopedLock.hpp"
+#include "Wg/TimePoint.hpp"
+#include "Wg/Win32.hpp"
+
+#include <vector>
+#include <algorithm>
+#include <climits>
+
+using namespace Wg;
+
+// Maximum number of positions of the mouse in a coalesced WM_MOUSEMOVE
+#define MAX_MOUSE_HISTORY 64
+
+// ======================================================================
+
+// TODO
+// - replace with some C++0x's Thread-Local Storage
+// - use __thread in GCC, and __declspec( thread ) in MSVC
+// - use TlsAlloc
+
+struct ThreadData
+{
+  /**
+     The ID of this thread.
+  */
+  ThreadId threadId;
+
+  /**
+     Visible frames in this thread. A frame is an instance of Frame
+     class.
+  */
+  std::vector<Frame*> frames;
+
+  TimePoint updateIndicatorsMark;
+  bool updateIndicators : 1;
+
+  /**
+     True if the message-loop must be stopped.
+  */
+  bool breakLoop : 1;
+
+  /**
+     True if the mouse messages are coalesced (see
+     CurrentThread::setInputCoalescing).
+  */
+  bool inputCoalescing : 1;
+
+  /**
+     Widget used to call createHandle.
+  */
+  Widget* outsideWidget;
+
+  /**
+     Positions of the last WM_MOUSEMOVE returned by getMessage (in
+     client coordinates of mouseHwnd). It is consumed by the
+     Widget::wndProc of mouseHwnd.
+  */
+  std::vector<Point> mouseHistory;
+  HWND mouseHwnd;
+  LPARAM mouseLParam;
+
+  /**
+     Last position of the mouse that was added to the history (in
+     screen coordinates), so the old positions in the history of the
+     system are not repeated.
+  */
+  MOUSEMOVEPOINT lastMouseMove;
+
+  ThreadData(ThreadId id) {
+    threadId = id;
+    breakLoop = false;
+    updateIndicators = true;
+    inputCoalescing = false;
+    outsideWidget = nullptr;
+    mouseHwnd = nullptr;
+    mouseLParam = 0;
+    lastMouseMove.x = lastMouseMove.y = 0;
+    lastMouseMove.time = 0;
+    lastMouseMove.dwExtraInfo = 0;
+  }
+
+};
+
+static Mutex data_mutex;
+static std::vector<ThreadData*> dataOfEachThread;
+
+static ThreadData* get_thread_data()
+{
+  ScopedLock hold(data_mutex);
+  std::vector<ThreadData*>::iterator it, end = dataOfEachThread.end();
+  ThreadId id = ::GetCurrentThreadId();
+
+  // first of all search the thread-data in the list "dataOfEachThread"...
+  for (it=dataOfEachThread.begin();
+       it!=end;
+       ++it) {
+    if ((*it)->threadId == id)	// it's already created...
+      return *it;		// return it
+  }
+
+  // create the data for the this thread
+  auto* data = new ThreadData(id);
+  VACA_TRACE("new data-thread %d\n", id)
+
+  // add it to the list
+  dataOfEachThread.push_back(data);
+
+  // return the allocated data
+  return data;
+}
+
+// ======================================================================
+
+/**
+   Posts the @a message to the message queue of the thread.
+
+   @return
+     False if the thread finished or it does not have a message queue
+     (like QueuedCall#post, the message is not retried: the threads
+     created with Thread have a queue from the beginning).
+*/
+bool Thread::enqueueMessage(const Message& message) const
+{
+  MSG const* msg = (MSG const*)message;
+
+  return ::PostThreadMessage(static_cast<DWORD>(getId()),
+			     msg->message, msg->wParam, msg->lParam) != 0;
+}
+
+// ======================================================================
+// CurrentThread
+
+/**
+   Posts the @a message to the message queue of the current thread
+   (the queue is created if the thread does not have one yet).
+*/
+bool CurrentThread::enqueueMessage(const Message& message)
+{
+  // Force the creation of the message queue
+  MSG msg;
+  ::PeekMessage(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+
+  Thread currentThread;
+  return currentThread.enqueueMessage(message);
+}
+
+/**
+   Does the message loop while there are
+   visible @link Wg::Frame frames@endlink.
+
+   @see Frame::setVisible
+*/
+void Wg::CurrentThread::doMessageLoop()
+{
+  // message loop
+  Message msg;
+  while (getMessage(msg))
+    processMessage(msg);
+}
+
+/**
+   Does the message loop until the @a widget is hidden.
+*/
+void Wg::CurrentThread::doMessageLoopFor(Widget* widget)
+{
+  // get widget HWND
+  HWND hwnd = widget->getHandle();
+  assert(::IsWindow(hwnd));
+
+  // get parent HWND
+  HWND hparent = widget->getParentHandle();
+
+  // disable the parent HWND
+  if (hparent != nullptr)
+    ::EnableWindow(hparent, FALSE);
+
+  // message loop
+  Message message;
+  while (widget->isVisible() && getMessage(message))
+    processMessage(message);
+
+  // enable the parent HWND
+  if (hparent)
+    ::EnableWindow(hparent, TRUE);
+}
+
+void Wg::CurrentThread::pumpMessageQueue()
+{
+  Message msg;
+  while (peekMessage(msg))
+    processMessage(msg);
+}
+
+void Wg::CurrentThread::breakMessageLoop()
+{
+  get_thread_data()->breakLoop = true;
+  ::PostThreadMessage(::GetCurrentThreadId(), WM_NULL, 0, 0);
+}
+
+/**
+   Returns true if the input messages of this thread are coalesced.
+
+   @see setInputCoalescing
+*/
+bool Wg::CurrentThread::isInputCoalescing()
+{
+  return get_thread_data()->inputCoalescing;
+}
+
+/**
+   Enables or disables the coalescing of the input messages that are
+   received by the message loop of this thread (it is disabled by
+   default):
+   @li Consecutive mouse movements are dispatched as one
+       Widget#onMouseMove. The MouseEvent contains all the positions of
+       the mouse (see MouseEvent#getHistoryPoint).
+   @li The deltas of consecutive wheel messages are added and
+       dispatched as one Widget#onMouseWheel.
+   @li Consecutive changes of size of a widget are dispatched as one
+       Widget#onResize, after the current message is processed.
+
+   It is useful when the handlers of these events are slow (e.g. a
+   canvas that is panned dragging the mouse, or a frame with a complex
+   layout that is resized).
+*/
+void Wg::CurrentThread::setInputCoalescing(bool state)
+{
+  get_thread_data()->inputCoalescing = state;
+}
+
+// Returns true if "next" is a message that can be merged with "msg"
+// (the same kind of input to the same window with the same keys)
+static bool can_coalesce(const MSG& msg, const MSG& next)
+{
+  return
+    next.message == msg.message &&
+    next.hwnd == msg.hwnd &&
+    LOWORD(next.wParam) == LOWORD(msg.wParam);
+}
+
+// Fills the history of positions of a WM_MOUSEMOVE with the positions
+// that the system recorded since the last processed one (they are lost
+// when the mouse moves faster than the messages are processed)
+static void fill_mouse_history(ThreadData* data, const MSG& msg)
+{
+  POINT pt = { MAKEPOINTS(msg.lParam).x, MAKEPOINTS(msg.lParam).y };
+  ::ClientToScreen(msg.hwnd, &pt);
+
+  MOUSEMOVEPOINT current;
+  current.x = pt.x & 0xffff;
+  current.y = pt.y & 0xffff;
+  current.time = msg.time;
+  current.dwExtraInfo = 0;
+
+  MOUSEMOVEPOINT points[MAX_MOUSE_HISTORY];
+  int count = 0;
+  if (data->lastMouseMove.time != 0)
+    count = ::GetMouseMovePointsEx(sizeof(MOUSEMOVEPOINT), &current,
+                                   points, MAX_MOUSE_HISTORY,
+                                   GMMP_USE_DISPLAY_POINTS);
+
+  // The first point is the current one, skip the points that were
+  // already processed
+  int n = 1;
+  for (; n < count; ++n) {
+    const MOUSEMOVEPOINT& mp = points[n];
+    if (mp.time < data->lastMouseMove.time ||
+        (mp.time == data->lastMouseMove.time &&
+         mp.x == data->lastMouseMove.x &&
+         mp.y == data->lastMouseMove.y))
+      break;
+  }
+
+  data->mouseHistory.clear();
+  for (int i=n-1; i>0; --i) {
+    // Negative coordinates of multiple monitors
+    POINT hist = { points[i].x > 32767 ? points[i].x - 65536: points[i].x,
+                   points[i].y > 32767 ? points[i].y - 65536: points[i].y };
+    ::ScreenToClient(msg.hwnd, &hist);
+    data->mouseHistory.push_back(convert_to<Point>(hist));
+  }
+  data->mouseHistory.push_back(convert_to<Point>(MAKEPOINTS(msg.lParam)));
+
+  data->mouseHwnd = msg.hwnd;
+  data->mouseLParam = msg.lParam;
+  data->lastMouseMove = current;
+}
+
+// Merges the input messages of the queue that are like "msg"
+static void coalesce_input(ThreadData* data, MSG& msg)
+{
+  MSG next;
+
+  switch (msg.message) {
+
+    case WM_MOUSEMOVE:
+      // Only the last position is dispatched
+      while (::PeekMessage(&next, nullptr, 0, 0, PM_NOREMOVE) &&
+             can_coalesce(msg, next) &&
+             ::PeekMessage(&next, msg.hwnd, WM_MOUSEMOVE, WM_MOUSEMOVE, PM_REMOVE))
+        msg = next;
+
+      fill_mouse_history(data, msg);
+      break;
+
+    case WM_MOUSEWHEEL: {
+      int delta = GET_WHEEL_DELTA_WPARAM(msg.wParam);
+
+      while (::PeekMessage(&next, nullptr, 0, 0, PM_NOREMOVE) &&
+             can_coalesce(msg, next)) {
+        // The sum must fit in the WPARAM
+        int nextDelta = GET_WHEEL_DELTA_WPARAM(next.wParam);
+        if (delta + nextDelta > SHRT_MAX || delta + nextDelta < SHRT_MIN)
+          break;
+
+        ::PeekMessage(&next, msg.hwnd, WM_MOUSEWHEEL, WM_MOUSEWHEEL, PM_REMOVE);
+        delta += nextDelta;
+        msg.lParam = next.lParam;
+        msg.time = next.time;
+      }
+
+      msg.wParam = MAKEWPARAM(LOWORD(msg.wParam), static_cast<WORD>(static_cast<short>(delta)));
+      break;
+    }
+  }
+}
+
+/**
+   Gets a message waiting for it: locks the execution of the program
+   until a message is received from the operating system.
+
+   @return
+     True if the @a message parameter was filled (because a message was received)
+     or false if there aren't more visible @link Frame frames@endlink
+     to dispatch messages.
+*/
+bool Wg::CurrentThread::getMessage(Message& message)
+{
+  ThreadData* data = get_thread_data();
+
+  // break this loop? (explicit break or no-more visible frames)
+  if (data->breakLoop || data->frames.empty())
+    return false;
+
+  // we have to update indicators?
+  if (data->updateIndicators &&
+      data->updateIndicatorsMark.elapsed() > 0.1) {
+    data->updateIndicators = false;
+
+    // for each registered frame we should call updateIndicators to
+    // update the state of all visible indicators (like top-level
+    // items in the menu-bar and buttons in the tool-bar)
+    for (auto & frame : data->frames) {
+      frame->updateIndicators();
+    }
+  }
+
+  // get the message from the queue
+  auto msg = (LPMSG)message;
+  msg->hwnd = nullptr;
+  BOOL bRet = ::GetMessage(msg, nullptr, 0, 0);
+
+  // WM_QUIT received?
+  if (bRet == 0)
+    return false;
+
+  // WM_NULL message... maybe Timers or CallInNextRound
+  if (msg->message == WM_NULL)
+    Timer::pollTimers();
+
+  // merge mouse-moves and wheel messages
+  if (data->inputCoalescing)
+    coalesce_input(data, *msg);
+
+  return true;
+}
+
+/**
+   Gets a message without waiting for it, if the queue is empty, this
+   member function returns false.
+
+   The message is removed from the queue.
+
+   @return
+     Returns true if the @a msg parameter was filled with the next message
+     in the queue or false if the queue was empty.
+*/
+bool CurrentThread::peekMessage(Message& message)
+{
+  auto msg = (LPMSG)message;
+  msg->hwnd = nullptr;
+  return ::PeekMessage(msg, nullptr, 0, 0, PM_REMOVE) != FALSE;
+}
+
+void CurrentThread::processMessage(Message& message)
+{
+  auto msg = (LPMSG)message;
+
+  // heartbeat of the message loop
+  HangWatchdog::Scope watch(msg->message, msg->wParam, msg->lParam, nullptr, nullptr);
+
+  // Calls of queued signal connections
+  if (QueuedCall::dispatch(message))
+    return;
+
+#ifdef VACA_DISPATCH_PROFILER
+  // time in the queue (the time of the message is in milliseconds)
+  if (DispatchProfiler::getInstance().isEnabled())
+    DispatchProfiler::getInstance().addQueueWait(::GetTickCount() - msg->time);
+#endif
+
+  if (!CurrentThread::details::preTranslateMessage(message)) {
+    // Send preTranslateMessage to the active window (useful for
+    // modeless dialogs). WARNING: Don't use GetForegroundWindow
+    // because it returns windows from other applications
+    HWND hactive = GetActiveWindow();
+    if (hactive != nullptr && hactive != msg->hwnd) {
+      Widget* activeWidget = Widget::fromHandle(hactive);
+      if (activeWidget != nullptr && activeWidget->preTranslateMessage(message))
+	return;
+    }
+
+    //if (!TranslateAccelerator(msg->hwnd, hAccelTable, msg))
+    //{
+    ::TranslateMessage(msg);
+    ::DispatchMessage(msg);
+    //}
+  }
+}
+
+// ======================================================================
+// Vaca internals
+
+/**
+   Pretranslates the message. The main function is to retrieve the
+   Widget pointer (using Widget::fromHandle()) and then (if it isn't
+   NULL), call its Widget#preTranslateMessage.
+*/
+bool CurrentThread::details::preTranslateMessage(Message& message)
+{
+  auto msg = (LPMSG)message;
+
+  // TODO process messages that produce a update-indicators event
+  if ((msg->message == WM_ACTIVATE) ||
+      (msg->message == WM_CLOSE) ||
+      (msg->message == WM_SETFOCUS) ||
+      (msg->message == WM_KILLFOCUS) ||
+      (msg->message >= WM_LBUTTONDOWN && msg->message <= WM_MBUTTONDBLCLK) ||
+      (msg->message >= WM_KEYDOWN && msg->message <= WM_DEADCHAR)) {
+    ThreadData* data = get_thread_data();
+    data->updateIndicators = true;
+    data->updateIndicatorsMark = TimePoint();
+  }
+
+  if (msg->hwnd != nullptr) {
+    Widget* widget = Widget::fromHandle(msg->hwnd);
+    if (widget && widget->preTranslateMessage(message))
+      return true;
+  }
+
+  return false;
+}
+
+/**
+    @internal
+ */
+Widget* CurrentThread::details::getOutsideWidget()
+{
+  return get_thread_data()->outsideWidget;
+}
+
+/**
+   @internal
+ */
+void CurrentThread::details::setOutsideWidget(Widget* widget)
+{
+  get_thread_data()->outsideWidget = widget;
+}
+
+/**
+   @internal
+ */
+void CurrentThread::details::addFrame(Frame* frame)
+{
+  get_thread_data()->frames.push_back(frame);
+}
+
+/**
+   @internal
+ */
+void CurrentThread::details::removeFrame(Frame* frame)
+{
+  remove_from_container(get_thread_data()->frames, frame);
+
+  // when this thread doesn't have more Frames to continue we must to
+  // break the current message loop
+  if (get_thread_data()->frames.empty())
+    CurrentThread::breakMessageLoop();
+}
+
+/**
+   Returns the positions of the mouse of the WM_MOUSEMOVE that is being
+   dispatched to @a hwnd (nullptr if the message was not coalesced).
+   The history is consumed (the next calls return nullptr).
+
+   @internal
+*/
+const std::vector<Point>* CurrentThread::details::getMouseHistory(HWND hwnd, LPARAM lParam)
+{
+  ThreadData* data = get_thread_data();
+
+  if (data->mouseHwnd != hwnd || data->mouseLParam != lParam)
+    return nullptr;
+
+  data->mouseHwnd = nullptr;
+  return &data->mouseHistory;
+}
+
+void details::removeAllThreadData()
+{
+  ScopedLock hold(data_mutex);
+  std::vector<ThreadData*>::iterator it, end = dataOfEachThread.end();
+
+  for (it=dataOfEachThread.begin(); it!=end; ++it) {
+    VACA_TRACE("delete data-thread %d\n", (*it)->threadId)
+    delete *it;
+  }
+
+  dataOfEachThread.clear();
+}
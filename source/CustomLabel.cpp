@@ -6,6 +6,9 @@
 
 #include "Wg/CustomLabel.hpp"
 #include "Wg/Debug.hpp"
+#include "Wg/Brush.hpp"
+#include "Wg/Graphics.hpp"
+#include "Wg/TextLayout.hpp"
 
 using namespace Wg;
 
@@ -29,6 +32,37 @@ void CustomLabel::setTextAlign(TextAlign align)
   invalidate(true);
 }
 
+/**
+   Draws the background and the text of the label using its cached
+   TextLayout. CustomLabel does not paint anything by default, a
+   subclass can call this function from its #onPaint to be painted
+   like a label.
+
+   @code
+   void MyLabel::onPaint(PaintEvent& ev)
+   {
+     drawTextLayout(ev.getGraphics());
+     ...
+   }
+   @endcode
+
+   @see Label#getTextLayout
+*/
+void CustomLabel::drawTextLayout(Graphics& g)
+{
+  Rect rc = getClientBounds();
+  Brush brush(getBgColor());
+
+  g.fillRect(brush, rc);
+  g.setFont(getFont());
+
+  TextLayout& layout = getTextLayout(rc.w);
+  if (isEnabled())
+    layout.draw(g, getFgColor(), rc, getTextAlign());
+  else
+    layout.drawDisabled(g, rc, getTextAlign());
+}
+
 bool CustomLabel::onReflectedDrawItem(Graphics& g, LPDRAWITEMSTRUCT lpDrawItem)
 {
   assert(lpDrawItem->CtlType == ODT_STATIC);
@@ -7,9 +7,9 @@
 #include "Wg/Debug.hpp"
 #include "Wg/Mutex.hpp"
 #include "Wg/ScopedLock.hpp"
-#include "Wg/System.hpp"
 #include "Wg/Thread.hpp"
 
+#include <cstdarg>
 #include <cstdio>
 
 using namespace std;
@@ -37,22 +37,25 @@ struct Debug {
 };
 #endif
 
-void Wg::details::trace(const char* filename, size_t line, const char* fmt, ...)
+// The arguments are not used in release builds
+void Wg::details::trace([[maybe_unused]] const char* filename,
+                        [[maybe_unused]] size_t line,
+                        [[maybe_unused]] const char* fmt, ...)
 {
 #ifndef NDEBUG
   if (closed) { return; }
   if (!dbg) { dbg = new Debug; }
 
   ScopedLock hold(dbg->mutex);
-  char buf[1024];		// TODO: overflow
+  char buf[1024];
   va_list ap;
 
   va_start(ap, fmt);
-  vsprintf(buf, fmt, ap);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
   va_end(ap);
 
-  fprintf(dbg->file, "%s:%d: [%d] %s", filename, line,
-	  static_cast<unsigned>(::GetCurrentThreadId()), buf);
+  fprintf(dbg->file, "%s:%zu: [%u] %s", filename, line,
+	  static_cast<unsigned>(CurrentThread::getId()), buf);
   fflush(dbg->file);
 #endif
 }
@@ -8,6 +8,7 @@
 #include "Wg/Debug.hpp"
 #include "Wg/Application.hpp"
 #include "Wg/CloseEvent.hpp"
+#include "Wg/MessageMap.hpp"
 #include "Wg/WidgetClass.hpp"
 #include "Wg/CommandEvent.hpp"
 
@@ -33,6 +34,8 @@ Dialog::Dialog(const String& title, Widget* parent, const Style& style)
 		   reinterpret_cast<LONG_PTR>(Dialog::globalDlgProc));
 
   m_state = false;
+
+  setMessageMap(getBaseMessageMap());
 }
 
 /**
@@ -50,6 +53,8 @@ Dialog::Dialog(const WidgetClassName& className, const String& title, Widget* pa
   }
 
   m_state = false;
+
+  setMessageMap(getBaseMessageMap());
 }
 
 Dialog::Dialog(ResourceId dialogId, Widget* parent)
@@ -59,17 +64,34 @@ Dialog::Dialog(ResourceId dialogId, Widget* parent)
 			 Dialog::globalDlgProc))
 {
   m_state = false;
+
+  setMessageMap(getBaseMessageMap());
 }
 
 Dialog::Dialog(HWND handle)
   : Frame(handle)
 {
   m_state = false;
+
+  setMessageMap(getBaseMessageMap());
 }
 
 Dialog::~Dialog()
 = default;
 
+/**
+   Returns the map of the Dialog class (Dialog does not handle other
+   messages than the ones of Frame#wndProc). It is the base map for
+   the maps of the classes derived from Dialog.
+
+   @see MessageMap, Widget#setMessageMap
+*/
+const MessageMap& Dialog::getBaseMessageMap()
+{
+  static const MessageMap map(typeid(Dialog), Frame::getBaseMessageMap(), { });
+  return map;
+}
+
 /**
    You can use this to set the doModal()'s return value.
 */
@@ -0,0 +1,502 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/DispatchProfiler.hpp"
+#include "Wg/ScopedLock.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <typeinfo>
+
+using namespace Wg;
+
+// Default number of messages kept for the timeline
+#define DEFAULT_TRACE_CAPACITY 65536
+
+// Percentiles exported in the JSON report
+static const double json_percentiles[] = { 50.0, 90.0, 99.0, 99.9 };
+
+// Nesting of dispatched messages in the current thread
+static thread_local unsigned dispatch_depth = 0;
+
+// Number of the current thread in the timeline
+static std::atomic<unsigned> thread_counter(0);
+static thread_local unsigned thread_number = ++thread_counter;
+
+struct MessageName {
+  UINT message;
+  const char* name;
+};
+
+// Names of the messages that are usually in a report
+static const MessageName message_names[] = {
+  { 0x0001, "WM_CREATE" },
+  { 0x0002, "WM_DESTROY" },
+  { 0x0003, "WM_MOVE" },
+  { 0x0005, "WM_SIZE" },
+  { 0x0006, "WM_ACTIVATE" },
+  { 0x0007, "WM_SETFOCUS" },
+  { 0x0008, "WM_KILLFOCUS" },
+  { 0x000C, "WM_SETTEXT" },
+  { 0x000D, "WM_GETTEXT" },
+  { 0x000F, "WM_PAINT" },
+  { 0x0010, "WM_CLOSE" },
+  { 0x0014, "WM_ERASEBKGND" },
+  { 0x0018, "WM_SHOWWINDOW" },
+  { 0x0020, "WM_SETCURSOR" },
+  { 0x0021, "WM_MOUSEACTIVATE" },
+  { 0x0024, "WM_GETMINMAXINFO" },
+  { 0x002B, "WM_DRAWITEM" },
+  { 0x0046, "WM_WINDOWPOSCHANGING" },
+  { 0x0047, "WM_WINDOWPOSCHANGED" },
+  { 0x004E, "WM_NOTIFY" },
+  { 0x007F, "WM_GETICON" },
+  { 0x0081, "WM_NCCREATE" },
+  { 0x0082, "WM_NCDESTROY" },
+  { 0x0083, "WM_NCCALCSIZE" },
+  { 0x0084, "WM_NCHITTEST" },
+  { 0x0085, "WM_NCPAINT" },
+  { 0x0086, "WM_NCACTIVATE" },
+  { 0x00A0, "WM_NCMOUSEMOVE" },
+  { 0x0100, "WM_KEYDOWN" },
+  { 0x0101, "WM_KEYUP" },
+  { 0x0102, "WM_CHAR" },
+  { 0x0111, "WM_COMMAND" },
+  { 0x0112, "WM_SYSCOMMAND" },
+  { 0x0113, "WM_TIMER" },
+  { 0x0114, "WM_HSCROLL" },
+  { 0x0115, "WM_VSCROLL" },
+  { 0x0133, "WM_CTLCOLOREDIT" },
+  { 0x0138, "WM_CTLCOLORSTATIC" },
+  { 0x0200, "WM_MOUSEMOVE" },
+  { 0x0201, "WM_LBUTTONDOWN" },
+  { 0x0202, "WM_LBUTTONUP" },
+  { 0x0203, "WM_LBUTTONDBLCLK" },
+  { 0x0204, "WM_RBUTTONDOWN" },
+  { 0x0205, "WM_RBUTTONUP" },
+  { 0x020A, "WM_MOUSEWHEEL" },
+  { 0x0214, "WM_SIZING" },
+  { 0x0215, "WM_CAPTURECHANGED" },
+  { 0x0216, "WM_MOVING" },
+  { 0x0231, "WM_ENTERSIZEMOVE" },
+  { 0x0232, "WM_EXITSIZEMOVE" },
+  { 0x0233, "WM_DROPFILES" },
+  { 0x02A3, "WM_MOUSELEAVE" },
+};
+
+static std::string get_message_name(UINT message)
+{
+  for (const MessageName& item : message_names)
+    if (item.message == message)
+      return item.name;
+
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "0x%04X", message);
+  return buf;
+}
+
+// Escapes the characters of "str" that cannot be in a JSON string
+static std::string escape_json(const char* str)
+{
+  std::string result;
+  for (; *str != 0; ++str) {
+    if (*str == '"' || *str == '\\')
+      result.push_back('\\');
+    if (static_cast<unsigned char>(*str) >= 32)
+      result.push_back(*str);
+  }
+  return result;
+}
+
+static inline double to_usecs(unsigned long long nsecs)
+{
+  return static_cast<double>(nsecs) / 1000.0;
+}
+
+// Writes the summary of a histogram as members of a JSON object
+static void append_histogram(std::string& out, const DispatchProfiler::Histogram& histogram)
+{
+  char buf[256];
+  std::snprintf(buf, sizeof(buf),
+                "\"count\":%llu,\"min_us\":%.3f,\"mean_us\":%.3f,\"max_us\":%.3f",
+                histogram.getCount(),
+                to_usecs(histogram.getMin()),
+                histogram.getMean() / 1000.0,
+                to_usecs(histogram.getMax()));
+  out += buf;
+
+  for (double percentile : json_percentiles) {
+    std::snprintf(buf, sizeof(buf), ",\"p%g_us\":%.3f",
+                  percentile, to_usecs(histogram.getValueAtPercentile(percentile)));
+    out += buf;
+  }
+}
+
+// ======================================================================
+
+DispatchProfiler::Histogram::Histogram()
+{
+  reset();
+}
+
+void DispatchProfiler::Histogram::reset()
+{
+  m_count = 0;
+  m_min = 0;
+  m_max = 0;
+  m_sum = 0.0;
+  std::fill(m_buckets, m_buckets+Buckets, 0);
+}
+
+void DispatchProfiler::Histogram::addValue(unsigned long long value)
+{
+  if (m_count == 0 || value < m_min) m_min = value;
+  if (m_count == 0 || value > m_max) m_max = value;
+  ++m_count;
+  m_sum += static_cast<double>(value);
+  ++m_buckets[getBucket(value)];
+}
+
+/**
+   Adds the values of other histogram.
+*/
+void DispatchProfiler::Histogram::add(const Histogram& histogram)
+{
+  if (histogram.m_count == 0)
+    return;
+
+  if (m_count == 0 || histogram.m_min < m_min) m_min = histogram.m_min;
+  if (m_count == 0 || histogram.m_max > m_max) m_max = histogram.m_max;
+  m_count += histogram.m_count;
+  m_sum += histogram.m_sum;
+
+  for (int i=0; i<Buckets; ++i)
+    m_buckets[i] += histogram.m_buckets[i];
+}
+
+double DispatchProfiler::Histogram::getMean() const
+{
+  return m_count > 0 ? m_sum / static_cast<double>(m_count): 0.0;
+}
+
+/**
+   Returns the value that is greater than or equal to @a percentile
+   percent of the values (e.g. 99.0). It is the highest value of its
+   bucket, so it can be up to 1/16 greater than the real value.
+*/
+unsigned long long DispatchProfiler::Histogram::getValueAtPercentile(double percentile) const
+{
+  if (m_count == 0)
+    return 0;
+
+  percentile = clamp_value(percentile, 0.0, 100.0);
+  auto wanted = static_cast<unsigned long long>(percentile * static_cast<double>(m_count) / 100.0 + 0.5);
+  wanted = clamp_value<unsigned long long>(wanted, 1, m_count);
+
+  unsigned long long count = 0;
+  for (int i=0; i<Buckets; ++i) {
+    count += m_buckets[i];
+    if (count >= wanted)
+      return clamp_value(getBucketLimit(i), m_min, m_max);
+  }
+  return m_max;
+}
+
+/**
+   Returns the index of the bucket where @a value is counted.
+*/
+int DispatchProfiler::Histogram::getBucket(unsigned long long value)
+{
+  if (value < SubBuckets)
+    return static_cast<int>(value);
+
+  // Position of the most significant bit
+  int magnitude = 0;
+  for (unsigned long long v = value; v > 1; v >>= 1)
+    ++magnitude;
+
+  int bucket = (magnitude-3)*SubBuckets + static_cast<int>((value >> (magnitude-4)) & (SubBuckets-1));
+  return min_value<int>(bucket, Buckets-1);
+}
+
+/**
+   Returns the highest value that is counted in the @a bucket.
+*/
+unsigned long long DispatchProfiler::Histogram::getBucketLimit(int bucket)
+{
+  if (bucket < SubBuckets)
+    return static_cast<unsigned long long>(bucket);
+
+  int magnitude = bucket/SubBuckets + 3;
+  unsigned long long sub = SubBuckets + bucket%SubBuckets;
+  return ((sub+1) << (magnitude-4)) - 1;
+}
+
+// ======================================================================
+
+/**
+   Starts to measure the dispatch of @a message to a widget of the class
+   @a type. It does nothing if the profiler is disabled.
+*/
+DispatchProfiler::Scope::Scope(UINT message, const std::type_info& type)
+  : m_active(DispatchProfiler::getInstance().isEnabled())
+  , m_message(message)
+  , m_type(&type)
+  , m_depth(0)
+{
+  if (m_active) {
+    m_depth = ++dispatch_depth;
+    m_start = Clock::now();
+  }
+}
+
+DispatchProfiler::Scope::~Scope()
+{
+  if (m_active) {
+    Clock::duration duration = Clock::now() - m_start;
+    --dispatch_depth;
+
+    DispatchProfiler::getInstance().addDispatch(m_message, *m_type, m_start, duration, m_depth);
+  }
+}
+
+// ======================================================================
+
+DispatchProfiler::DispatchProfiler()
+  : m_enabled(false)
+  , m_traceNext(0)
+  , m_traceCapacity(DEFAULT_TRACE_CAPACITY)
+  , m_origin(Clock::now())
+{
+}
+
+DispatchProfiler::~DispatchProfiler()
+= default;
+
+/**
+   Returns the profiler shared by all the threads.
+*/
+DispatchProfiler& DispatchProfiler::getInstance()
+{
+  static DispatchProfiler instance;
+  return instance;
+}
+
+bool DispatchProfiler::isEnabled() const
+{
+  return m_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+   Starts or stops recording the messages. The data recorded until now
+   is kept (see #reset).
+*/
+void DispatchProfiler::setEnabled(bool state)
+{
+  m_enabled = state;
+}
+
+/**
+   Changes how many messages are kept for the timeline (see
+   #getChromeTrace). When the timeline is full, the oldest messages are
+   replaced. It removes the current timeline.
+*/
+void DispatchProfiler::setTraceCapacity(std::size_t events)
+{
+  ScopedLock hold(m_mutex);
+  m_trace.clear();
+  m_trace.shrink_to_fit();
+  m_traceNext = 0;
+  m_traceCapacity = events;
+}
+
+/**
+   Removes all the recorded data.
+*/
+void DispatchProfiler::reset()
+{
+  ScopedLock hold(m_mutex);
+  m_messages.clear();
+  m_classes.clear();
+  m_queueWait.reset();
+  m_depths.clear();
+  m_trace.clear();
+  m_traceNext = 0;
+  m_origin = Clock::now();
+}
+
+/**
+   Records the dispatch of a message.
+
+   @param message
+     The message ID.
+
+   @param type
+     The class of the widget that received the message.
+
+   @param depth
+     Number of nested dispatches (1 for a message that was not sent
+     from the handler of other message).
+
+   @internal
+*/
+void DispatchProfiler::addDispatch(UINT message, const std::type_info& type,
+                                   Clock::time_point start, Clock::duration duration,
+                                   unsigned depth)
+{
+  auto nsecs = static_cast<unsigned long long>(
+    std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+
+  ScopedLock hold(m_mutex);
+
+  m_messages[message].addValue(nsecs);
+  m_classes[std::type_index(type)].addValue(nsecs);
+
+  if (m_depths.size() <= depth)
+    m_depths.resize(depth+1, 0);
+  ++m_depths[depth];
+
+  if (m_traceCapacity > 0) {
+    TraceEvent event;
+    event.message = message;
+    event.type = &type;
+    event.start = start > m_origin ?
+      static_cast<unsigned long long>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(start - m_origin).count()): 0;
+    event.duration = nsecs;
+    event.depth = depth;
+    event.thread = thread_number;
+
+    if (m_trace.size() < m_traceCapacity)
+      m_trace.push_back(event);
+    else
+      m_trace[m_traceNext] = event;
+    m_traceNext = (m_traceNext+1) % m_traceCapacity;
+  }
+}
+
+/**
+   Records the time that a posted message waited in the queue.
+
+   @internal
+*/
+void DispatchProfiler::addQueueWait(unsigned long msecs)
+{
+  ScopedLock hold(m_mutex);
+  m_queueWait.addValue(static_cast<unsigned long long>(msecs) * 1000000);
+}
+
+/**
+   Returns the latencies (in nanoseconds) of the dispatches of
+   @a message.
+*/
+DispatchProfiler::Histogram DispatchProfiler::getMessageHistogram(UINT message) const
+{
+  ScopedLock hold(m_mutex);
+  auto it = m_messages.find(message);
+  return it != m_messages.end() ? it->second: Histogram();
+}
+
+/**
+   Returns the times (in nanoseconds, with a precision of milliseconds)
+   that the posted messages waited in the queue.
+*/
+DispatchProfiler::Histogram DispatchProfiler::getQueueWaitHistogram() const
+{
+  ScopedLock hold(m_mutex);
+  return m_queueWait;
+}
+
+/**
+   Returns how many messages were dispatched with each re-entrancy
+   depth (the index of the vector).
+*/
+std::vector<unsigned long long> DispatchProfiler::getDepthCounts() const
+{
+  ScopedLock hold(m_mutex);
+  return m_depths;
+}
+
+/**
+   Returns a JSON object with the statistics of the dispatches of each
+   message ID and each class of widget (times in microseconds).
+*/
+std::string DispatchProfiler::getJson() const
+{
+  ScopedLock hold(m_mutex);
+  std::string out;
+  char buf[64];
+
+  out += "{\"messages\":[";
+  for (auto it = m_messages.begin(); it != m_messages.end(); ++it) {
+    std::snprintf(buf, sizeof(buf), "%s{\"message\":%u,\"name\":\"",
+                  it == m_messages.begin() ? "": ",", it->first);
+    out += buf;
+    out += get_message_name(it->first);
+    out += "\",";
+    append_histogram(out, it->second);
+    out += "}";
+  }
+
+  out += "],\"classes\":[";
+  for (auto it = m_classes.begin(); it != m_classes.end(); ++it) {
+    if (it != m_classes.begin())
+      out += ",";
+    out += "{\"class\":\"";
+    out += escape_json(it->first.name());
+    out += "\",";
+    append_histogram(out, it->second);
+    out += "}";
+  }
+
+  out += "],\"queue_wait\":{";
+  append_histogram(out, m_queueWait);
+
+  out += "},\"depths\":[";
+  for (std::size_t i=1; i<m_depths.size(); ++i) {
+    std::snprintf(buf, sizeof(buf), "%s%llu", i > 1 ? ",": "", m_depths[i]);
+    out += buf;
+  }
+  out += "]}";
+  return out;
+}
+
+/**
+   Returns the last dispatched messages in the Trace Event Format of
+   Chrome (it can be opened in @c chrome://tracing or Perfetto). Each
+   message is a complete event with the name of the message, and the
+   class of the widget and the depth as arguments.
+*/
+std::string DispatchProfiler::getChromeTrace() const
+{
+  ScopedLock hold(m_mutex);
+  std::string out;
+  char buf[128];
+
+  out += "{\"traceEvents\":[";
+
+  // From the oldest to the newest event
+  std::size_t first = (m_trace.size() < m_traceCapacity ? 0: m_traceNext);
+  for (std::size_t i=0; i<m_trace.size(); ++i) {
+    const TraceEvent& event = m_trace[(first+i) % m_trace.size()];
+
+    if (i > 0)
+      out += ",";
+    out += "{\"name\":\"";
+    out += get_message_name(event.message);
+    std::snprintf(buf, sizeof(buf),
+                  "\",\"cat\":\"dispatch\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u,",
+                  to_usecs(event.start), to_usecs(event.duration), event.thread);
+    out += buf;
+    out += "\"args\":{\"class\":\"";
+    out += escape_json(event.type->name());
+    std::snprintf(buf, sizeof(buf), "\",\"depth\":%u}}", event.depth);
+    out += buf;
+  }
+
+  out += "],\"displayTimeUnit\":\"ms\"}";
+  return out;
+}
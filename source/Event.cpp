@@ -5,6 +5,7 @@
 // please read LICENSE.txt for more information.
 
 #include "Wg/Event.hpp"
+#include "Wg/EventPool.hpp"
 
 using namespace Wg;
 
@@ -36,3 +37,16 @@ Component* Event::getSource()
 {
   return m_source;
 }
+
+/**
+   Allocates an event from the EventPool.
+*/
+void* Event::operator new(std::size_t size)
+{
+  return EventPool::allocate(size);
+}
+
+void Event::operator delete(void* ptr, std::size_t size)
+{
+  EventPool::deallocate(ptr, size);
+}
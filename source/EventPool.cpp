@@ -0,0 +1,177 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/EventPool.hpp"
+#include "Wg/Mutex.hpp"
+#include "Wg/ScopedLock.hpp"
+
+#include <atomic>
+#include <new>
+#include <vector>
+
+using namespace Wg;
+
+// The blocks are multiple of this size
+#define POOL_GRANULARITY   16
+
+// Number of sizes of blocks
+#define POOL_CLASSES       (EventPool::MaxBlockSize / POOL_GRANULARITY)
+
+// Number of blocks moved between a thread and the central lists
+#define POOL_BATCH         32
+
+// Maximum number of free blocks of each size in the central lists
+#define POOL_MAX_CENTRAL   4096
+
+typedef std::vector<void*> FreeList;
+
+namespace {
+
+// Free blocks shared by all the threads
+struct CentralFreeLists {
+  FreeList lists[POOL_CLASSES];
+
+  ~CentralFreeLists() {
+    for (FreeList& list : lists)
+      for (void* ptr : list)
+        ::operator delete(ptr);
+  }
+};
+
+}
+
+static Mutex central_mutex;
+static CentralFreeLists central;
+
+static std::atomic<unsigned long long> pool_allocations(0);
+static std::atomic<unsigned long long> heap_allocations(0);
+static std::atomic<unsigned long long> live_blocks(0);
+
+static inline std::size_t get_class(std::size_t size)
+{
+  return (size + POOL_GRANULARITY - 1) / POOL_GRANULARITY - 1;
+}
+
+// Moves "count" blocks from the back of "src" to "dst"
+static void move_blocks(FreeList& dst, FreeList& src, std::size_t count)
+{
+  count = min_value(count, src.size());
+  dst.insert(dst.end(), src.end() - count, src.end());
+  src.resize(src.size() - count);
+}
+
+namespace {
+
+// Free blocks of the current thread. They are returned to the central
+// lists when the thread finishes
+struct ThreadFreeLists {
+  FreeList lists[POOL_CLASSES];
+
+  ~ThreadFreeLists() {
+    ScopedLock hold(central_mutex);
+    for (int i=0; i<POOL_CLASSES; ++i) {
+      FreeList& list = central.lists[i];
+
+      if (list.size() < POOL_MAX_CENTRAL)
+        move_blocks(list, lists[i], POOL_MAX_CENTRAL - list.size());
+
+      for (void* ptr : lists[i])
+        ::operator delete(ptr);
+    }
+  }
+};
+
+}
+
+static FreeList& get_thread_free_list(std::size_t index)
+{
+  static thread_local ThreadFreeLists thread_lists;
+  return thread_lists.lists[index];
+}
+
+/**
+   Returns a block of @a size bytes.
+*/
+void* EventPool::allocate(std::size_t size)
+{
+  const std::size_t index = get_class(size);
+  ++live_blocks;
+
+  if (index >= POOL_CLASSES) {
+    ++heap_allocations;
+    return ::operator new(size);
+  }
+
+  FreeList& local = get_thread_free_list(index);
+  if (local.empty()) {
+    ScopedLock hold(central_mutex);
+    move_blocks(local, central.lists[index], POOL_BATCH);
+  }
+
+  if (!local.empty()) {
+    void* ptr = local.back();
+    local.pop_back();
+    ++pool_allocations;
+    return ptr;
+  }
+
+  ++heap_allocations;
+  return ::operator new((index+1) * POOL_GRANULARITY);
+}
+
+/**
+   Returns the block @a ptr (of @a size bytes) to the pool of the
+   current thread. It can be freed by a thread that did not allocate
+   it.
+*/
+void EventPool::deallocate(void* ptr, std::size_t size)
+{
+  if (ptr == nullptr)
+    return;
+
+  const std::size_t index = get_class(size);
+  --live_blocks;
+
+  if (index >= POOL_CLASSES) {
+    ::operator delete(ptr);
+    return;
+  }
+
+  FreeList& local = get_thread_free_list(index);
+  local.push_back(ptr);
+
+  // This thread frees more blocks than it allocates, other threads
+  // can use them
+  if (local.size() >= 2*POOL_BATCH) {
+    ScopedLock hold(central_mutex);
+    FreeList& list = central.lists[index];
+    if (list.size() < POOL_MAX_CENTRAL)
+      move_blocks(list, local, POOL_BATCH);
+    else {
+      for (int i=0; i<POOL_BATCH; ++i) {
+        ::operator delete(local.back());
+        local.pop_back();
+      }
+    }
+  }
+}
+
+/**
+   Returns the counters of allocations of all the threads.
+*/
+EventPool::Stats EventPool::getStats()
+{
+  return Stats{ pool_allocations, heap_allocations, live_blocks };
+}
+
+/**
+   Resets the counters of allocations (Stats#liveBlocks is not reset).
+*/
+void EventPool::resetStats()
+{
+  pool_allocations = 0;
+  heap_allocations = 0;
+}
@@ -7,8 +7,15 @@
 #include "Wg/Exception.hpp"
 #include "Wg/String.hpp"
 
+
+#ifdef VACA_ON_WINDOWS
 #include <lmerr.h>
 #include <wininet.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <string>
+#endif
 
 using namespace Wg;
 
@@ -63,6 +70,7 @@ int Exception::getErrorCode() const
 
 void Exception::initialize()
 {
+#ifdef VACA_ON_WINDOWS
   HMODULE hmodule = nullptr;
   DWORD flags =
     FORMAT_MESSAGE_ALLOCATE_BUFFER |
@@ -107,4 +115,18 @@ void Exception::initialize()
     LocalFree(msgbuf);
   }
   m_what += convert_to<std::string>(m_message);
+#else
+  m_errorCode = errno;
+
+  m_what += std::to_string(m_errorCode);
+  m_what += " - ";
+  if (m_errorCode != 0) {
+    m_what += std::strerror(m_errorCode);
+    m_what += "\n";
+  }
+
+  // convert_to needs Win32, the message is converted to ASCII here
+  for (Char chr : m_message)
+    m_what.push_back(chr >= 0 && chr < 128 ? static_cast<char>(chr): '?');
+#endif
 }
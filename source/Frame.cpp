@@ -11,6 +11,7 @@
 #include "Wg/Debug.hpp"
 #include "Wg/Menu.hpp"
 #include "Wg/MenuItemEvent.hpp"
+#include "Wg/MessageMap.hpp"
 #include "Wg/AnchorLayout.hpp"
 #include "Wg/Event.hpp"
 #include "Wg/Point.hpp"
@@ -57,6 +58,8 @@ void Frame::initialize(const String& title)
   m_menuBar = nullptr;
   m_counted = false;
 
+  setMessageMap(getBaseMessageMap());
+
   // we can set the title of the window now if we have the HWND (for
   // example, HWND could be NULL here if we come from a Dialog's
   // contructor)
@@ -608,3 +611,25 @@ bool Frame::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lResult
 
   return false;
 }
+
+/**
+   Returns the map with the messages that Frame#wndProc handles (and
+   the ones of Widget). It is the base map for the maps of the classes
+   derived from Frame.
+
+   @see MessageMap, Widget#setMessageMap
+*/
+const MessageMap& Frame::getBaseMessageMap()
+{
+  // the same messages of the switch in wndProc
+  static const MessageMap map(typeid(Frame), Widget::getBaseMessageMap(), {
+      MessageMap::forward(WM_CLOSE),
+      MessageMap::forward(WM_ACTIVATE),
+      MessageMap::forward(WM_INITMENU),
+      MessageMap::forward(WM_INITMENUPOPUP),
+      MessageMap::forward(WM_SIZING),
+      MessageMap::forward(WM_ENABLE),
+      MessageMap::forward(WM_NCACTIVATE),
+    });
+  return map;
+}
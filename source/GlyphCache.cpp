@@ -0,0 +1,325 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/GlyphCache.hpp"
+#include "Wg/Color.hpp"
+
+#include <cstring>
+
+#if defined(VACA_WINDOWS)
+  #include "Win32/GlyphCacheImpl.hpp"
+#else
+  #error Implement GlyphCache rasterization in your platform
+#endif
+
+using namespace Wg;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+// Transparent pixels around each mask in the coverage buffer
+static const int glyph_padding = 1;
+
+static inline std::uint64_t make_glyph_key(int fontIndex, Char chr, int subpixel)
+{
+  return
+    (static_cast<std::uint64_t>(fontIndex) << 40) |
+    (static_cast<std::uint64_t>(subpixel) << 32) |
+    static_cast<std::uint32_t>(chr);
+}
+
+/**
+   Creates an empty cache.
+
+   @param sz
+     Size of the coverage buffer where all glyphs are packed.
+*/
+GlyphCache::GlyphCache(const Size& sz)
+  : m_coverage(sz.w * sz.h, 0)
+  , m_packer(sz)
+  , m_hits(0)
+  , m_misses(0)
+  , m_flushes(0)
+{
+}
+
+GlyphCache::~GlyphCache()
+= default;
+
+/**
+   Returns the cache shared by all the widgets of the UI thread.
+*/
+GlyphCache& GlyphCache::getInstance()
+{
+  static GlyphCache instance;
+  return instance;
+}
+
+Size GlyphCache::getSize() const
+{
+  return m_packer.getSize();
+}
+
+/**
+   Returns the coverage buffer: one byte per pixel (0 is transparent,
+   255 is opaque), #getSize().w bytes per row.
+*/
+const unsigned char* GlyphCache::getCoverage() const
+{
+  return &m_coverage[0];
+}
+
+int GlyphCache::getGlyphCount() const
+{
+  return static_cast<int>(m_glyphs.size());
+}
+
+/**
+   Returns how many times #getGlyph found the glyph already rasterized.
+*/
+unsigned GlyphCache::getHitCount() const
+{
+  return m_hits;
+}
+
+/**
+   Returns how many times #getGlyph had to rasterize a glyph.
+*/
+unsigned GlyphCache::getMissCount() const
+{
+  return m_misses;
+}
+
+/**
+   Returns how many times the coverage buffer was full and all glyphs
+   had to be discarded.
+*/
+unsigned GlyphCache::getFlushCount() const
+{
+  return m_flushes;
+}
+
+/**
+   Returns the glyph of the character @a chr, rasterizing it if it is
+   not in the cache yet.
+
+   The returned reference is valid until the next call to #getGlyph or
+   #clear.
+
+   @param subpixel
+     Horizontal offset of the pen inside the pixel, from 0 to
+     #SubpixelSteps-1.
+*/
+const GlyphCache::Glyph& GlyphCache::getGlyph(const Font& font, Char chr, int subpixel)
+{
+  return getGlyph(getFontIndex(font), chr, subpixel);
+}
+
+/**
+   Returns the distance between two lines of text of the @a font.
+*/
+int GlyphCache::getLineHeight(const Font& font)
+{
+  return m_fonts[getFontIndex(font)].height;
+}
+
+/**
+   Returns the size of the text using the cached glyph advances
+   (without calling the system each time like Graphics#measureString).
+
+   Each '\\n' character starts a new line.
+*/
+Size GlyphCache::measureString(const Font& font, const String& str)
+{
+  const int fontIndex = getFontIndex(font);
+  const int lineHeight = m_fonts[fontIndex].height;
+  int pen = 0, maxPen = 0, lines = 1;
+
+  for (Char chr : str) {
+    if (chr == L'\n') {
+      maxPen = max_value(maxPen, pen);
+      pen = 0;
+      ++lines;
+      continue;
+    }
+    pen += getGlyph(fontIndex, chr, pen & (SubpixelSteps-1)).advance;
+  }
+
+  maxPen = max_value(maxPen, pen);
+  return Size((maxPen + SubpixelSteps - 1) / SubpixelSteps, lines * lineHeight);
+}
+
+/**
+   Draws the text in @a dst blending the coverage of each glyph with
+   the specified @a color.
+
+   @param pt
+     Upper-left corner of the text (like in Graphics#drawString). Each
+     '\\n' character starts a new line.
+*/
+void GlyphCache::drawString(ImagePixels& dst, const Font& font, const String& str, const Color& color, const Point& pt)
+{
+  const int fontIndex = getFontIndex(font);
+  const int lineHeight = m_fonts[fontIndex].height;
+  const int dstW = dst.getWidth();
+  const int dstH = dst.getHeight();
+  const int dstScanline = dst.getScanlineSize();
+  const int srcScanline = getSize().w;
+  const int r = color.getR();
+  const int g = color.getG();
+  const int b = color.getB();
+  int pen = pt.x * SubpixelSteps;
+  int top = pt.y;
+
+  for (Char chr : str) {
+    if (chr == L'\n') {
+      pen = pt.x * SubpixelSteps;
+      top += lineHeight;
+      continue;
+    }
+
+    const Glyph& glyph = getGlyph(fontIndex, chr, pen & (SubpixelSteps-1));
+
+    // Clip the mask with the destination
+    int dx = (pen - (pen & (SubpixelSteps-1))) / SubpixelSteps + glyph.offset.x;
+    int dy = top + glyph.offset.y;
+    int sx = glyph.bounds.x, sy = glyph.bounds.y;
+    int w = glyph.bounds.w, h = glyph.bounds.h;
+
+    pen += glyph.advance;
+
+    if (dx < 0) { sx -= dx; w += dx; dx = 0; }
+    if (dy < 0) { sy -= dy; h += dy; dy = 0; }
+    if (dx + w > dstW) w = dstW - dx;
+    if (dy + h > dstH) h = dstH - dy;
+    if (w <= 0 || h <= 0)
+      continue;
+
+    for (int v=0; v<h; ++v) {
+      const unsigned char* s = &m_coverage[(sy+v)*srcScanline + sx];
+      pixel_type* d = &dst[(dy+v)*dstScanline + dx];
+
+      for (int u=0; u<w; ++u)
+        if (s[u])
+          d[u] = ImagePixels::blendPixel(d[u], ImagePixels::makePixel(r, g, b, s[u]));
+    }
+  }
+}
+
+/**
+   Discards all rasterized glyphs.
+*/
+void GlyphCache::clear()
+{
+  m_glyphs.clear();
+  m_packer.clear();
+  std::fill(m_coverage.begin(), m_coverage.end(), 0);
+}
+
+/**
+   @internal
+*/
+const GlyphCache::Glyph& GlyphCache::getGlyph(int fontIndex, Char chr, int subpixel)
+{
+  assert(subpixel >= 0 && subpixel < SubpixelSteps);
+
+  std::uint64_t key = make_glyph_key(fontIndex, chr, subpixel);
+
+  auto it = m_glyphs.find(key);
+  if (it != m_glyphs.end()) {
+    ++m_hits;
+    return it->second;
+  }
+
+  ++m_misses;
+
+  Glyph glyph;
+  std::vector<unsigned char> mask;
+
+  if (!rasterizeGlyph(m_fonts[fontIndex], chr, subpixel, glyph, mask)) {
+    glyph.bounds = Rect();
+    glyph.offset = Point(0, 0);
+    glyph.advance = 0;
+  }
+  else if (!glyph.bounds.isEmpty()) {
+    Size sz(glyph.bounds.w + 2*glyph_padding,
+            glyph.bounds.h + 2*glyph_padding);
+    Point pt;
+
+    if (!m_packer.insert(sz, pt)) {
+      // The buffer is full, start again from scratch
+      clear();
+      ++m_flushes;
+
+      if (!m_packer.insert(sz, pt)) {
+        // The glyph is bigger than the whole buffer
+        mask.clear();
+        glyph.bounds = Rect();
+      }
+    }
+
+    if (!mask.empty()) {
+      const int scanline = getSize().w;
+
+      glyph.bounds.x = pt.x + glyph_padding;
+      glyph.bounds.y = pt.y + glyph_padding;
+
+      for (int v=0; v<glyph.bounds.h; ++v)
+        std::memcpy(&m_coverage[(glyph.bounds.y+v)*scanline + glyph.bounds.x],
+                    &mask[v*glyph.bounds.w], glyph.bounds.w);
+    }
+  }
+
+  return m_glyphs[key] = glyph;
+}
+
+/**
+   Returns the index of the @a font in the list of known fonts, adding
+   it if it is new. Two fonts with the same LOGFONT have the same index.
+
+   @internal
+*/
+int GlyphCache::getFontIndex(const Font& font)
+{
+  for (size_t i=0; i<m_fonts.size(); ++i)
+    if (m_fonts[i].font.getHandle() == font.getHandle())
+      return static_cast<int>(i);
+
+  LOGFONT lf;
+  std::memset(&lf, 0, sizeof(LOGFONT));
+  font.getLogFont(&lf);
+
+  for (size_t i=0; i<m_fonts.size(); ++i)
+    if (std::memcmp(&m_fonts[i].logFont, &lf, sizeof(LOGFONT)) == 0)
+      return static_cast<int>(i);
+
+  FontEntry entry;
+  entry.font = font;
+  entry.logFont = lf;
+  get_glyph_font_metrics(font, entry.ascent, entry.height);
+
+  m_fonts.push_back(entry);
+  return static_cast<int>(m_fonts.size()) - 1;
+}
+
+/**
+   @internal
+*/
+bool GlyphCache::rasterizeGlyph(const FontEntry& entry, Char chr, int subpixel,
+                                Glyph& glyph, std::vector<unsigned char>& mask)
+{
+  Rect bounds;
+  int advance;
+
+  if (!rasterize_glyph_impl(entry.font, chr, subpixel, SubpixelSteps,
+                            bounds, advance, mask))
+    return false;
+
+  // Convert the origin from the baseline to the top of the line
+  glyph.bounds = Rect(0, 0, bounds.w, bounds.h);
+  glyph.offset = Point(bounds.x, entry.ascent + bounds.y);
+  glyph.advance = advance;
+  return true;
+}
@@ -9,6 +9,7 @@
 #include "Wg/ImageList.hpp"
 #include "Wg/Debug.hpp"
 #include "Wg/Font.hpp"
+#include "Wg/GlyphCache.hpp"
 #include "Wg/Rect.hpp"
 #include "Wg/Point.hpp"
 #include "Wg/Size.hpp"
@@ -18,6 +19,7 @@
 #include "Wg/Pen.hpp"
 #include "Wg/Brush.hpp"
 #include "Wg/GraphicsPath.hpp"
+#include "Wg/PathRasterizer.hpp"
 #include "Wg/Win32.hpp"
 
 #include <cmath>
@@ -198,6 +200,22 @@ bool Graphics::isVisible(const Rect& rc)
   return RectVisible(m_handle, &rc2) != FALSE;
 }
 
+// Returns true if DrawText with these flags draws the string in one
+// line without changing its characters (no '&' prefixes, tabs or line
+// breaks), so the glyph advances of a GlyphCache give the same result
+static bool is_plain_text(const String& str, int flags)
+{
+  if ((flags & ~(DT_WORDBREAK | DT_NOPREFIX | DT_SINGLELINE | DT_NOCLIP)) != 0)
+    return false;
+
+  for (Char chr : str) {
+    if (chr == L'\n' || chr == L'\r' || chr == L'\t' ||
+        (chr == L'&' && (flags & DT_NOPREFIX) == 0))
+      return false;
+  }
+  return true;
+}
+
 Font Graphics::getFont() const
 {
   return m_font;
@@ -208,6 +226,26 @@ void Graphics::setFont(const Font& font)
   m_font = font;
 }
 
+GlyphCache* Graphics::getGlyphCache() const
+{
+  return m_glyphCache;
+}
+
+/**
+   Sets the cache used to draw and measure the text, or nullptr to use
+   GDI (the default).
+
+   With a cache, #drawString and #measureString use the glyphs already
+   rasterized by the @a glyphCache (e.g. GlyphCache#getInstance) for
+   plain single-line text. The text is anti-aliased in gray levels
+   (not with ClearType). Text with line breaks, tabs, '&' prefixes or
+   alignment flags is still drawn by GDI.
+*/
+void Graphics::setGlyphCache(GlyphCache* glyphCache)
+{
+  m_glyphCache = glyphCache;
+}
+
 void Graphics::getFontMetrics(FontMetrics& fontMetrics)
 {
   HGDIOBJ oldFont = SelectObject(m_handle, reinterpret_cast<HGDIOBJ>(m_font.getHandle()));
@@ -430,6 +468,44 @@ void Graphics::strokeAndFillPath(const GraphicsPath& path, const Pen& pen, const
   strokeAndFillPath(pen, brush);
 }
 
+/**
+   Draws the outline of the @a path (moved to @a pt) with anti-aliased
+   edges, instead of GDI (see #strokePath). The cells of the stroke are
+   cached in the path (see GraphicsPath#getStrokeRasterizer), so a path
+   that is drawn each time with the same pen is rasterized just once,
+   but each call composes the pixels with @msdn{AlphaBlend}.
+
+   Pens with other style than PenStyle::Solid are drawn by GDI.
+*/
+void Graphics::strokePathAA(const GraphicsPath& path, const Pen& pen, const Point& pt)
+{
+  if (pen.getStyle() != PenStyle::Solid) {
+    strokePath(path, pen, pt);
+    return;
+  }
+
+  const PathRasterizer& ras =
+    path.getStrokeRasterizer(pen.getWidth(), pen.getJoin(), pen.getEndCap(), getMiterLimit());
+  blendRasterizer(ras, pen.getColor(), FillRule::Winding, pt);
+}
+
+/**
+   Fills the interior of the @a path (moved to @a pt) with anti-aliased
+   edges using the current fill rule (see #setFillRule), instead of GDI
+   (see #fillPath). The cells of the path are cached (see
+   GraphicsPath#getFillRasterizer).
+*/
+void Graphics::fillPathAA(const GraphicsPath& path, const Brush& brush, const Point& pt)
+{
+  blendRasterizer(path.getFillRasterizer(), brush.getColor(), m_fillRule, pt);
+}
+
+void Graphics::strokeAndFillPathAA(const GraphicsPath& path, const Pen& pen, const Brush& brush, const Point& pt)
+{
+  fillPathAA(path, brush, pt);
+  strokePathAA(path, pen, pt);
+}
+
 void Graphics::drawString(const String& str, const Color& color, const Point& pt)
 {
   drawString(str, color, pt.x, pt.y);
@@ -439,6 +515,11 @@ void Graphics::drawString(const String& str, const Color& color, int x, int y)
 {
   assert(m_handle);
 
+  if (m_glyphCache != nullptr && is_plain_text(str, 0)) {
+    drawCachedString(str, color, Point(x, y), getClipBounds());
+    return;
+  }
+
   int oldMode = SetBkMode(m_handle, TRANSPARENT);
   int oldColor = SetTextColor(m_handle, convert_to<COLORREF>(color));
 
@@ -454,6 +535,14 @@ void Graphics::drawString(const String& str, const Color& color, const Rect& _rc
 {
   assert(m_handle);
 
+  // a single line that fits in the rectangle is not broken by DrawText
+  if (m_glyphCache != nullptr && is_plain_text(str, flags) &&
+      m_glyphCache->measureString(m_font, str).w <= _rc.w) {
+    drawCachedString(str, color, _rc.getOrigin(),
+                     (flags & DT_NOCLIP) ? getClipBounds(): _rc);
+    return;
+  }
+
   int oldMode = SetBkMode(m_handle, TRANSPARENT);
   int oldColor = SetTextColor(m_handle, convert_to<COLORREF>(color));
 
@@ -589,6 +678,126 @@ void Graphics::drawImageList(ImageList& imageList, int imageIndex, const Point&
   drawImageList(imageList, imageIndex, pt.x, pt.y, style);
 }
 
+/**
+   Draws a batch of images of the atlas using only one blit.
+
+   All the @a items are composed in memory (see ImageAtlas#drawImages)
+   and the result is copied to the device with alpha blending. Only the
+   part of the items that intersects the clipping bounds is composed.
+
+   @param atlas
+       Atlas where the images are packed.
+
+   @param items
+       Index of each image in the atlas and where it must be drawn.
+
+   @win32
+     It uses a 32-bit @msdn{CreateDIBSection} and @msdn{AlphaBlend}.
+   @endwin32
+*/
+void Graphics::drawImageAtlas(const ImageAtlas& atlas, const std::vector<ImageAtlas::Item>& items)
+{
+  assert(m_handle);
+
+  Rect bounds = atlas.getItemsBounds(items).createIntersect(getClipBounds());
+  if (bounds.isEmpty())
+    return;
+
+  ImagePixels batch(bounds.getSize());
+  atlas.drawImages(batch, items, bounds.getOrigin());
+
+  blendPixels(batch, bounds);
+}
+
+/**
+   Composes the @a pixels (straight alpha) in the @a bounds of the
+   device.
+
+   @internal
+*/
+void Graphics::blendPixels(const ImagePixels& pixels, const Rect& bounds)
+{
+  BITMAPINFO bmi;
+  ZeroMemory(&bmi, sizeof(bmi));
+  bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+  bmi.bmiHeader.biWidth = bounds.w;
+  bmi.bmiHeader.biHeight = -bounds.h; // top-down scanlines (like ImagePixels)
+  bmi.bmiHeader.biPlanes = 1;
+  bmi.bmiHeader.biBitCount = 32;
+  bmi.bmiHeader.biCompression = BI_RGB;
+
+  void* bits = nullptr;
+  HDC hdc = CreateCompatibleDC(m_handle);
+  HBITMAP hbitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, &bits, nullptr, 0);
+  if (hbitmap == nullptr) {
+    DeleteDC(hdc);
+    return;
+  }
+
+  // AlphaBlend needs premultiplied alpha
+  auto dst = reinterpret_cast<ImagePixels::pixel_type*>(bits);
+  for (int i=0, n=bounds.w*bounds.h; i<n; ++i) {
+    ImagePixels::pixel_type c = pixels[i];
+    int a = ImagePixels::getA(c);
+    dst[i] = ImagePixels::makePixel(ImagePixels::getR(c) * a / 255,
+                                    ImagePixels::getG(c) * a / 255,
+                                    ImagePixels::getB(c) * a / 255, a);
+  }
+
+  BLENDFUNCTION bf;
+  bf.BlendOp = AC_SRC_OVER;
+  bf.BlendFlags = 0;
+  bf.SourceConstantAlpha = 255;
+  bf.AlphaFormat = AC_SRC_ALPHA;
+
+  HGDIOBJ oldBitmap = SelectObject(hdc, hbitmap);
+  AlphaBlend(m_handle, bounds.x, bounds.y, bounds.w, bounds.h,
+             hdc, 0, 0, bounds.w, bounds.h, bf);
+  SelectObject(hdc, oldBitmap);
+
+  DeleteObject(hbitmap);
+  DeleteDC(hdc);
+}
+
+/**
+   Composes the coverage of the @a ras cells (moved to @a pt) filled
+   with the @a color.
+
+   @internal
+*/
+void Graphics::blendRasterizer(const PathRasterizer& ras, const Color& color,
+                               FillRule fillRule, const Point& pt)
+{
+  Rect bounds = ras.getBounds().offset(pt).createIntersect(getClipBounds());
+  if (bounds.isEmpty())
+    return;
+
+  ImagePixels pixels(bounds.getSize());
+  ras.fill(pixels, color, fillRule, pt - bounds.getOrigin());
+
+  blendPixels(pixels, bounds);
+}
+
+/**
+   Draws a text with the glyphs of the GlyphCache, using the same
+   composition of #drawImageAtlas.
+
+   @internal
+*/
+void Graphics::drawCachedString(const String& str, const Color& color, const Point& pt, const Rect& clip)
+{
+  Rect bounds = Rect(pt, m_glyphCache->measureString(m_font, str))
+    .createIntersect(clip)
+    .createIntersect(getClipBounds());
+  if (bounds.isEmpty())
+    return;
+
+  ImagePixels pixels(bounds.getSize());
+  m_glyphCache->drawString(pixels, m_font, str, color, pt - bounds.getOrigin());
+
+  blendPixels(pixels, bounds);
+}
+
 void Graphics::drawLine(const Pen& pen, const Point& pt1, const Point& pt2)
 {
   drawLine(pen, pt1.x, pt1.y, pt2.x, pt2.y);
@@ -1076,6 +1285,12 @@ Size Graphics::measureString(const String& str, int fitInWidth, int flags)
 {
   assert(m_handle);
 
+  if (m_glyphCache != nullptr && !str.empty() && is_plain_text(str, flags)) {
+    Size sz = m_glyphCache->measureString(m_font, str);
+    if (sz.w <= fitInWidth || (flags & DT_WORDBREAK) == 0)
+      return sz;
+  }
+
   RECT rc = { 0, 0, fitInWidth, 0 };
   HGDIOBJ oldFont = SelectObject(m_handle, reinterpret_cast<HGDIOBJ>(m_font.getHandle()));
 
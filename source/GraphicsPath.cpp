@@ -5,15 +5,65 @@
 // please read LICENSE.txt for more information.
 
 #include "Wg/GraphicsPath.hpp"
+#include "Wg/PathRasterizer.hpp"
 #include "Wg/Point.hpp"
+
+#ifdef VACA_ON_WINDOWS
 #include "Wg/Region.hpp"
 #include "Wg/Pen.hpp"
 #include "Wg/Brush.hpp"
 #include "Wg/Graphics.hpp"
 #include "Wg/Win32.hpp"
+#endif
+
+#include <algorithm>
+#include <cmath>
 
 using namespace Wg;
 
+// Maximum number of subdivisions of a bezier curve
+static const int max_bezier_depth = 16;
+
+// Adds to "vertices" the lines of the cubic bezier curve from p0 to p3
+// (without the p0 point), subdividing it until each piece is at most
+// "tolerance" pixels away from its chord.
+static void flatten_bezier(std::vector<GraphicsPath::Vertex>& vertices,
+                           const GraphicsPath::Vertex& p0,
+                           const GraphicsPath::Vertex& p1,
+                           const GraphicsPath::Vertex& p2,
+                           const GraphicsPath::Vertex& p3,
+                           double tolerance, int depth)
+{
+  double dx = p3.x - p0.x;
+  double dy = p3.y - p0.y;
+  double d1 = std::fabs((p1.x - p3.x) * dy - (p1.y - p3.y) * dx);
+  double d2 = std::fabs((p2.x - p3.x) * dy - (p2.y - p3.y) * dx);
+  double chord = dx*dx + dy*dy;
+  bool flat;
+
+  if (chord > 0.0)
+    flat = (d1 + d2) * (d1 + d2) <= tolerance * tolerance * chord;
+  else
+    flat = (std::fabs(p1.x - p0.x) + std::fabs(p1.y - p0.y) +
+            std::fabs(p2.x - p0.x) + std::fabs(p2.y - p0.y)) <= tolerance;
+
+  if (flat || depth >= max_bezier_depth) {
+    vertices.push_back(p3);
+    return;
+  }
+
+  // de Casteljau subdivision at t=0.5
+  GraphicsPath::Vertex p01 = { (p0.x+p1.x)/2, (p0.y+p1.y)/2 };
+  GraphicsPath::Vertex p12 = { (p1.x+p2.x)/2, (p1.y+p2.y)/2 };
+  GraphicsPath::Vertex p23 = { (p2.x+p3.x)/2, (p2.y+p3.y)/2 };
+  GraphicsPath::Vertex p012 = { (p01.x+p12.x)/2, (p01.y+p12.y)/2 };
+  GraphicsPath::Vertex p123 = { (p12.x+p23.x)/2, (p12.y+p23.y)/2 };
+  GraphicsPath::Vertex mid = { (p012.x+p123.x)/2, (p012.y+p123.y)/2 };
+
+  flatten_bezier(vertices, p0, p01, p012, mid, tolerance, depth+1);
+  flatten_bezier(vertices, mid, p123, p23, p3, tolerance, depth+1);
+}
+
 // ======================================================================
 //
 
@@ -51,22 +101,84 @@ const Point& GraphicsPath::Node::getPoint() const
   return m_point;
 }
 
+// ======================================================================
+// GraphicsPath::Cache
+
+/**
+   Geometry calculated from the nodes of a GraphicsPath.
+
+   @internal
+*/
+class GraphicsPath::Cache : public Referenceable
+{
+public:
+  std::vector<Figure> figures;
+  double figuresTolerance;
+
+  PathRasterizer fill;
+  double fillTolerance;
+
+  PathRasterizer stroke;
+  double strokeTolerance;
+  double strokeWidth;
+  double strokeMiterLimit;
+  PenJoin strokeJoin;
+  PenEndCap strokeEndCap;
+
+  Cache()
+    : figuresTolerance(-1.0)
+    , fillTolerance(-1.0)
+    , strokeTolerance(-1.0)
+    , strokeWidth(0.0)
+    , strokeMiterLimit(0.0)
+  {
+  }
+};
+
 // ======================================================================
 // GraphicsPath
 
 GraphicsPath::GraphicsPath()
-= default;
+  : m_cacheHits(0)
+  , m_cacheMisses(0)
+{
+}
+
+/**
+   Copies the nodes of the path. The new path shares the cache of
+   @a path until one of them is modified.
+*/
+GraphicsPath::GraphicsPath(const GraphicsPath& path)
+  : m_nodes(path.m_nodes)
+  , m_cache(path.m_cache)
+  , m_cacheHits(0)
+  , m_cacheMisses(0)
+{
+}
 
 GraphicsPath::~GraphicsPath()
 = default;
 
+GraphicsPath& GraphicsPath::operator=(const GraphicsPath& path)
+{
+  m_nodes = path.m_nodes;
+  m_cache = path.m_cache;
+  return *this;
+}
+
+/**
+   Returns an iterator to modify the nodes, so the cache of the path
+   is discarded.
+*/
 GraphicsPath::iterator GraphicsPath::begin()
 {
+  invalidateCache();
   return m_nodes.begin();
 }
 
 GraphicsPath::iterator GraphicsPath::end()
 {
+  invalidateCache();
   return m_nodes.end();
 }
 
@@ -83,6 +195,7 @@ GraphicsPath::const_iterator GraphicsPath::end() const
 void GraphicsPath::clear()
 {
   m_nodes.clear();
+  invalidateCache();
 }
 
 bool GraphicsPath::empty() const
@@ -111,8 +224,10 @@ GraphicsPath& GraphicsPath::offset(const Point& point)
 
 GraphicsPath& GraphicsPath::moveTo(const Point& pt)
 {
-  if (!m_nodes.empty() && m_nodes.back().getType() == GraphicsPath::MoveTo)
+  if (!m_nodes.empty() && m_nodes.back().getType() == GraphicsPath::MoveTo) {
     m_nodes.back().m_point = pt;
+    invalidateCache();
+  }
   else
     addNode(GraphicsPath::MoveTo, pt);
   return *this;
@@ -152,11 +267,15 @@ GraphicsPath& GraphicsPath::curveTo(int x1, int y1, int x2, int y2, int x3, int
 
 GraphicsPath& GraphicsPath::closeFigure()
 {
-  if (!m_nodes.empty())
+  if (!m_nodes.empty()) {
     m_nodes.back().m_flags |= GraphicsPath::CloseFigure;
+    invalidateCache();
+  }
   return *this;
 }
 
+#ifdef VACA_ON_WINDOWS
+
 GraphicsPath& GraphicsPath::flatten()
 {
   ScreenGraphics g;
@@ -166,6 +285,195 @@ GraphicsPath& GraphicsPath::flatten()
   return *this;
 }
 
+#endif
+
+/**
+   Converts the path to a set of polylines without using the system
+   (the bezier curves are subdivided adaptively: more lines where they
+   bend more).
+
+   @param figures
+     Filled with one Figure for each MoveTo node of the path.
+
+   @param tolerance
+     Maximum distance (in pixels) between the curves and the lines
+     that approximate them.
+
+   @see PathRasterizer
+*/
+void GraphicsPath::flatten(std::vector<Figure>& figures, double tolerance) const
+{
+  figures = getFigures(tolerance);
+}
+
+/**
+   Returns the figures of the path flattened with the specified
+   tolerance (see #flatten). They are calculated only the first time,
+   or when the path or the tolerance change.
+*/
+const std::vector<GraphicsPath::Figure>& GraphicsPath::getFigures(double tolerance) const
+{
+  if (getCache().figuresTolerance == tolerance)
+    ++m_cacheHits;
+  else
+    ++m_cacheMisses;
+
+  return updateFigures(tolerance);
+}
+
+/**
+   Returns the cached figures (flattening the path again if the
+   @a tolerance changed) without counting a hit or a miss, so the
+   rasterizers calculated by #getFillRasterizer and
+   #getStrokeRasterizer count just one access.
+
+   @internal
+*/
+const std::vector<GraphicsPath::Figure>& GraphicsPath::updateFigures(double tolerance) const
+{
+  Cache& cache = getCache();
+
+  if (cache.figuresTolerance == tolerance)
+    return cache.figures;
+
+  std::vector<Figure>& figures = cache.figures;
+  figures.clear();
+
+  Vertex control[2] = { { 0, 0 }, { 0, 0 } };
+  Vertex current = { 0, 0 };
+
+  for (const auto& node : m_nodes) {
+    Vertex pt = { static_cast<double>(node.getPoint().x),
+                  static_cast<double>(node.getPoint().y) };
+
+    switch (node.getType()) {
+
+      case MoveTo:
+        figures.push_back(Figure{ std::vector<Vertex>(1, pt), false });
+        break;
+
+      case LineTo:
+        if (figures.empty())
+          figures.push_back(Figure{ std::vector<Vertex>(1, current), false });
+        figures.back().vertices.push_back(pt);
+        break;
+
+      case BezierControl1:
+        control[0] = pt;
+        break;
+
+      case BezierControl2:
+        control[1] = pt;
+        break;
+
+      case BezierTo:
+        if (figures.empty())
+          figures.push_back(Figure{ std::vector<Vertex>(1, current), false });
+        flatten_bezier(figures.back().vertices, current,
+                       control[0], control[1], pt, tolerance, 0);
+        break;
+    }
+
+    current = pt;
+
+    if (node.isCloseFigure() && !figures.empty()) {
+      figures.back().closed = true;
+
+      // The next lines start from the beginning of the figure
+      current = figures.back().vertices.front();
+      figures.push_back(Figure{ std::vector<Vertex>(1, current), false });
+    }
+  }
+
+  // Remove figures without lines
+  figures.erase(std::remove_if(figures.begin(), figures.end(),
+                               [](const Figure& figure) {
+                                 return figure.vertices.size() < 2;
+                               }),
+                figures.end());
+
+  cache.figuresTolerance = tolerance;
+  return figures;
+}
+
+/**
+   Returns the cells to fill the interior of the path. Use
+   PathRasterizer#fill with an offset to draw the path in different
+   positions without rasterizing it again.
+
+   @see PathRasterizer#addPath, Graphics#fillPathAA
+*/
+const PathRasterizer& GraphicsPath::getFillRasterizer(double tolerance) const
+{
+  Cache& cache = getCache();
+
+  if (cache.fillTolerance == tolerance) {
+    ++m_cacheHits;
+    return cache.fill;
+  }
+  ++m_cacheMisses;
+
+  cache.fill.reset();
+  cache.fill.setTolerance(tolerance);
+  cache.fill.addPath(*this);
+  cache.fillTolerance = tolerance;
+  return cache.fill;
+}
+
+/**
+   Returns the cells to draw the outline of the path. They are
+   calculated again only if the path or the stroke parameters change.
+
+   @see PathRasterizer#addStroke, Graphics#strokePathAA
+*/
+const PathRasterizer& GraphicsPath::getStrokeRasterizer(double width, PenJoin join, PenEndCap endCap,
+                                                        double miterLimit, double tolerance) const
+{
+  Cache& cache = getCache();
+
+  if (cache.strokeTolerance == tolerance &&
+      cache.strokeWidth == width &&
+      cache.strokeMiterLimit == miterLimit &&
+      cache.strokeJoin == join &&
+      cache.strokeEndCap == endCap) {
+    ++m_cacheHits;
+    return cache.stroke;
+  }
+  ++m_cacheMisses;
+
+  cache.stroke.reset();
+  cache.stroke.setTolerance(tolerance);
+  cache.stroke.addStroke(*this, width, join, endCap, miterLimit);
+  cache.strokeTolerance = tolerance;
+  cache.strokeWidth = width;
+  cache.strokeMiterLimit = miterLimit;
+  cache.strokeJoin = join;
+  cache.strokeEndCap = endCap;
+  return cache.stroke;
+}
+
+/**
+   Returns how many times the cached geometry was reused.
+*/
+unsigned GraphicsPath::getCacheHits() const
+{
+  return m_cacheHits;
+}
+
+/**
+   Returns how many times the geometry had to be calculated because it
+   was not in the cache.
+*/
+unsigned GraphicsPath::getCacheMisses() const
+{
+  return m_cacheMisses;
+}
+
+// ======================================================================
+// The following member functions use GDI paths
+
+#ifdef VACA_ON_WINDOWS
+
 GraphicsPath& GraphicsPath::widen(const Pen& pen)
 {
   ScreenGraphics g;
@@ -187,7 +495,32 @@ Region GraphicsPath::toRegion() const
   return g.getRegionFromPath();
 }
 
+#endif
+
 void GraphicsPath::addNode(int type, const Point& pt)
 {
   m_nodes.emplace_back(type, pt);
+  invalidateCache();
+}
+
+/**
+   Discards the cached geometry. If the cache is shared with a copy of
+   the path, the copy keeps it.
+
+   @internal
+*/
+void GraphicsPath::invalidateCache()
+{
+  m_cache.reset();
+}
+
+/**
+   @internal
+*/
+GraphicsPath::Cache& GraphicsPath::getCache() const
+{
+  if (!m_cache)
+    m_cache.reset(new Cache);
+
+  return *m_cache;
 }
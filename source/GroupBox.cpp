@@ -5,6 +5,7 @@
 // please read LICENSE.txt for more information.
 
 #include "Wg/GroupBox.hpp"
+#include "Wg/MessageMap.hpp"
 #include "Wg/Point.hpp"
 #include "Wg/Brush.hpp"
 #include "Wg/WidgetClass.hpp"
@@ -17,6 +18,7 @@ GroupBox::GroupBox(const String& text, Widget* parent, const Style& style)
   : Widget(WidgetClassName(WC_BUTTON), parent, style)
 {
   setText(text);
+  setMessageMap(getBaseMessageMap());
 }
 
 GroupBox::~GroupBox()
@@ -75,3 +77,19 @@ bool GroupBox::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lRes
   
   return Widget::wndProc(message, wParam, lParam, lResult);
 }
+
+/**
+   Returns the map with the messages that GroupBox#wndProc handles (and
+   the ones of Widget). It is the base map for the maps of the classes
+   derived from GroupBox.
+
+   @see MessageMap, Widget#setMessageMap
+*/
+const MessageMap& GroupBox::getBaseMessageMap()
+{
+  // the same messages of the switch in wndProc
+  static const MessageMap map(typeid(GroupBox), Widget::getBaseMessageMap(), {
+      MessageMap::forward(WM_ERASEBKGND),
+    });
+  return map;
+}
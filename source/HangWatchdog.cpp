@@ -0,0 +1,345 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/HangWatchdog.hpp"
+#include "Wg/Clock.hpp"
+#include "Wg/Debug.hpp"
+#include "Wg/ScopedLock.hpp"
+#include "Wg/Thread.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace Wg;
+
+// Longest time between two checks of the watchdog thread (it is
+// shorter for small thresholds)
+#define MAX_CHECK_INTERVAL std::chrono::milliseconds(100)
+
+// Watchdog of the current thread (see HangWatchdog::attach)
+static thread_local HangWatchdog* current_watchdog = nullptr;
+
+static HangWatchdog::Nanoseconds get_current_time()
+{
+  return Clock::getCurrent().now();
+}
+
+static inline double to_msecs(StallReport::Nanoseconds time)
+{
+  return static_cast<double>(time.count()) / 1000000.0;
+}
+
+// Escapes the characters of "str" that cannot be in a JSON string
+static std::string escape_json(const std::string& str)
+{
+  std::string result;
+  for (char chr : str) {
+    if (chr == '"' || chr == '\\')
+      result.push_back('\\');
+    if (static_cast<unsigned char>(chr) >= 32)
+      result.push_back(chr);
+  }
+  return result;
+}
+
+/**
+   Returns the report as a JSON object (times in milliseconds).
+*/
+std::string StallReport::getJson() const
+{
+  std::string out;
+  char buf[256];
+
+  std::snprintf(buf, sizeof(buf),
+                "{\"duration_ms\":%.3f,\"idle_before_ms\":%.3f,\"message_count\":%llu,\"frames\":[",
+                to_msecs(duration), to_msecs(idleBefore), messageCount);
+  out += buf;
+
+  for (std::size_t i=0; i<frames.size(); ++i) {
+    const Frame& frame = frames[i];
+
+    std::snprintf(buf, sizeof(buf),
+                  "%s{\"message\":%u,\"wparam\":%llu,\"lparam\":%lld,\"widget\":\"%p\",\"class\":\"",
+                  i > 0 ? ",": "",
+                  frame.message,
+                  static_cast<unsigned long long>(frame.wParam),
+                  static_cast<long long>(frame.lParam),
+                  frame.widget);
+    out += buf;
+    out += escape_json(frame.className);
+    std::snprintf(buf, sizeof(buf), "\",\"elapsed_ms\":%.3f,\"self_ms\":%.3f}",
+                  to_msecs(frame.elapsed), to_msecs(frame.self));
+    out += buf;
+  }
+
+  out += "]}";
+  return out;
+}
+
+// ======================================================================
+
+/**
+   Starts the processing of a message for the watchdog of the current
+   thread.
+*/
+HangWatchdog::Scope::Scope(unsigned message, std::uintptr_t wParam, std::intptr_t lParam,
+                           const void* widget, const std::type_info* type)
+  : m_watchdog(current_watchdog)
+{
+  if (m_watchdog != nullptr)
+    m_watchdog->beginMessage(message, wParam, lParam, widget, type);
+}
+
+HangWatchdog::Scope::~Scope()
+{
+  if (m_watchdog != nullptr)
+    m_watchdog->endMessage();
+}
+
+// ======================================================================
+
+/**
+   Creates a watchdog that uses the current Clock (see Clock#getCurrent).
+*/
+HangWatchdog::HangWatchdog()
+  : HangWatchdog(get_current_time)
+{
+}
+
+/**
+   Creates a watchdog that uses the specified @a clock (e.g. a
+   simulated time to check the watchdog calling #check).
+*/
+HangWatchdog::HangWatchdog(const ClockFunction& clock)
+  : m_clock(clock)
+  , m_threshold(std::chrono::seconds(5))
+  , m_lastBeat(clock())
+  , m_idleBefore(0)
+  , m_messageCount(0)
+  , m_sequence(0)
+  , m_reportedSequence(0)
+  , m_stallCount(0)
+  , m_thread(nullptr)
+  , m_stop(false)
+{
+  m_frames.reserve(16);
+}
+
+/**
+   Stops the watchdog thread. If the watchdog is attached to the
+   current thread, it is detached.
+*/
+HangWatchdog::~HangWatchdog()
+{
+  stop();
+
+  if (current_watchdog == this)
+    current_watchdog = nullptr;
+}
+
+/**
+   Watches the messages processed by the current thread (see
+   HangWatchdog::Scope). A thread can have only one watchdog.
+
+   @warning
+     The watchdog must be detached (or destroyed) from the same thread.
+*/
+void HangWatchdog::attach()
+{
+  current_watchdog = this;
+
+  ScopedLock hold(m_mutex);
+  m_lastBeat = m_clock();
+}
+
+void HangWatchdog::detach()
+{
+  if (current_watchdog == this)
+    current_watchdog = nullptr;
+}
+
+/**
+   Returns the watchdog attached to the current thread (or nullptr).
+*/
+HangWatchdog* HangWatchdog::getCurrent()
+{
+  return current_watchdog;
+}
+
+/**
+   Starts the thread that checks the messages periodically.
+
+   @param threshold
+     Time that a message can take before it is reported as a stall.
+*/
+void HangWatchdog::start(Nanoseconds threshold)
+{
+  assert(!isRunning());
+
+  setThreshold(threshold);
+  m_stop = false;
+  m_thread = new Thread([this] { run(); });
+}
+
+/**
+   Stops the thread that checks the messages (it waits it).
+*/
+void HangWatchdog::stop()
+{
+  if (m_thread == nullptr)
+    return;
+
+  {
+    ScopedLock hold(m_mutex);
+    m_stop = true;
+  }
+  m_wakeUp.notifyOne();
+  m_thread->join();
+
+  delete m_thread;
+  m_thread = nullptr;
+}
+
+bool HangWatchdog::isRunning() const
+{
+  return m_thread != nullptr;
+}
+
+HangWatchdog::Nanoseconds HangWatchdog::getThreshold() const
+{
+  ScopedLock hold(m_mutex);
+  return m_threshold;
+}
+
+void HangWatchdog::setThreshold(Nanoseconds threshold)
+{
+  ScopedLock hold(m_mutex);
+  m_threshold = threshold;
+}
+
+/**
+   Returns the number of stalls reported since the watchdog was
+   created.
+*/
+unsigned long long HangWatchdog::getStallCount()
+{
+  ScopedLock hold(m_mutex);
+  return m_stallCount;
+}
+
+/**
+   Notifies that the watched thread starts to process a message. It can
+   be called again (for nested messages) before #endMessage.
+*/
+void HangWatchdog::beginMessage(unsigned message, std::uintptr_t wParam, std::intptr_t lParam,
+                                const void* widget, const std::type_info* type)
+{
+  Nanoseconds now = m_clock();
+
+  ScopedLock hold(m_mutex);
+  if (m_frames.empty()) {
+    m_idleBefore = now - m_lastBeat;
+    ++m_sequence;
+  }
+  m_frames.push_back(Frame{ message, wParam, lParam, widget, type, now });
+}
+
+/**
+   Notifies that the last message given to #beginMessage was processed
+   (the heartbeat of the thread).
+*/
+void HangWatchdog::endMessage()
+{
+  Nanoseconds now = m_clock();
+
+  ScopedLock hold(m_mutex);
+  assert(!m_frames.empty());
+
+  m_frames.pop_back();
+  if (m_frames.empty())
+    ++m_messageCount;
+  m_lastBeat = now;
+}
+
+/**
+   Checks if the current message exceeded the threshold, in that case
+   it generates the #onStall event. It is called periodically by the
+   thread of the watchdog (see #start).
+
+   @return
+     True if a new stall was reported.
+*/
+bool HangWatchdog::check()
+{
+  StallReport report;
+  Nanoseconds now = m_clock();
+
+  {
+    ScopedLock hold(m_mutex);
+
+    if (m_frames.empty() ||
+        m_reportedSequence == m_sequence ||
+        now - m_frames.front().start < m_threshold)
+      return false;
+
+    m_reportedSequence = m_sequence;
+    ++m_stallCount;
+
+    report.duration = now - m_frames.front().start;
+    report.idleBefore = m_idleBefore;
+    report.messageCount = m_messageCount;
+
+    for (std::size_t i=0; i<m_frames.size(); ++i) {
+      const Frame& frame = m_frames[i];
+      StallReport::Frame info;
+
+      info.message = frame.message;
+      info.wParam = frame.wParam;
+      info.lParam = frame.lParam;
+      info.widget = frame.widget;
+      if (frame.type != nullptr)
+        info.className = frame.type->name();
+      info.elapsed = now - frame.start;
+      info.self = info.elapsed;
+      if (i+1 < m_frames.size())
+        info.self -= now - m_frames[i+1].start;
+
+      report.frames.push_back(info);
+    }
+  }
+
+  onStall(report);
+  return true;
+}
+
+/**
+   Called from the thread of the watchdog when a stall is detected. By
+   default it fires the #Stall signal.
+*/
+void HangWatchdog::onStall(const StallReport& report)
+{
+  Stall(report);
+}
+
+void HangWatchdog::run()
+{
+  for (;;) {
+    {
+      ScopedLock hold(m_mutex);
+
+      Nanoseconds interval =
+        std::max<Nanoseconds>(std::min<Nanoseconds>(m_threshold / 4, MAX_CHECK_INTERVAL),
+                              std::chrono::milliseconds(1));
+
+      m_wakeUp.waitFor(hold, std::chrono::duration<double>(interval).count(),
+                       [this]{ return m_stop; });
+      if (m_stop)
+        break;
+    }
+
+    check();
+  }
+}
@@ -0,0 +1,222 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/ImageAtlas.hpp"
+#include "Wg/Color.hpp"
+
+using namespace Wg;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+/**
+   Creates an empty atlas.
+
+   @param sz
+     Size of the pixels where all images will be packed.
+
+   @param padding
+     Transparent pixels to leave around each image, so they do not
+     bleed into each other when they are scaled.
+*/
+ImageAtlas::ImageAtlas(const Size& sz, int padding)
+  : m_pixels(sz)
+  , m_packer(sz)
+  , m_padding(padding)
+  , m_version(0)
+{
+  assert(padding >= 0);
+}
+
+ImageAtlas::~ImageAtlas()
+= default;
+
+Size ImageAtlas::getSize() const
+{
+  return m_pixels.getSize();
+}
+
+int ImageAtlas::getImageCount() const
+{
+  return static_cast<int>(m_bounds.size());
+}
+
+/**
+   Returns the area that the image @a index occupies inside #getPixels.
+*/
+Rect ImageAtlas::getImageBounds(int index) const
+{
+  assert(index >= 0 && index < getImageCount());
+  return m_bounds[index];
+}
+
+/**
+   Returns the fraction of the atlas that is being used by images.
+
+   @see SkylinePacker#getOccupancy
+*/
+double ImageAtlas::getOccupancy() const
+{
+  return m_packer.getOccupancy();
+}
+
+/**
+   Returns a number that changes each time the pixels of the atlas are
+   modified, so cached copies of #getPixels (e.g. in video memory) can
+   know when they are outdated.
+*/
+unsigned ImageAtlas::getVersion() const
+{
+  return m_version;
+}
+
+const ImagePixels& ImageAtlas::getPixels() const
+{
+  return m_pixels;
+}
+
+/**
+   Packs a copy of the specified pixels in the atlas.
+
+   The alpha channel of @a pixels is used as is.
+
+   @return
+     The index of the new image, or -1 if there is no room left in
+     the atlas.
+*/
+int ImageAtlas::addImage(const ImagePixels& pixels)
+{
+  return addImage(pixels, false, 0);
+}
+
+/**
+   Packs a copy of the specified pixels in the atlas, converting each
+   pixel equal to @a maskColor to transparent and the rest to opaque
+   (like ImageList does with its mask color).
+
+   Use this with pixels obtained from Image#getPixels, because device
+   dependent bitmaps do not have a valid alpha channel.
+
+   @return
+     The index of the new image, or -1 if there is no room left in
+     the atlas.
+*/
+int ImageAtlas::addImage(const ImagePixels& pixels, const Color& maskColor)
+{
+  return addImage(pixels, true,
+                  ImagePixels::makePixel(maskColor.getR(),
+                                         maskColor.getG(),
+                                         maskColor.getB(), 0));
+}
+
+/**
+   Removes all images from the atlas. All indexes returned by
+   #addImage are invalid after this call.
+*/
+void ImageAtlas::removeAllImages()
+{
+  m_packer.clear();
+  m_bounds.clear();
+
+  for (int i=0, n=m_pixels.getScanlineSize()*m_pixels.getHeight(); i<n; ++i)
+    m_pixels[i] = 0;
+
+  ++m_version;
+}
+
+/**
+   Returns the smallest rectangle that contains all the @a items.
+*/
+Rect ImageAtlas::getItemsBounds(const std::vector<Item>& items) const
+{
+  Rect bounds;
+
+  for (const auto& item : items) {
+    Rect rc(item.point, getImageBounds(item.index).getSize());
+    bounds = bounds.isEmpty() ? rc: bounds.createUnion(rc);
+  }
+
+  return bounds;
+}
+
+/**
+   Composes the @a items over @a dst.
+
+   @param dst
+     Destination pixels.
+
+   @param items
+     Images to draw and their positions.
+
+   @param origin
+     Position of the upper-left corner of @a dst in the coordinates
+     used by the @a items.
+*/
+void ImageAtlas::drawImages(ImagePixels& dst, const std::vector<Item>& items, const Point& origin) const
+{
+  const int dstW = dst.getWidth();
+  const int dstH = dst.getHeight();
+  const int dstScanline = dst.getScanlineSize();
+  const int srcScanline = m_pixels.getScanlineSize();
+
+  for (const auto& item : items) {
+    const Rect& src = getImageBounds(item.index);
+
+    // Clip the image with the destination
+    int dx = item.point.x - origin.x;
+    int dy = item.point.y - origin.y;
+    int sx = src.x, sy = src.y;
+    int w = src.w, h = src.h;
+
+    if (dx < 0) { sx -= dx; w += dx; dx = 0; }
+    if (dy < 0) { sy -= dy; h += dy; dy = 0; }
+    if (dx + w > dstW) w = dstW - dx;
+    if (dy + h > dstH) h = dstH - dy;
+    if (w <= 0 || h <= 0)
+      continue;
+
+    for (int v=0; v<h; ++v) {
+      const pixel_type* s = &m_pixels[(sy+v)*srcScanline + sx];
+      pixel_type* d = &dst[(dy+v)*dstScanline + dx];
+
+      for (int u=0; u<w; ++u)
+        d[u] = ImagePixels::blendPixel(d[u], s[u]);
+    }
+  }
+}
+
+/**
+   @internal
+*/
+int ImageAtlas::addImage(const ImagePixels& pixels, bool useMask, pixel_type mask)
+{
+  const int w = pixels.getWidth();
+  const int h = pixels.getHeight();
+  Point pt;
+
+  if (!m_packer.insert(Size(w + 2*m_padding, h + 2*m_padding), pt))
+    return -1;
+
+  Rect bounds(pt.x + m_padding, pt.y + m_padding, w, h);
+  const int dstScanline = m_pixels.getScanlineSize();
+  const int srcScanline = pixels.getScanlineSize();
+
+  for (int v=0; v<h; ++v) {
+    const pixel_type* s = &pixels[v*srcScanline];
+    pixel_type* d = &m_pixels[(bounds.y+v)*dstScanline + bounds.x];
+
+    if (useMask) {
+      for (int u=0; u<w; ++u)
+        d[u] = ((s[u] & 0x00ffffff) == mask) ? 0: (s[u] | 0xff000000);
+    }
+    else
+      std::copy(s, s+w, d);
+  }
+
+  m_bounds.push_back(bounds);
+  ++m_version;
+
+  return static_cast<int>(m_bounds.size()) - 1;
+}
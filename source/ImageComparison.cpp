@@ -0,0 +1,432 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/ImageComparison.hpp"
+
+#include <cmath>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define USE_SSE2
+  #include <emmintrin.h>
+#endif
+
+using namespace Wg;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+// Size of the windows where the SSIM is calculated, and the distance
+// between two consecutive windows
+#define SSIM_WINDOW 8
+#define SSIM_STEP   4
+
+// Constants of the SSIM formula for 8-bit channels
+static const double ssim_c1 = (0.01*255) * (0.01*255);
+static const double ssim_c2 = (0.03*255) * (0.03*255);
+
+// Composes a pixel over a white background
+static inline void compose_over_white(pixel_type c, int& r, int& g, int& b)
+{
+  int a = ImagePixels::getA(c);
+  r = (ImagePixels::getR(c) * a + 255 * (255 - a)) / 255;
+  g = (ImagePixels::getG(c) * a + 255 * (255 - a)) / 255;
+  b = (ImagePixels::getB(c) * a + 255 * (255 - a)) / 255;
+}
+
+static inline int get_luma(pixel_type c)
+{
+  int r, g, b;
+  compose_over_white(c, r, g, b);
+  return (r*77 + g*150 + b*29) >> 8;
+}
+
+static inline int get_max_channel_difference(pixel_type a, pixel_type b)
+{
+  int d = 0;
+  for (int k=0; k<32; k+=8)
+    d = max_value(d, std::abs(static_cast<int>((a >> k) & 0xff) - static_cast<int>((b >> k) & 0xff)));
+  return d;
+}
+
+// Table to convert sRGB channels to linear values
+struct LinearTable {
+  double values[256];
+
+  LinearTable() {
+    for (int i=0; i<256; ++i) {
+      double v = i / 255.0;
+      values[i] = (v <= 0.04045 ? v / 12.92: std::pow((v + 0.055) / 1.055, 2.4));
+    }
+  }
+};
+
+// Converts a sRGB color (composed over white) to CIE L*a*b* (D65)
+static void get_lab(pixel_type c, double lab[3])
+{
+  static const LinearTable table;
+  const double* linear = table.values;
+
+  int r, g, b;
+  compose_over_white(c, r, g, b);
+
+  const double xyz[3] = {
+    (0.4124*linear[r] + 0.3576*linear[g] + 0.1805*linear[b]) / 0.95047,
+    (0.2126*linear[r] + 0.7152*linear[g] + 0.0722*linear[b]),
+    (0.0193*linear[r] + 0.1192*linear[g] + 0.9505*linear[b]) / 1.08883
+  };
+  double f[3];
+  for (int i=0; i<3; ++i)
+    f[i] = (xyz[i] > 216.0/24389.0 ? std::cbrt(xyz[i]): (24389.0/27.0 * xyz[i] + 16.0) / 116.0);
+
+  lab[0] = 116.0 * f[1] - 16.0;
+  lab[1] = 500.0 * (f[0] - f[1]);
+  lab[2] = 200.0 * (f[1] - f[2]);
+}
+
+ImageComparison::ImageComparison()
+  : m_tolerance(0.0)
+  , m_threshold(0.99)
+  , m_maxDifferentPixels(0)
+  , m_differentPixels(0)
+  , m_identicalRows(0)
+  , m_maxDifference(0.0)
+  , m_ssim(1.0)
+{
+}
+
+ImageComparison::~ImageComparison()
+= default;
+
+ImageMetric ImageComparison::getMetric() const
+{
+  return m_metric;
+}
+
+void ImageComparison::setMetric(ImageMetric metric)
+{
+  m_metric = metric;
+}
+
+/**
+   Returns how much two pixels can differ to be considered equal: the
+   difference of each channel (0-255) for ImageMetric::Tolerance, or
+   the delta-E for ImageMetric::DeltaE.
+*/
+double ImageComparison::getTolerance() const
+{
+  return m_tolerance;
+}
+
+void ImageComparison::setTolerance(double tolerance)
+{
+  m_tolerance = tolerance;
+}
+
+/**
+   Returns the minimum mean SSIM (from 0 to 1) that two images must
+   have to be equal with ImageMetric::Ssim (0.99 by default).
+*/
+double ImageComparison::getThreshold() const
+{
+  return m_threshold;
+}
+
+void ImageComparison::setThreshold(double threshold)
+{
+  m_threshold = threshold;
+}
+
+/**
+   Returns how many pixels can be different in two images that are
+   considered equal (zero by default). It is not used by
+   ImageMetric::Ssim.
+*/
+int ImageComparison::getMaxDifferentPixels() const
+{
+  return m_maxDifferentPixels;
+}
+
+void ImageComparison::setMaxDifferentPixels(int count)
+{
+  m_maxDifferentPixels = count;
+}
+
+/**
+   Compares two images with the current metric.
+
+   The details of the comparison can be obtained after it with
+   #getDifferentPixels, #getMaxDifference, #getDifferenceBounds, and
+   #getSsim.
+
+   @return
+     True if the images are equal (for the current metric). Images of
+     different sizes are never equal.
+*/
+bool ImageComparison::compare(const ImagePixels& a, const ImagePixels& b)
+{
+  const int w = min_value(a.getWidth(), b.getWidth());
+  const int h = (w > 0 ? min_value(a.getHeight(), b.getHeight()): 0);
+  const int scanlineA = a.getScanlineSize();
+  const int scanlineB = b.getScanlineSize();
+  const bool sameSize = (a.getSize() == b.getSize());
+
+  m_differentPixels = 0;
+  m_identicalRows = 0;
+  m_maxDifference = 0.0;
+  m_ssim = 1.0;
+  m_differenceBounds = Rect();
+
+  std::vector<bool> identical(h > 0 ? h: 0);
+
+  for (int y=0; y<h; ++y) {
+    const pixel_type* rowA = &a[y*scanlineA];
+    const pixel_type* rowB = &b[y*scanlineB];
+
+    if (equalRows(rowA, rowB, w)) {
+      identical[y] = true;
+      ++m_identicalRows;
+      continue;
+    }
+
+    for (int x=0; x<w; ++x) {
+      if (rowA[x] == rowB[x])
+        continue;
+
+      double d = getPixelDifference(rowA[x], rowB[x]);
+      m_maxDifference = max_value(m_maxDifference, d);
+
+      if ((m_metric == ImageMetric::Tolerance || m_metric == ImageMetric::DeltaE) && d <= m_tolerance)
+        continue;
+
+      ++m_differentPixels;
+      m_differenceBounds = m_differenceBounds.isEmpty() ? Rect(x, y, 1, 1):
+                                                          m_differenceBounds.createUnion(Rect(x, y, 1, 1));
+    }
+  }
+
+  if (!sameSize) {
+    // Pixels that are only in one image are different
+    Size sz(max_value(a.getWidth(), b.getWidth()),
+            max_value(a.getHeight(), b.getHeight()));
+
+    m_differentPixels += sz.w*sz.h - w*h;
+    m_differenceBounds = Rect(Point(0, 0), sz);
+    return false;
+  }
+
+  if (m_metric == ImageMetric::Ssim) {
+    compareSsim(a, b, identical);
+    return m_ssim >= m_threshold;
+  }
+
+  return m_differentPixels <= m_maxDifferentPixels;
+}
+
+/**
+   Returns the number of different pixels found in the last comparison
+   (with ImageMetric::Ssim, the pixels that are not exactly equal).
+*/
+int ImageComparison::getDifferentPixels() const
+{
+  return m_differentPixels;
+}
+
+/**
+   Returns the number of rows that were exactly equal in the last
+   comparison (and were not examined pixel by pixel).
+*/
+int ImageComparison::getIdenticalRows() const
+{
+  return m_identicalRows;
+}
+
+/**
+   Returns the greatest difference between two pixels found in the
+   last comparison (delta-E for ImageMetric::DeltaE, or the greatest
+   difference of a channel for the other metrics).
+*/
+double ImageComparison::getMaxDifference() const
+{
+  return m_maxDifference;
+}
+
+/**
+   Returns the mean SSIM calculated in the last comparison with
+   ImageMetric::Ssim (1.0 means that the images are equal).
+*/
+double ImageComparison::getSsim() const
+{
+  return m_ssim;
+}
+
+/**
+   Returns the smallest rectangle that contains all the different
+   pixels found in the last comparison (empty if there are not
+   differences).
+*/
+Rect ImageComparison::getDifferenceBounds() const
+{
+  return m_differenceBounds;
+}
+
+/**
+   Creates an image that shows where @a a and @a b are different: equal
+   pixels are painted in light gray (with the luminance of @a a), pixels
+   that differ less than the tolerance are painted in yellow, and
+   different pixels in red. Pixels that are only in one of the images
+   are painted in magenta.
+*/
+ImagePixels ImageComparison::createDiffImage(const ImagePixels& a, const ImagePixels& b) const
+{
+  const int w = min_value(a.getWidth(), b.getWidth());
+  const int h = min_value(a.getHeight(), b.getHeight());
+  const int scanlineA = a.getScanlineSize();
+  const int scanlineB = b.getScanlineSize();
+
+  ImagePixels diff(max_value(a.getWidth(), b.getWidth()),
+                   max_value(a.getHeight(), b.getHeight()));
+  const int scanline = diff.getScanlineSize();
+
+  for (int y=0; y<diff.getHeight(); ++y) {
+    for (int x=0; x<diff.getWidth(); ++x) {
+      pixel_type c;
+
+      if (x >= w || y >= h)
+        c = ImagePixels::makePixel(255, 0, 255, 255);
+      else {
+        pixel_type pa = a[y*scanlineA + x];
+        pixel_type pb = b[y*scanlineB + x];
+
+        if (pa == pb) {
+          int l = 192 + get_luma(pa) / 4;
+          c = ImagePixels::makePixel(l, l, l, 255);
+        }
+        else if ((m_metric == ImageMetric::Tolerance || m_metric == ImageMetric::DeltaE) &&
+                 getPixelDifference(pa, pb) <= m_tolerance)
+          c = ImagePixels::makePixel(255, 200, 0, 255);
+        else
+          c = ImagePixels::makePixel(255, 0, 0, 255);
+      }
+
+      diff[y*scanline + x] = c;
+    }
+  }
+
+  return diff;
+}
+
+/**
+   Returns true if the @a count pixels of @a a and @a b are equal.
+*/
+bool ImageComparison::equalRows(const ImagePixels::pixel_type* a, const ImagePixels::pixel_type* b, int count)
+{
+  int x = 0;
+
+#ifdef USE_SSE2
+  for (; x+8 <= count; x+=8) {
+    __m128i eq0 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a+x)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(b+x)));
+    __m128i eq1 = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a+x+4)),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(b+x+4)));
+    if (_mm_movemask_epi8(_mm_and_si128(eq0, eq1)) != 0xffff)
+      return false;
+  }
+#endif
+
+  for (; x<count; ++x)
+    if (a[x] != b[x])
+      return false;
+
+  return true;
+}
+
+/**
+   @internal
+*/
+double ImageComparison::getPixelDifference(ImagePixels::pixel_type a, ImagePixels::pixel_type b) const
+{
+  if (m_metric == ImageMetric::DeltaE) {
+    double labA[3], labB[3];
+    get_lab(a, labA);
+    get_lab(b, labB);
+    return std::sqrt((labA[0]-labB[0])*(labA[0]-labB[0]) +
+                     (labA[1]-labB[1])*(labA[1]-labB[1]) +
+                     (labA[2]-labB[2])*(labA[2]-labB[2]));
+  }
+  else
+    return get_max_channel_difference(a, b);
+}
+
+/**
+   Calculates the mean SSIM of the luminance of both images in
+   overlapped windows. The windows that are only in identical rows are
+   not calculated (their SSIM is 1).
+
+   @internal
+*/
+void ImageComparison::compareSsim(const ImagePixels& a, const ImagePixels& b, const std::vector<bool>& identical)
+{
+  const int w = a.getWidth();
+  const int h = a.getHeight();
+  const int win = min_value(SSIM_WINDOW, min_value(w, h));
+  if (win <= 0)
+    return;
+
+  const int scanlineA = a.getScanlineSize();
+  const int scanlineB = b.getScanlineSize();
+
+  // Number of different rows in [0, y)
+  std::vector<int> differentRows(h+1, 0);
+  for (int y=0; y<h; ++y)
+    differentRows[y+1] = differentRows[y] + (identical[y] ? 0: 1);
+
+  double sum = 0.0;
+  int windows = 0;
+
+  for (int y=0; ; y+=SSIM_STEP) {
+    y = min_value(y, h-win);  // the last window touches the bottom edge
+
+    for (int x=0; ; x+=SSIM_STEP) {
+      x = min_value(x, w-win);
+      ++windows;
+
+      if (differentRows[y+win] == differentRows[y])
+        sum += 1.0;
+      else {
+        double sa = 0, sb = 0, saa = 0, sbb = 0, sab = 0;
+
+        for (int v=y; v<y+win; ++v)
+          for (int u=x; u<x+win; ++u) {
+            double la = get_luma(a[v*scanlineA + u]);
+            double lb = get_luma(b[v*scanlineB + u]);
+            sa += la;
+            sb += lb;
+            saa += la*la;
+            sbb += lb*lb;
+            sab += la*lb;
+          }
+
+        const double n = win*win;
+        const double ma = sa / n;
+        const double mb = sb / n;
+        const double va = saa / n - ma*ma;
+        const double vb = sbb / n - mb*mb;
+        const double cov = sab / n - ma*mb;
+
+        sum += ((2*ma*mb + ssim_c1) * (2*cov + ssim_c2)) /
+               ((ma*ma + mb*mb + ssim_c1) * (va + vb + ssim_c2));
+      }
+
+      if (x+win >= w)
+        break;
+    }
+
+    if (y+win >= h)
+      break;
+  }
+
+  m_ssim = sum / windows;
+}
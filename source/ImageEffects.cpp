@@ -0,0 +1,286 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/ImageEffects.hpp"
+#include "Wg/Color.hpp"
+
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define USE_SSE2
+  #include <emmintrin.h>
+#endif
+
+using namespace Wg;
+
+typedef ImagePixels::pixel_type pixel_type;
+
+// Number of box blurs used to approximate a gaussian blur
+#define GAUSSIAN_BOXES 3
+
+static inline pixel_type premultiply(pixel_type c)
+{
+  int a = ImagePixels::getA(c);
+  if (a == 255)
+    return c;
+  else if (a == 0)
+    return 0;
+
+  return ImagePixels::makePixel(ImagePixels::getR(c) * a / 255,
+                                ImagePixels::getG(c) * a / 255,
+                                ImagePixels::getB(c) * a / 255, a);
+}
+
+static inline pixel_type unpremultiply(pixel_type c)
+{
+  int a = ImagePixels::getA(c);
+  if (a == 255)
+    return c;
+  else if (a == 0)
+    return 0;
+
+  return ImagePixels::makePixel(min_value(ImagePixels::getR(c) * 255 / a, 255),
+                                min_value(ImagePixels::getG(c) * 255 / a, 255),
+                                min_value(ImagePixels::getB(c) * 255 / a, 255), a);
+}
+
+// Calculates the radii of the box blurs that approximate a gaussian
+// blur of the given standard deviation (the variance of the sum of
+// the boxes is the variance of the gaussian)
+static void get_gaussian_boxes(double sigma, int radii[GAUSSIAN_BOXES])
+{
+  const int n = GAUSSIAN_BOXES;
+  double ideal = std::sqrt(12.0*sigma*sigma/n + 1.0);
+  int wl = static_cast<int>(std::floor(ideal));
+  if (wl % 2 == 0)
+    --wl;
+  int wu = wl + 2;
+  int m = static_cast<int>(std::floor((12.0*sigma*sigma - n*wl*wl - 4.0*n*wl - 3.0*n) /
+                                      (-4.0*wl - 4.0) + 0.5));
+
+  for (int i=0; i<n; ++i)
+    radii[i] = ((i < m ? wl: wu) - 1) / 2;
+}
+
+// Box blur of each row of "src" (w x h) writing the result transposed
+// in "dst" (h x w), so applying it twice blurs in both directions
+// reading memory sequentially
+static void box_blur_transpose(const pixel_type* src, pixel_type* dst, int w, int h, int radius)
+{
+  const int size = 2*radius + 1;
+
+#ifdef USE_SSE2
+  const __m128i zero = _mm_setzero_si128();
+  const __m128 scale = _mm_set1_ps(1.0f / size);
+
+  for (int y=0; y<h; ++y) {
+    const pixel_type* row = src + y*w;
+    __m128i sum = zero;
+
+    #define UNPACK(c)                                                   \
+      _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(c)), zero), zero)
+
+    for (int i=-radius; i<=radius; ++i)
+      sum = _mm_add_epi32(sum, UNPACK(row[clamp_value(i, 0, w-1)]));
+
+    for (int x=0; x<w; ++x) {
+      __m128i avg = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale));
+      avg = _mm_packs_epi32(avg, zero);
+      avg = _mm_packus_epi16(avg, zero);
+      dst[x*h + y] = static_cast<pixel_type>(_mm_cvtsi128_si32(avg));
+
+      sum = _mm_add_epi32(sum, UNPACK(row[min_value(x+radius+1, w-1)]));
+      sum = _mm_sub_epi32(sum, UNPACK(row[max_value(x-radius, 0)]));
+    }
+
+    #undef UNPACK
+  }
+#else
+  // Fixed point reciprocal of the window size
+  const std::int64_t inv = ((static_cast<std::int64_t>(1) << 32) + size/2) / size;
+
+  for (int y=0; y<h; ++y) {
+    const pixel_type* row = src + y*w;
+    int sum[4] = { 0, 0, 0, 0 };
+
+    for (int i=-radius; i<=radius; ++i) {
+      pixel_type c = row[clamp_value(i, 0, w-1)];
+      for (int k=0; k<4; ++k)
+        sum[k] += (c >> (k*8)) & 0xff;
+    }
+
+    for (int x=0; x<w; ++x) {
+      pixel_type avg = 0;
+      for (int k=0; k<4; ++k)
+        avg |= static_cast<pixel_type>((sum[k] * inv + (static_cast<std::int64_t>(1) << 31)) >> 32) << (k*8);
+      dst[x*h + y] = avg;
+
+      pixel_type in = row[min_value(x+radius+1, w-1)];
+      pixel_type out = row[max_value(x-radius, 0)];
+      for (int k=0; k<4; ++k)
+        sum[k] += static_cast<int>((in >> (k*8)) & 0xff) - static_cast<int>((out >> (k*8)) & 0xff);
+    }
+  }
+#endif
+}
+
+// Applies the box blurs of the given radii to the "bounds" of "pixels"
+static void blur(ImagePixels& pixels, const Rect& _bounds, const int* radii, int count)
+{
+  Rect bounds = _bounds.createIntersect(Rect(Point(0, 0), pixels.getSize()));
+  if (bounds.isEmpty())
+    return;
+
+  const int w = bounds.w;
+  const int h = bounds.h;
+  const int scanline = pixels.getScanlineSize();
+  std::vector<pixel_type> a(w*h);
+  std::vector<pixel_type> b(w*h);
+
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      a[y*w + x] = premultiply(pixels[(bounds.y+y)*scanline + bounds.x+x]);
+
+  for (int i=0; i<count; ++i) {
+    if (radii[i] <= 0)
+      continue;
+
+    box_blur_transpose(&a[0], &b[0], w, h, radii[i]); // horizontal
+    box_blur_transpose(&b[0], &a[0], h, w, radii[i]); // vertical
+  }
+
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x)
+      pixels[(bounds.y+y)*scanline + bounds.x+x] = unpremultiply(a[y*w + x]);
+}
+
+/**
+   Replaces each pixel with the average of the square of
+   (2*@a radius+1)² pixels around it.
+*/
+void ImageEffects::boxBlur(ImagePixels& pixels, int radius)
+{
+  boxBlur(pixels, Rect(Point(0, 0), pixels.getSize()), radius);
+}
+
+/**
+   Blurs only the pixels inside @a bounds (pixels outside the
+   rectangle are not used, the edges of the rectangle are repeated).
+*/
+void ImageEffects::boxBlur(ImagePixels& pixels, const Rect& bounds, int radius)
+{
+  blur(pixels, bounds, &radius, 1);
+}
+
+/**
+   Blurs the pixels with a gaussian of the specified standard
+   deviation (in pixels).
+*/
+void ImageEffects::gaussianBlur(ImagePixels& pixels, double sigma)
+{
+  gaussianBlur(pixels, Rect(Point(0, 0), pixels.getSize()), sigma);
+}
+
+void ImageEffects::gaussianBlur(ImagePixels& pixels, const Rect& bounds, double sigma)
+{
+  if (sigma <= 0.0)
+    return;
+
+  int radii[GAUSSIAN_BOXES];
+  get_gaussian_boxes(sigma, radii);
+  blur(pixels, bounds, radii, GAUSSIAN_BOXES);
+}
+
+/**
+   Returns how many pixels a shadow created with #createShadow extends
+   beyond each side of the original image.
+*/
+int ImageEffects::getShadowExtent(double sigma)
+{
+  if (sigma <= 0.0)
+    return 0;
+
+  int radii[GAUSSIAN_BOXES];
+  get_gaussian_boxes(sigma, radii);
+
+  int extent = 0;
+  for (int i=0; i<GAUSSIAN_BOXES; ++i)
+    extent += radii[i];
+  return extent;
+}
+
+/**
+   Creates the shadow of an image: the alpha channel of @a pixels
+   painted with @a color and blurred.
+
+   @return
+     An image that is #getShadowExtent pixels bigger than @a pixels in
+     each side (so the blur is not clipped).
+*/
+ImagePixels ImageEffects::createShadow(const ImagePixels& pixels, double sigma, const Color& color, int opacity)
+{
+  const int extent = getShadowExtent(sigma);
+  const int w = pixels.getWidth();
+  const int h = pixels.getHeight();
+  const int srcScanline = pixels.getScanlineSize();
+  const int r = color.getR();
+  const int g = color.getG();
+  const int b = color.getB();
+
+  ImagePixels shadow(w + 2*extent, h + 2*extent);
+  const int dstScanline = shadow.getScanlineSize();
+
+  for (int y=0; y<h; ++y)
+    for (int x=0; x<w; ++x) {
+      int a = ImagePixels::getA(pixels[y*srcScanline + x]) * opacity / 255;
+      shadow[(y+extent)*dstScanline + x+extent] = a > 0 ? ImagePixels::makePixel(r, g, b, a): 0;
+    }
+
+  gaussianBlur(shadow, sigma);
+  return shadow;
+}
+
+/**
+   Composes the shadow of @a src and then @a src itself over @a dst.
+
+   @param pt
+     Where @a src is drawn.
+
+   @param shadowOffset
+     Displacement of the shadow from @a pt.
+*/
+void ImageEffects::drawDropShadow(ImagePixels& dst, const ImagePixels& src, const Point& pt,
+                                  const Point& shadowOffset, double sigma, const Color& color, int opacity)
+{
+  const int extent = getShadowExtent(sigma);
+  ImagePixels shadow = createShadow(src, sigma, color, opacity);
+
+  compose(dst, shadow, pt + shadowOffset - Point(extent, extent));
+  compose(dst, src, pt);
+}
+
+/**
+   Composes @a src over @a dst with its upper-left corner in @a pt
+   (both images with straight alpha).
+*/
+void ImageEffects::compose(ImagePixels& dst, const ImagePixels& src, const Point& pt)
+{
+  Rect bounds = Rect(pt, src.getSize()).createIntersect(Rect(Point(0, 0), dst.getSize()));
+  if (bounds.isEmpty())
+    return;
+
+  const int srcScanline = src.getScanlineSize();
+  const int dstScanline = dst.getScanlineSize();
+
+  for (int y=bounds.y; y<bounds.y+bounds.h; ++y) {
+    const pixel_type* s = &src[(y-pt.y)*srcScanline + bounds.x-pt.x];
+    pixel_type* d = &dst[y*dstScanline + bounds.x];
+
+    for (int x=0; x<bounds.w; ++x)
+      d[x] = ImagePixels::blendPixel(d[x], s[x]);
+  }
+}
@@ -29,11 +29,23 @@ Label::Label(const String& text, Widget* parent, const Style& style)
 Label::Label(HWND handle)
   : Widget(handle)
 {
+  m_textLayout.setText(getText());
+  m_measureLayout.setText(getText());
 }
 
 Label::~Label()
 = default;
 
+/**
+   Changes the text of the label, invalidating its TextLayout.
+*/
+void Label::setText(const String& str)
+{
+  Widget::setText(str);
+  m_textLayout.setText(str);
+  m_measureLayout.setText(str);
+}
+
 /**
    Returns the current text alignment.
 
@@ -100,19 +112,39 @@ int Label::getFlagsForDrawString()
 }
 
 /**
-   Returns the preferred size of the label using Graphics#measureString.
+   Returns the layout used to paint the label's text in the specified
+   width.
+
+   The layout is calculated again only when the text, the font, the
+   width, or the word-wrap/ellipsis styles of the label change, so it
+   can be used to paint the text as many times as needed. The preferred
+   size is calculated with other layout, so measuring the label does
+   not discard the layout used to paint it.
+
+   @param width
+     Maximum width of the lines (zero means no limit).
+*/
+TextLayout& Label::getTextLayout(int width)
+{
+  updateTextLayout(m_textLayout, width);
+  return m_textLayout;
+}
+
+/**
+   Returns the preferred size of the label using its TextLayout.
+
+   @see #getTextLayout
 */
 void Label::onPreferredSize(PreferredSizeEvent& ev)
 {
   // TODO HTHEME stuff
 
-  ScreenGraphics g;
-  g.setFont(getFont());
-
   if (ev.fitInWidth() && useWordWrap())
-    ev.setPreferredSize(g.measureString(getText(), ev.fitInWidth()));
+    updateTextLayout(m_measureLayout, ev.fitInWidth());
   else
-    ev.setPreferredSize(g.measureString(getText()));
+    updateTextLayout(m_measureLayout, 0);
+
+  ev.setPreferredSize(m_measureLayout.getSize());
 }
 
 /**
@@ -124,3 +156,24 @@ void Label::onResize(ResizeEvent& ev)
   invalidate(true);
   Widget::onResize(ev);
 }
+
+/**
+   Sets the font, width and styles of the label in the @a layout.
+*/
+void Label::updateTextLayout(TextLayout& layout, int width)
+{
+  int style = getStyle().regular;
+  TextEllipsis ellipsis = TextEllipsis::None;
+
+  switch (style & SS_ELLIPSISMASK) {
+    case SS_WORDELLIPSIS: ellipsis = TextEllipsis::Word; break;
+    case SS_ENDELLIPSIS:  ellipsis = TextEllipsis::End;  break;
+    case SS_PATHELLIPSIS: ellipsis = TextEllipsis::Path; break;
+  }
+
+  layout.setFont(getFont());
+  layout.setWordWrap(useWordWrap());
+  layout.setEllipsis(ellipsis);
+  layout.setPrefix((style & SS_NOPREFIX) == 0);
+  layout.setWidth(width);
+}
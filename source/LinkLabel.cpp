@@ -115,15 +115,8 @@ void LinkLabel::onPaint(PaintEvent& ev)
   }
 
   // draw text
-  if (!getText().empty()) {
-    int flags = getFlagsForDrawString();
-
-    switch (getTextAlign()) {
-      case TextAlign::Left:   flags |= DT_LEFT;   break;
-      case TextAlign::Center: flags |= DT_CENTER; break;
-      case TextAlign::Right:  flags |= DT_RIGHT;  break;
-    }
-
+  TextLayout& layout = getTextLayout(rc.w);
+  if (!layout.getText().empty()) {
     Color color;
 
     if (m_state == Hover) {
@@ -137,9 +130,9 @@ void LinkLabel::onPaint(PaintEvent& ev)
 
     // draw text
     if (isEnabled())
-      g.drawString(getText(), color, bounds, flags);
+      layout.draw(g, color, bounds, getTextAlign());
     else
-      g.drawDisabledString(getText(), bounds, flags);
+      layout.drawDisabled(g, bounds, getTextAlign());
   }
 
   // draw focus
@@ -297,7 +290,7 @@ Rect LinkLabel::getLinkBounds(Graphics& g)
     pt.y += rc.h/2 - sz.h/2;
   }
   else {
-    sz = g.measureString(getText(), rc.w, getFlagsForDrawString());
+    sz = getTextLayout(rc.w).getSize();
 
     switch (getTextAlign()) {
       case TextAlign::Center: pt.x += rc.w/2 - sz.w/2; break;
@@ -10,6 +10,7 @@
 #include "Wg/Event.hpp"
 #include "Wg/ClientLayout.hpp"
 #include "Wg/Menu.hpp"
+#include "Wg/MessageMap.hpp"
 
 using namespace Wg;
 
@@ -63,6 +64,8 @@ MdiChild::~MdiChild()
 
 void MdiChild::initialize()
 {
+  setMessageMap(getBaseMessageMap());
+
   // see TN005
   ::PostMessage(getHandle(), WM_MDIACTIVATE, 0, reinterpret_cast<LPARAM>(getHandle()));
   ::PostMessage(getHandle(), WM_SETFOCUS, 0, 0);
@@ -125,6 +128,22 @@ bool MdiChild::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lRes
   return false;
 }
 
+/**
+   Returns the map with the messages that MdiChild#wndProc handles (and
+   the ones of Frame). It is the base map for the maps of the classes
+   derived from MdiChild.
+
+   @see MessageMap, Widget#setMessageMap
+*/
+const MessageMap& MdiChild::getBaseMessageMap()
+{
+  // the same messages of the switch in wndProc
+  static const MessageMap map(typeid(MdiChild), Frame::getBaseMessageMap(), {
+      MessageMap::forward(WM_MDIACTIVATE),
+    });
+  return map;
+}
+
 // Don't try to do this alternative (using WM_MDICREATE), it doesn't
 // fix the TN005 problem (also it doesn't support the extended styles WS_EX)
 #if 0				// don't remove this code, must be for
@@ -343,6 +362,8 @@ MdiFrame::MdiFrame(const String& title, Widget* parent, const Style& style, bool
 
   if (!customMdiClient)
     m_mdiClient = new MdiClient(this);
+
+  setMessageMap(getBaseMessageMap());
 }
 
 // MdiFrame::MdiFrame(Widget* parent, Style style)
@@ -459,6 +480,22 @@ bool MdiFrame::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lRes
   return false;
 }
 
+/**
+   Returns the map with the messages that MdiFrame#wndProc handles (and
+   the ones of Frame). It is the base map for the maps of the classes
+   derived from MdiFrame.
+
+   @see MessageMap, Widget#setMessageMap
+*/
+const MessageMap& MdiFrame::getBaseMessageMap()
+{
+  // the same messages of the switch in wndProc
+  static const MessageMap map(typeid(MdiFrame), Frame::getBaseMessageMap(), {
+      MessageMap::forward(WM_SIZE),
+    });
+  return map;
+}
+
 // // Uses the DefFrameProc.
 // LRESULT MdiFrame::defWndProc(UINT message, WPARAM wParam, LPARAM lParam)
 // {
@@ -0,0 +1,151 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/MessageMap.hpp"
+#include "Wg/Debug.hpp"
+#include "Wg/Widget.hpp"
+
+#include <algorithm>
+#include <climits>
+
+using namespace Wg;
+
+/**
+   Creates a map with the specified entries for the widgets of the
+   @a widgetClass class.
+*/
+MessageMap::MessageMap(const std::type_info& widgetClass, std::initializer_list<Entry> entries)
+  : m_entries(1)
+  , m_widgetClass(widgetClass)
+{
+  std::fill(m_index, m_index+IndexedMessages, 0);
+  resetDispatchCounts();
+
+  for (const Entry& entry : entries)
+    add(entry);
+}
+
+/**
+   Creates a map with the entries of the @a base map (the map of the
+   base class) plus the specified @a entries. A handler in @a entries
+   replaces the handler of the base map for the same message.
+*/
+MessageMap::MessageMap(const std::type_info& widgetClass, const MessageMap& base, std::initializer_list<Entry> entries)
+  : m_entries(base.m_entries)
+  , m_widgetClass(widgetClass)
+  , m_others(base.m_others)
+{
+  std::copy(base.m_index, base.m_index+IndexedMessages, m_index);
+  resetDispatchCounts();
+
+  for (const Entry& entry : entries)
+    add(entry);
+}
+
+/**
+   Returns true if @a widget is of the class of this map (not of a
+   derived class), so its messages can be dispatched with the map.
+*/
+bool MessageMap::isMapOf(const Widget* widget) const
+{
+  return typeid(*widget) == m_widgetClass;
+}
+
+/**
+   Returns true if @a message has a handler or it is forwarded to
+   Widget#wndProc.
+*/
+bool MessageMap::contains(UINT message) const
+{
+  return find(message) != nullptr;
+}
+
+/**
+   Returns how many times @a message was dispatched by this map (to any
+   widget). All the messages greater than or equal to @c WM_USER share
+   the same counter.
+*/
+unsigned long MessageMap::getDispatchCount(UINT message) const
+{
+  return m_counts[min_value<UINT>(message, IndexedMessages)].load(std::memory_order_relaxed);
+}
+
+void MessageMap::resetDispatchCounts()
+{
+  for (auto& count : m_counts)
+    count.store(0, std::memory_order_relaxed);
+}
+
+/**
+   Sends the message to the handler, Widget#wndProc, or
+   Widget#defWndProc of @a widget.
+
+   @internal
+*/
+LRESULT MessageMap::dispatch(Widget* widget, UINT message, WPARAM wParam, LPARAM lParam) const
+{
+  // The counter is not incremented atomically (it is not worth a
+  // locked instruction for each message), some counts can be lost if
+  // widgets of different threads use the same map
+  std::atomic<unsigned long>& count(m_counts[min_value<UINT>(message, IndexedMessages)]);
+  count.store(count.load(std::memory_order_relaxed)+1, std::memory_order_relaxed);
+
+  LRESULT lResult;
+  const Entry* entry = find(message);
+  if (entry != nullptr) {
+    if (entry->handler != nullptr &&
+        entry->handler(widget, wParam, lParam, lResult))
+      return lResult;
+
+    if (entry->forward &&
+        widget->wndProc(message, wParam, lParam, lResult))
+      return lResult;
+  }
+
+  return widget->defWndProc(message, wParam, lParam);
+}
+
+void MessageMap::add(const Entry& entry)
+{
+  Entry* old = const_cast<Entry*>(find(entry.message));
+  if (old != nullptr) {
+    if (entry.handler != nullptr)
+      old->handler = entry.handler;
+    old->forward = old->forward || entry.forward;
+    return;
+  }
+
+  assert(m_entries.size() < USHRT_MAX);
+  auto position = static_cast<unsigned short>(m_entries.size());
+  m_entries.push_back(entry);
+
+  if (entry.message < IndexedMessages)
+    m_index[entry.message] = position;
+  else {
+    auto it = std::lower_bound(m_others.begin(), m_others.end(), entry.message,
+                               [this](unsigned short i, UINT message) {
+                                 return m_entries[i].message < message;
+                               });
+    m_others.insert(it, position);
+  }
+}
+
+const MessageMap::Entry* MessageMap::find(UINT message) const
+{
+  if (message < IndexedMessages) {
+    unsigned short i = m_index[message];
+    return i != 0 ? &m_entries[i]: nullptr;
+  }
+
+  auto it = std::lower_bound(m_others.begin(), m_others.end(), message,
+                             [this](unsigned short i, UINT message) {
+                               return m_entries[i].message < message;
+                             });
+  if (it != m_others.end() && m_entries[*it].message == message)
+    return &m_entries[*it];
+  else
+    return nullptr;
+}
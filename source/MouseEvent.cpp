@@ -5,6 +5,7 @@
 // please read LICENSE.txt for more information.
 
 #include "Wg/MouseEvent.hpp"
+#include "Wg/Debug.hpp"
 #include "Wg/Widget.hpp"
 
 using namespace Wg;
@@ -27,6 +28,8 @@ MouseEvent::MouseEvent(Widget* source, const Point& point, int clicks,
   , m_flags(flags)
   , m_trigger(trigger)
   , m_delta(delta)
+  , m_history(nullptr)
+  , m_historySize(0)
 {
 }
 
@@ -140,3 +143,55 @@ int MouseEvent::getDelta() const
 {
   return m_delta;
 }
+
+/**
+   Returns the number of positions of the mouse that this event
+   represents (at least one, the #getPoint).
+
+   @see #getHistoryPoint
+*/
+int MouseEvent::getHistorySize() const
+{
+  return m_history != nullptr ? m_historySize: 1;
+}
+
+/**
+   Returns a position of the mouse of the movement. The positions are
+   sorted from the oldest one (index 0) to the newest one (index
+   #getHistorySize - 1, that is the #getPoint).
+
+   The positions are relative to the client-bounds of the source.
+
+   @code
+   void MyCanvas::onMouseMove(MouseEvent& ev)
+   {
+     // draw a stroke through all the points (not only the last one)
+     for (int i=0; i<ev.getHistorySize(); ++i)
+       m_stroke.push_back(ev.getHistoryPoint(i));
+   }
+   @endcode
+*/
+Point MouseEvent::getHistoryPoint(int index) const
+{
+  assert(index >= 0 && index < getHistorySize());
+
+  return m_history != nullptr ? m_history[index]: m_point;
+}
+
+/**
+   Sets the positions of the mouse represented by this event (the last
+   one must be #getPoint). The array must live while the event is used.
+
+   @internal
+*/
+void MouseEvent::setHistory(const Point* points, int count)
+{
+  if (count > 0) {
+    m_history = points;
+    m_historySize = count;
+  }
+  else {
+    m_history = nullptr;
+    m_historySize = 0;
+  }
+}
@@ -7,9 +7,9 @@
 #include "Wg/Mutex.hpp"
 
 #if defined(VACA_ON_WINDOWS)
-  #include "win32/MutexImpl.hpp"
+  #include "Win32/MutexImpl.hpp"
 #elif defined(VACA_ON_UNIXLIKE)
-  #include "unix/MutexImpl.h"
+  #include "Unix/MutexImpl.hpp"
 #else
   #error Your platform does not support mutexes
 #endif 
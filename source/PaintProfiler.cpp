@@ -0,0 +1,286 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/PaintProfiler.hpp"
+#include "Wg/Graphics.hpp"
+#include "Wg/ScopedLock.hpp"
+#include "Wg/String.hpp"
+#include "Wg/Widget.hpp"
+#include "Wg/Win32.hpp"
+
+#include <algorithm>
+
+using namespace Wg;
+
+// Colors of the heatmap for pixels painted 1, 2, 3, 4, and 5 or more
+// times (the pixels that were not painted are transparent)
+static const ImagePixels::pixel_type heat_colors[] = {
+  ImagePixels::makePixel(0, 0, 255, 96),
+  ImagePixels::makePixel(0, 192, 0, 128),
+  ImagePixels::makePixel(255, 255, 0, 160),
+  ImagePixels::makePixel(255, 128, 0, 192),
+  ImagePixels::makePixel(255, 0, 0, 224)
+};
+
+// Returns the bounds of the client area of "hwnd" in screen coordinates
+static Rect get_screen_client_bounds(HWND hwnd)
+{
+  RECT rc;
+  ::GetClientRect(hwnd, &rc);
+  ::MapWindowPoints(hwnd, nullptr, reinterpret_cast<LPPOINT>(&rc), 2);
+  return convert_to<Rect>(rc);
+}
+
+// Returns the part of the client area of "hwnd" that is not clipped by
+// its parents (in screen coordinates)
+static Rect get_screen_visible_bounds(HWND hwnd)
+{
+  if (!::IsWindowVisible(hwnd))
+    return Rect();
+
+  Rect bounds = get_screen_client_bounds(hwnd);
+
+  while ((::GetWindowLong(hwnd, GWL_STYLE) & WS_CHILD) != 0 &&
+         (hwnd = ::GetParent(hwnd)) != nullptr) {
+    bounds = bounds.createIntersect(get_screen_client_bounds(hwnd));
+    if (bounds.isEmpty())
+      return Rect();
+  }
+
+  return bounds;
+}
+
+static inline double get_area(const Rect& rc)
+{
+  return rc.isEmpty() ? 0.0: static_cast<double>(rc.w) * rc.h;
+}
+
+/**
+   Starts to measure the paint of @a widget in @a g (the clipping
+   bounds of @a g are the painted area). It does nothing if the
+   profiler is disabled.
+*/
+PaintProfiler::Scope::Scope(Widget* widget, Graphics& g)
+  : m_widget(nullptr)
+{
+  if (PaintProfiler::getInstance().isEnabled()) {
+    m_widget = widget;
+    m_bounds = g.getClipBounds();
+    m_time.reset();
+  }
+}
+
+PaintProfiler::Scope::~Scope()
+{
+  if (m_widget != nullptr)
+    PaintProfiler::getInstance().addPaint(m_widget, m_bounds, m_time.elapsed());
+}
+
+PaintProfiler::PaintProfiler()
+  : m_enabled(false)
+{
+}
+
+PaintProfiler::~PaintProfiler()
+= default;
+
+/**
+   Returns the profiler shared by all the widgets.
+*/
+PaintProfiler& PaintProfiler::getInstance()
+{
+  static PaintProfiler instance;
+  return instance;
+}
+
+bool PaintProfiler::isEnabled() const
+{
+  return m_enabled;
+}
+
+/**
+   Starts or stops recording the paints. The statistics recorded until
+   now are kept (see #reset).
+*/
+void PaintProfiler::setEnabled(bool state)
+{
+  m_enabled = state;
+}
+
+/**
+   Removes all the recorded statistics and heatmaps.
+*/
+void PaintProfiler::reset()
+{
+  ScopedLock hold(m_mutex);
+  m_stats.clear();
+  m_destroyed.clear();
+  m_heat.clear();
+}
+
+/**
+   Records a paint of @a widget.
+
+   @param bounds
+     Painted area in client coordinates of the widget.
+
+   @param seconds
+     Time spent painting (zero for widgets painted by the system).
+
+   @internal
+*/
+void PaintProfiler::addPaint(Widget* widget, const Rect& bounds, double seconds)
+{
+  HWND hwnd = widget->getHandle();
+  if (hwnd == nullptr)
+    return;
+
+  const Rect visible = get_screen_visible_bounds(hwnd);
+  const Rect painted = Rect(bounds.getOrigin() + get_screen_client_bounds(hwnd).getOrigin(),
+                            bounds.getSize()).createIntersect(visible);
+
+  HWND root = ::GetAncestor(hwnd, GA_ROOT);
+  const Rect rootBounds = get_screen_client_bounds(root);
+
+  ScopedLock hold(m_mutex);
+
+  auto it = m_stats.find(widget);
+  if (it == m_stats.end()) {
+    Char className[256];
+    if (::GetClassName(hwnd, className, 256) == 0)
+      className[0] = 0;
+
+    it = m_stats.insert(std::make_pair(widget, Stats{ widget, className, 0, 0.0, 0.0, 0.0 })).first;
+  }
+
+  Stats& stats = it->second;
+  ++stats.paintCount;
+  stats.paintTime += seconds;
+  stats.paintedArea += get_area(painted);
+  stats.visibleArea += get_area(visible);
+
+  // Overdraw of the top-level window
+  Heat& heat = m_heat[root];
+  if (heat.size != rootBounds.getSize()) {
+    heat.size = rootBounds.getSize();
+    heat.counts.assign(heat.size.w * heat.size.h, 0);
+  }
+
+  const Rect rc = painted.createIntersect(rootBounds);
+  if (!rc.isEmpty()) {
+    for (int y=rc.y; y<rc.y+rc.h; ++y) {
+      unsigned short* count = &heat.counts[(y-rootBounds.y)*heat.size.w + rc.x-rootBounds.x];
+      for (int x=0; x<rc.w; ++x, ++count)
+        if (*count < 0xffff)
+          ++(*count);
+    }
+  }
+}
+
+/**
+   Called when the @a widget is destroyed, so a new widget in the same
+   address does not add its paints to the statistics of this one (they
+   are added to the statistics of the destroyed widgets of its class).
+   The heatmap of a destroyed top-level window is removed too (its HWND
+   can be reused).
+
+   @internal
+*/
+void PaintProfiler::removeWidget(Widget* widget)
+{
+  ScopedLock hold(m_mutex);
+
+  auto it = m_stats.find(widget);
+  if (it != m_stats.end()) {
+    const Stats& stats = it->second;
+    auto res = m_destroyed.insert(std::make_pair(stats.name,
+                                                 Stats{ nullptr, stats.name, 0, 0.0, 0.0, 0.0 }));
+    Stats& sum = res.first->second;
+    sum.paintCount += stats.paintCount;
+    sum.paintTime += stats.paintTime;
+    sum.paintedArea += stats.paintedArea;
+    sum.visibleArea += stats.visibleArea;
+
+    m_stats.erase(it);
+  }
+
+  HWND hwnd = widget->getHandle();
+  if (hwnd != nullptr && !m_heat.empty() && ::GetAncestor(hwnd, GA_ROOT) == hwnd)
+    m_heat.erase(hwnd);
+}
+
+/**
+   Returns the statistics of all the painted widgets, sorted by the
+   time spent painting them (the slowest widget first).
+*/
+std::vector<PaintProfiler::Stats> PaintProfiler::getStats() const
+{
+  std::vector<Stats> result;
+  {
+    ScopedLock hold(m_mutex);
+    for (const auto& item : m_stats)
+      result.push_back(item.second);
+    for (const auto& item : m_destroyed)
+      result.push_back(item.second);
+  }
+
+  std::sort(result.begin(), result.end(),
+            [](const Stats& a, const Stats& b) {
+              return a.paintTime > b.paintTime;
+            });
+  return result;
+}
+
+/**
+   Returns a table with the statistics of each widget (one line per
+   widget, and one for the destroyed widgets of each class, sorted like
+   #getStats).
+*/
+String PaintProfiler::getReport() const
+{
+  String report = L"widget                           paints   time (ms)   avg (ms)   painted/visible\n";
+
+  for (const auto& stats : getStats()) {
+    report += format_string(L"%-32.32s %6d %11.3f %10.3f %16.1f%%\n",
+                            stats.name.c_str(),
+                            stats.paintCount,
+                            stats.paintTime * 1000.0,
+                            stats.paintTime * 1000.0 / stats.paintCount,
+                            stats.visibleArea > 0.0 ? 100.0 * stats.paintedArea / stats.visibleArea: 0.0);
+  }
+
+  return report;
+}
+
+/**
+   Creates an image of the client area of @a window that shows how many
+   times each pixel was painted: blue (once), green, yellow, orange,
+   and red (five or more times). Pixels that were not painted are
+   transparent, so the image can be composed over a capture of the
+   window.
+*/
+ImagePixels PaintProfiler::createHeatmap(Widget* window) const
+{
+  HWND root = ::GetAncestor(window->getHandle(), GA_ROOT);
+
+  ScopedLock hold(m_mutex);
+
+  auto it = m_heat.find(root);
+  if (it == m_heat.end())
+    return ImagePixels(get_screen_client_bounds(root).getSize());
+
+  const Heat& heat = it->second;
+  ImagePixels pixels(heat.size);
+  const int scanline = pixels.getScanlineSize();
+
+  for (int y=0; y<heat.size.h; ++y)
+    for (int x=0; x<heat.size.w; ++x) {
+      int count = heat.counts[y*heat.size.w + x];
+      pixels[y*scanline + x] = (count > 0 ? heat_colors[min_value(count, 5) - 1]: 0);
+    }
+
+  return pixels;
+}
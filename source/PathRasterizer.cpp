@@ -0,0 +1,585 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/PathRasterizer.hpp"
+#include "Wg/Color.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+using namespace Wg;
+
+typedef GraphicsPath::Vertex Vertex;
+
+// Coordinates are stored in fixed point with 8 bits of subpixel precision
+#define PIXEL_BITS      8
+#define ONE_PIXEL       (1 << PIXEL_BITS)
+#define PIXEL_MASK      (ONE_PIXEL - 1)
+
+static const double pi = 3.14159265358979323846;
+
+static inline int to_fixed(double v)
+{
+  return static_cast<int>(std::floor(v * ONE_PIXEL + 0.5));
+}
+
+// Converts the accumulated winding (ONE_PIXEL for each turn) of a pixel
+// to an alpha value using the specified fill rule
+static inline int winding_to_alpha(int winding, FillRule fillRule)
+{
+  int coverage = winding < 0 ? -winding: winding;
+
+  if (fillRule == FillRule::EvenOdd) {
+    coverage &= 2*ONE_PIXEL - 1;
+    if (coverage > ONE_PIXEL)
+      coverage = 2*ONE_PIXEL - coverage;
+  }
+  else if (coverage > ONE_PIXEL)
+    coverage = ONE_PIXEL;
+
+  return coverage * 255 / ONE_PIXEL;
+}
+
+static inline Vertex make_vertex(double x, double y)
+{
+  Vertex v = { x, y };
+  return v;
+}
+
+/**
+   Creates an empty rasterizer.
+
+   @param tolerance
+     Maximum distance (in pixels) between the curves of the paths and
+     the lines used to draw them.
+*/
+PathRasterizer::PathRasterizer(double tolerance)
+  : m_sorted(true)
+  , m_tolerance(tolerance)
+  , m_started(false)
+  , m_x(0), m_y(0)
+  , m_startX(0), m_startY(0)
+{
+}
+
+PathRasterizer::~PathRasterizer()
+= default;
+
+double PathRasterizer::getTolerance() const
+{
+  return m_tolerance;
+}
+
+void PathRasterizer::setTolerance(double tolerance)
+{
+  m_tolerance = tolerance;
+}
+
+/**
+   Returns the number of cells (pixels crossed by the outlines) that
+   were accumulated until now.
+*/
+int PathRasterizer::getCellCount() const
+{
+  return static_cast<int>(m_cells.size());
+}
+
+/**
+   Returns the pixels that can be touched by #fill.
+*/
+Rect PathRasterizer::getBounds() const
+{
+  if (m_cells.empty())
+    return Rect();
+
+  int x1 = INT_MAX, y1 = INT_MAX;
+  int x2 = INT_MIN, y2 = INT_MIN;
+
+  for (const auto& cell : m_cells) {
+    x1 = min_value(x1, cell.x);
+    y1 = min_value(y1, cell.y);
+    x2 = max_value(x2, cell.x);
+    y2 = max_value(y2, cell.y);
+  }
+
+  return Rect(x1, y1, x2-x1+1, y2-y1+1);
+}
+
+/**
+   Removes all the accumulated outlines.
+*/
+void PathRasterizer::reset()
+{
+  m_cells.clear();
+  m_sorted = true;
+  m_started = false;
+}
+
+/**
+   Starts a new polygon (closing the previous one).
+*/
+void PathRasterizer::moveTo(double x, double y)
+{
+  closeFigure();
+
+  m_startX = m_x = to_fixed(x);
+  m_startY = m_y = to_fixed(y);
+  m_started = true;
+}
+
+void PathRasterizer::lineTo(double x, double y)
+{
+  int fx = to_fixed(x);
+  int fy = to_fixed(y);
+
+  if (!m_started) {
+    m_startX = m_x;
+    m_startY = m_y;
+    m_started = true;
+  }
+
+  renderLine(m_x, m_y, fx, fy);
+  m_x = fx;
+  m_y = fy;
+}
+
+/**
+   Closes the current polygon with a line to its first point. Polygons
+   are always closed before being filled, so it is not necessary to
+   call this explicitly.
+*/
+void PathRasterizer::closeFigure()
+{
+  if (m_started) {
+    renderLine(m_x, m_y, m_startX, m_startY);
+    m_x = m_startX;
+    m_y = m_startY;
+    m_started = false;
+  }
+}
+
+/**
+   Adds the interior of all the figures of the path (open figures are
+   closed automatically, like in Graphics#fillPath).
+*/
+void PathRasterizer::addPath(const GraphicsPath& path)
+{
+  const auto& figures = path.updateFigures(m_tolerance);
+
+  for (const auto& figure : figures) {
+    const auto& vertices = figure.vertices;
+
+    moveTo(vertices[0].x, vertices[0].y);
+    for (size_t i=1; i<vertices.size(); ++i)
+      lineTo(vertices[i].x, vertices[i].y);
+    closeFigure();
+  }
+}
+
+#ifdef VACA_ON_WINDOWS
+
+/**
+   Adds the outline of the path as it would be drawn with the specified
+   pen (see Graphics#strokePath).
+
+   @param miterLimit
+     Maximum ratio between the miter length and the width of the pen
+     (see Graphics#getMiterLimit).
+*/
+void PathRasterizer::addStroke(const GraphicsPath& path, const Pen& pen, double miterLimit)
+{
+  addStroke(path, pen.getWidth(), pen.getJoin(), pen.getEndCap(), miterLimit);
+}
+
+#endif
+
+/**
+   Adds the outline of the path with lines of the specified width.
+
+   The stroke is made of one polygon for each line, join and cap, all
+   with the same orientation, so it must be filled using
+   FillRule::Winding.
+
+   @param miterLimit
+     Maximum ratio between the miter length and the @a width. Miter
+     joins that exceed it are drawn as bevel joins.
+*/
+void PathRasterizer::addStroke(const GraphicsPath& path, double width,
+                               PenJoin join, PenEndCap endCap, double miterLimit)
+{
+  const auto& figures = path.updateFigures(m_tolerance);
+
+  const double hw = max_value(width, 1.0) / 2.0;
+  std::vector<Vertex> polygon;
+
+  for (const auto& figure : figures) {
+    // Remove repeated points
+    std::vector<Vertex> v;
+    for (const auto& pt : figure.vertices)
+      if (v.empty() || pt.x != v.back().x || pt.y != v.back().y)
+        v.push_back(pt);
+
+    bool closed = figure.closed;
+    if (closed && v.size() > 1 &&
+        v.front().x == v.back().x && v.front().y == v.back().y)
+      v.pop_back();
+
+    const int n = static_cast<int>(v.size());
+
+    // Just a dot
+    if (n == 1) {
+      if (endCap == PenEndCap::Round)
+        addCircle(v[0], hw);
+      else if (endCap == PenEndCap::Square) {
+        polygon.clear();
+        polygon.push_back(make_vertex(v[0].x-hw, v[0].y-hw));
+        polygon.push_back(make_vertex(v[0].x+hw, v[0].y-hw));
+        polygon.push_back(make_vertex(v[0].x+hw, v[0].y+hw));
+        polygon.push_back(make_vertex(v[0].x-hw, v[0].y+hw));
+        addPolygon(polygon);
+      }
+      continue;
+    }
+
+    if (n == 2)
+      closed = false;
+
+    // Lines
+    const int segments = closed ? n: n-1;
+    for (int i=0; i<segments; ++i) {
+      Vertex a = v[i];
+      Vertex b = v[(i+1) % n];
+      double len = std::sqrt((b.x-a.x)*(b.x-a.x) + (b.y-a.y)*(b.y-a.y));
+      double dx = (b.x-a.x) / len;
+      double dy = (b.y-a.y) / len;
+
+      if (!closed && endCap == PenEndCap::Square) {
+        if (i == 0) {
+          a.x -= dx*hw;
+          a.y -= dy*hw;
+        }
+        if (i == segments-1) {
+          b.x += dx*hw;
+          b.y += dy*hw;
+        }
+      }
+
+      double nx = -dy*hw;
+      double ny = dx*hw;
+
+      polygon.clear();
+      polygon.push_back(make_vertex(a.x+nx, a.y+ny));
+      polygon.push_back(make_vertex(b.x+nx, b.y+ny));
+      polygon.push_back(make_vertex(b.x-nx, b.y-ny));
+      polygon.push_back(make_vertex(a.x-nx, a.y-ny));
+      addPolygon(polygon);
+    }
+
+    // Joins
+    for (int i=(closed ? 0: 1); i<(closed ? n: n-1); ++i) {
+      const Vertex& a = v[(i+n-1) % n];
+      const Vertex& b = v[i];
+      const Vertex& c = v[(i+1) % n];
+
+      if (join == PenJoin::Round) {
+        addCircle(b, hw);
+        continue;
+      }
+
+      double len0 = std::sqrt((b.x-a.x)*(b.x-a.x) + (b.y-a.y)*(b.y-a.y));
+      double len1 = std::sqrt((c.x-b.x)*(c.x-b.x) + (c.y-b.y)*(c.y-b.y));
+      double d0x = (b.x-a.x) / len0, d0y = (b.y-a.y) / len0;
+      double d1x = (c.x-b.x) / len1, d1y = (c.y-b.y) / len1;
+      double cross = d0x*d1y - d0y*d1x;
+
+      // Collinear lines do not need a join
+      if (std::fabs(cross) < 1e-9 && d0x*d1x + d0y*d1y > 0)
+        continue;
+
+      // The join is in the outer side of the turn
+      double s = (cross > 0 ? -1.0: 1.0) * hw;
+      Vertex o0 = make_vertex(b.x - d0y*s, b.y + d0x*s);
+      Vertex o1 = make_vertex(b.x - d1y*s, b.y + d1x*s);
+
+      polygon.clear();
+      polygon.push_back(b);
+      polygon.push_back(o0);
+
+      if (join == PenJoin::Miter) {
+        double cosHalf = std::sqrt((1.0 + d0x*d1x + d0y*d1y) / 2.0);
+
+        if (cosHalf > 1e-9 && 1.0 / cosHalf <= miterLimit) {
+          double mx = -d0y - d1y;
+          double my = d0x + d1x;
+          double mlen = std::sqrt(mx*mx + my*my);
+          double k = s / cosHalf / mlen;
+
+          polygon.push_back(make_vertex(b.x + mx*k, b.y + my*k));
+        }
+      }
+
+      polygon.push_back(o1);
+      addPolygon(polygon);
+    }
+
+    // Caps
+    if (!closed && endCap == PenEndCap::Round) {
+      addCircle(v[0], hw);
+      addCircle(v[n-1], hw);
+    }
+  }
+}
+
+/**
+   Draws the accumulated polygons in @a dst.
+
+   @param fillRule
+     How self-intersecting or overlapped polygons are filled. Use
+     FillRule::Winding for strokes (see #addStroke).
+
+   @param offset
+     Translation applied to the polygons.
+*/
+void PathRasterizer::fill(ImagePixels& dst, const Color& color, FillRule fillRule, const Point& offset) const
+{
+  sortCells();
+
+  const std::vector<Cell>& cells = m_cells;
+
+  const int w = dst.getWidth();
+  const int h = dst.getHeight();
+  const int scanline = dst.getScanlineSize();
+  const int r = color.getR();
+  const int g = color.getG();
+  const int b = color.getB();
+  const size_t n = cells.size();
+  size_t i = 0;
+
+  while (i < n) {
+    const int cy = cells[i].y;
+    const int y = cy + offset.y;
+
+    // Skip scanlines outside the destination
+    if (y < 0 || y >= h) {
+      while (i < n && cells[i].y == cy)
+        ++i;
+      continue;
+    }
+
+    ImagePixels::pixel_type* row = &dst[y*scanline];
+    int cover = 0;
+
+    while (i < n && cells[i].y == cy) {
+      const int cx = cells[i].x;
+      const int x = cx + offset.x;
+      const int area = cells[i].area;
+
+      cover += cells[i].cover;
+      ++i;
+
+      // The pixel crossed by the edges
+      if (x >= 0 && x < w) {
+        int alpha = winding_to_alpha((cover * 2*ONE_PIXEL - area) / (2*ONE_PIXEL), fillRule);
+        if (alpha > 0)
+          row[x] = ImagePixels::blendPixel(row[x], ImagePixels::makePixel(r, g, b, alpha));
+      }
+
+      // The span until the next cell has the same winding
+      int x1 = max_value(x+1, 0);
+      int x2 = min_value((i < n && cells[i].y == cy) ? cells[i].x + offset.x: w, w);
+
+      if (cover != 0 && x1 < x2) {
+        int alpha = winding_to_alpha(cover, fillRule);
+        if (alpha > 0) {
+          ImagePixels::pixel_type src = ImagePixels::makePixel(r, g, b, alpha);
+          for (int u=x1; u<x2; ++u)
+            row[u] = ImagePixels::blendPixel(row[u], src);
+        }
+      }
+    }
+  }
+}
+
+/**
+   Adds a polygon oriented counter-clockwise (reversing it if it is
+   needed), so all the pieces of a stroke add up with FillRule::Winding.
+
+   @internal
+*/
+void PathRasterizer::addPolygon(const std::vector<Vertex>& vertices)
+{
+  const size_t n = vertices.size();
+  double area = 0.0;
+
+  for (size_t i=0; i<n; ++i) {
+    const Vertex& a = vertices[i];
+    const Vertex& b = vertices[(i+1) % n];
+    area += a.x*b.y - b.x*a.y;
+  }
+
+  if (area >= 0.0) {
+    moveTo(vertices[0].x, vertices[0].y);
+    for (size_t i=1; i<n; ++i)
+      lineTo(vertices[i].x, vertices[i].y);
+  }
+  else {
+    moveTo(vertices[n-1].x, vertices[n-1].y);
+    for (size_t i=n-1; i>0; --i)
+      lineTo(vertices[i-1].x, vertices[i-1].y);
+  }
+  closeFigure();
+}
+
+/**
+   @internal
+*/
+void PathRasterizer::addCircle(const Vertex& center, double radius)
+{
+  // Number of sides so the error is below the tolerance
+  int sides = 8;
+  if (radius > m_tolerance)
+    sides = static_cast<int>(std::ceil(pi / std::acos(1.0 - m_tolerance / radius)));
+  sides = clamp_value(sides, 8, 256);
+
+  moveTo(center.x + radius, center.y);
+  for (int i=1; i<sides; ++i) {
+    double angle = 2.0 * pi * i / sides;
+    lineTo(center.x + radius * std::cos(angle),
+           center.y + radius * std::sin(angle));
+  }
+  closeFigure();
+}
+
+/**
+   Accumulates the cells crossed by the line from (x1, y1) to (x2, y2)
+   (in fixed point), splitting it in scanlines.
+
+   @internal
+*/
+void PathRasterizer::renderLine(int x1, int y1, int x2, int y2)
+{
+  if (y1 == y2)
+    return;
+
+  const int ey1 = y1 >> PIXEL_BITS;
+  const int ey2 = y2 >> PIXEL_BITS;
+
+  if (ey1 == ey2) {
+    renderScanline(ey1, x1, y1 - (ey1 << PIXEL_BITS), x2, y2 - (ey1 << PIXEL_BITS));
+    return;
+  }
+
+  const int dir = (y2 > y1) ? 1: -1;
+  int ey = ey1;
+  int xa = x1, ya = y1;
+
+  while (ey != ey2) {
+    int by = (dir > 0 ? ey+1: ey) << PIXEL_BITS;
+    int xb = x1 + static_cast<int>(static_cast<long long>(by - y1) * (x2 - x1) / (y2 - y1));
+
+    renderScanline(ey, xa, ya - (ey << PIXEL_BITS), xb, by - (ey << PIXEL_BITS));
+
+    xa = xb;
+    ya = by;
+    ey += dir;
+  }
+
+  renderScanline(ey2, xa, ya - (ey2 << PIXEL_BITS), x2, y2 - (ey2 << PIXEL_BITS));
+}
+
+/**
+   Accumulates the cells of a piece of line inside the scanline @a ey
+   (@a y1 and @a y2 are relative to the top of the scanline).
+
+   @internal
+*/
+void PathRasterizer::renderScanline(int ey, int x1, int y1, int x2, int y2)
+{
+  if (y1 == y2)
+    return;
+
+  const int ex1 = x1 >> PIXEL_BITS;
+  const int ex2 = x2 >> PIXEL_BITS;
+
+  if (ex1 == ex2) {
+    addCell(ex1, ey, y2 - y1,
+            ((x1 & PIXEL_MASK) + (x2 & PIXEL_MASK)) * (y2 - y1));
+    return;
+  }
+
+  // Walk the cells crossed by the line, the sum of the covers of all
+  // pieces must be exactly y2-y1
+  const int dir = (x2 > x1) ? 1: -1;
+  int ex = ex1;
+  int xa = x1, ya = y1;
+
+  while (ex != ex2) {
+    int bx = (dir > 0 ? ex+1: ex) << PIXEL_BITS;
+    int yb = y1 + static_cast<int>(static_cast<long long>(bx - x1) * (y2 - y1) / (x2 - x1));
+    int base = ex << PIXEL_BITS;
+
+    addCell(ex, ey, yb - ya, ((xa - base) + (bx - base)) * (yb - ya));
+
+    xa = bx;
+    ya = yb;
+    ex += dir;
+  }
+
+  int base = ex2 << PIXEL_BITS;
+  addCell(ex2, ey, y2 - ya, ((xa - base) + (x2 - base)) * (y2 - ya));
+}
+
+/**
+   @internal
+*/
+void PathRasterizer::addCell(int ex, int ey, int cover, int area)
+{
+  if (cover == 0 && area == 0)
+    return;
+
+  // Consecutive pieces of a line usually fall in the same cell
+  if (!m_cells.empty()) {
+    Cell& last = m_cells.back();
+    if (last.x == ex && last.y == ey) {
+      last.cover += cover;
+      last.area += area;
+      return;
+    }
+  }
+
+  m_cells.push_back(Cell{ ex, ey, cover, area });
+  m_sorted = false;
+}
+
+/**
+   Sorts the cells by scanline and merges the ones of the same pixel,
+   so filling the same rasterizer again does not need to sort them.
+
+   @internal
+*/
+void PathRasterizer::sortCells() const
+{
+  if (m_sorted)
+    return;
+
+  std::sort(m_cells.begin(), m_cells.end());
+
+  size_t j = 0;
+  for (size_t i=1; i<m_cells.size(); ++i) {
+    if (m_cells[i].x == m_cells[j].x &&
+        m_cells[i].y == m_cells[j].y) {
+      m_cells[j].cover += m_cells[i].cover;
+      m_cells[j].area += m_cells[i].area;
+    }
+    else
+      m_cells[++j] = m_cells[i];
+  }
+  if (!m_cells.empty())
+    m_cells.resize(j+1);
+
+  m_sorted = true;
+}
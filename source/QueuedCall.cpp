@@ -0,0 +1,115 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/QueuedCall.hpp"
+#include "Wg/EventPool.hpp"
+#include "Wg/Message.hpp"
+
+#include <atomic>
+
+using namespace Wg;
+
+static std::atomic<unsigned> posted_count(0);
+
+static const Message& get_queued_call_message()
+{
+  static const Message message(L"Wg.QueuedCall");
+  return message;
+}
+
+QueuedCall::QueuedCall()
+= default;
+
+QueuedCall::~QueuedCall()
+= default;
+
+/**
+   Posts the @a call to the message queue of @a thread. The call is
+   deleted after it is delivered (or now if it cannot be posted).
+
+   @return
+     False if the thread does not exist or it does not have a message
+     queue (the constructor of Thread waits the queue of the new
+     thread, so it has one from the beginning).
+*/
+bool QueuedCall::post(ThreadId thread, QueuedCall* call)
+{
+  const MSG* msg = static_cast<const MSG*>(get_queued_call_message());
+
+  if (!::PostThreadMessage(thread, msg->message, 0, reinterpret_cast<LPARAM>(call))) {
+    delete call;
+    return false;
+  }
+
+  ++posted_count;
+  return true;
+}
+
+/**
+   Delivers the call posted in @a message.
+
+   @return
+     True if the message was a QueuedCall (and it was delivered).
+*/
+bool QueuedCall::dispatch(Message& message)
+{
+  const MSG* msg = static_cast<const MSG*>(message);
+
+  if (msg->hwnd != nullptr || !(message == get_queued_call_message()))
+    return false;
+
+  QueuedCall* call = reinterpret_cast<QueuedCall*>(message.getPayload());
+  --posted_count;
+
+  struct Deleter {
+    QueuedCall* call;
+    ~Deleter() { delete call; }
+  } deleter = { call };
+
+  call->deliver();
+  return true;
+}
+
+/**
+   Deletes the calls posted to the current thread that were not
+   delivered. The system discards the messages of a thread when it
+   finishes, so this is called by Thread before its thread exits.
+
+   @warning
+     A call posted after this point and before the thread finishes is
+     lost too.
+*/
+void QueuedCall::discardPending()
+{
+  const MSG* msg = static_cast<const MSG*>(get_queued_call_message());
+  MSG pending;
+
+  while (::PeekMessage(&pending, nullptr, msg->message, msg->message, PM_REMOVE)) {
+    if (pending.hwnd == nullptr) {
+      --posted_count;
+      delete reinterpret_cast<QueuedCall*>(pending.lParam);
+    }
+  }
+}
+
+/**
+   Returns the number of calls that were posted and are not delivered
+   yet (in all threads).
+*/
+unsigned QueuedCall::getPostedCount()
+{
+  return posted_count;
+}
+
+void* QueuedCall::operator new(std::size_t size)
+{
+  return EventPool::allocate(size);
+}
+
+void QueuedCall::operator delete(void* ptr, std::size_t size)
+{
+  EventPool::deallocate(ptr, size);
+}
@@ -5,8 +5,11 @@
 // please read LICENSE.txt for more information.
 
 #include "Wg/Referenceable.hpp"
+#include "Wg/Connection.hpp"
 #include "Wg/Debug.hpp"
 
+#include <algorithm>
+
 #ifndef NDEBUG
 #include "Wg/Mutex.hpp"
 #include "Wg/ScopedLock.hpp"
@@ -31,6 +34,7 @@ static std::vector<Referenceable*> s_list;
 Referenceable::Referenceable()
 {
   m_refCount = 0;
+  m_connections = nullptr;
 #ifndef NDEBUG
   {
     ScopedLock hold(s_mutex);
@@ -45,9 +49,13 @@ Referenceable::Referenceable()
 
    When compiling with assertions it checks that the references'
    counter is really zero.
+
+   The connections that track this object are disconnected.
 */
 Referenceable::~Referenceable()
 {
+  disconnectTrackedConnections();
+
 #ifndef NDEBUG
   {
     ScopedLock hold(s_mutex);
@@ -66,6 +74,42 @@ void Referenceable::destroy()
   delete this;
 }
 
+/**
+   Disconnects @a conn when this object is destroyed.
+
+   @see Connection#track
+*/
+void Referenceable::trackConnection(const Connection& conn)
+{
+  if (m_connections == nullptr)
+    m_connections = new std::vector<Connection>;
+
+  // Forget the connections that were disconnected (each time the
+  // vector is full, so it does not grow with transient signals)
+  if (m_connections->size() == m_connections->capacity()) {
+    m_connections->erase(std::remove_if(m_connections->begin(),
+                                        m_connections->end(),
+                                        [](const Connection& c) {
+                                          return !c.isConnected();
+                                        }),
+                         m_connections->end());
+  }
+
+  m_connections->push_back(conn);
+}
+
+void Referenceable::disconnectTrackedConnections()
+{
+  if (m_connections != nullptr) {
+    std::vector<Connection>* connections = m_connections;
+    m_connections = nullptr;
+
+    for (Connection& conn : *connections)
+      conn.disconnect();
+    delete connections;
+  }
+}
+
 /**
    Makes a new reference to this object.
 
@@ -6,6 +6,8 @@
 
 #include "Wg/Signal2.hpp"
 
+#include <cstring>
+
 namespace Wg::detail
 {
 
@@ -71,8 +73,10 @@ static uint32_t RemoveIf(F func, Slot * itr, Slot * end, Scope * scope) noexcept
             itr->mExec = 0u;
             itr->mThis = 0u;
             ++count;
-            if (scope != 0u)
-                scope->Descend(itr);
+            // The slots before "dest" are already compacted, so it is
+            // the position of the removed slot in the current layout
+            if (scope != nullptr)
+                scope->Descend(dest);
         } else {
             dest->mExec = itr->mExec;
             dest->mThis = itr->mThis;
@@ -172,7 +176,16 @@ static void TailIf(F func, Slot * front, Slot * back, bool one, bool append, Sco
 SignalBase::SignalBase() noexcept
 	: m_Connected{0u}, m_Capacity{1u}, m_Slots{&m_Local}, m_Scope{nullptr}, m_Local{} { }
 
-SignalBase::SignalBase(SignalBase && o) noexcept = default;
+SignalBase::SignalBase(SignalBase && o) noexcept
+	: m_Connected{o.m_Connected}, m_Capacity{o.m_Capacity}, m_Slots{o.m_Slots}, m_Scope{nullptr}, m_Local{o.m_Local} {
+    // The local buffer cannot be stolen, only copied
+    if (o.m_Slots == &o.m_Local) m_Slots = &m_Local;
+    // Leave the other signal empty
+    o.m_Connected = 0u;
+    o.m_Capacity = 1u;
+    o.m_Slots = &o.m_Local;
+    o.m_Local.Drop();
+}
 
 SignalBase::~SignalBase() { if (m_Slots != &m_Local) delete[] m_Slots; }
 
@@ -194,9 +207,9 @@ bool SignalBase::Expand(uint32_t ammount) noexcept {
     // Release the current memory buffer if not local 
     if (m_Slots != &m_Local) delete[] m_Slots;
     //  Update the iterators from a chain of scopes to point to the same positions but from a new slot memory buffer.
-    for (Scope * scope = m_Scope; scope != nullptr; scope = scope->mChild) {
-        scope->mItr = slots + reinterpret_cast< intptr_t >(scope->mItr - m_Slots);
-        scope->mEnd = slots + reinterpret_cast< intptr_t >(scope->mEnd - m_Slots);
+    for (Scope * scope = m_Scope; scope != nullptr; scope = scope->mParent) {
+        scope->mItr = slots + (scope->mItr - m_Slots);
+        scope->mEnd = slots + (scope->mEnd - m_Slots);
     }
     // Take ownership of the new memory buffer and capacity
     m_Capacity = size;
@@ -205,4 +218,122 @@ bool SignalBase::Expand(uint32_t ammount) noexcept {
     return true;
 }
 
+bool SignalBase::Connect(const Slot & slot) noexcept {
+    // Make room for the new slot (the emissions in progress do not see it)
+    if (!Adjust(m_Connected + 1)) return false;
+    // Append the slot at the back
+    m_Slots[m_Connected++] = slot;
+    return true;
+}
+
+bool SignalBase::Exists(const Slot & slot) const noexcept {
+    return ExistsIf(FullMatch< Slot >(slot.mExec, slot.mThis), m_Slots, m_Slots + m_Connected);
+}
+
+bool SignalBase::ExistsThis(const Slot & slot) const noexcept {
+    return ExistsIf(ThisMatch< Slot >(slot.mThis), m_Slots, m_Slots + m_Connected);
+}
+
+bool SignalBase::ExistsExec(const Slot & slot) const noexcept {
+    return ExistsIf(ExecMatch< Slot >(slot.mExec), m_Slots, m_Slots + m_Connected);
+}
+
+uint32_t SignalBase::Count(const Slot & slot) const noexcept {
+    return CountIf(FullMatch< Slot >(slot.mExec, slot.mThis), m_Slots, m_Slots + m_Connected);
+}
+
+uint32_t SignalBase::CountThis(const Slot & slot) const noexcept {
+    return CountIf(ThisMatch< Slot >(slot.mThis), m_Slots, m_Slots + m_Connected);
+}
+
+uint32_t SignalBase::CountExec(const Slot & slot) const noexcept {
+    return CountIf(ExecMatch< Slot >(slot.mExec), m_Slots, m_Slots + m_Connected);
+}
+
+void SignalBase::Lead(const Slot & slot, bool one, bool append) noexcept {
+    LeadIf(FullMatch< Slot >(slot.mExec, slot.mThis), m_Slots, m_Slots + m_Connected, one, append, m_Scope);
+}
+
+void SignalBase::LeadThis(const Slot & slot, bool one, bool append) noexcept {
+    LeadIf(ThisMatch< Slot >(slot.mThis), m_Slots, m_Slots + m_Connected, one, append, m_Scope);
+}
+
+void SignalBase::LeadExec(const Slot & slot, bool one, bool append) noexcept {
+    LeadIf(ExecMatch< Slot >(slot.mExec), m_Slots, m_Slots + m_Connected, one, append, m_Scope);
+}
+
+void SignalBase::Tail(const Slot & slot, bool one, bool append) noexcept {
+    // The back is inclusive, so there must be at least one slot
+    if (m_Connected == 0) return;
+    TailIf(FullMatch< Slot >(slot.mExec, slot.mThis), m_Slots, m_Slots + m_Connected - 1, one, append, m_Scope);
+}
+
+void SignalBase::TailThis(const Slot & slot, bool one, bool append) noexcept {
+    if (m_Connected == 0) return;
+    TailIf(ThisMatch< Slot >(slot.mThis), m_Slots, m_Slots + m_Connected - 1, one, append, m_Scope);
+}
+
+void SignalBase::TailExec(const Slot & slot, bool one, bool append) noexcept {
+    if (m_Connected == 0) return;
+    TailIf(ExecMatch< Slot >(slot.mExec), m_Slots, m_Slots + m_Connected - 1, one, append, m_Scope);
+}
+
+uint32_t SignalBase::Eliminate(const Slot & slot) noexcept {
+    const uint32_t count = RemoveIf(FullMatch< Slot >(slot.mExec, slot.mThis), m_Slots, m_Slots + m_Connected, m_Scope);
+    m_Connected -= count;
+    return count;
+}
+
+uint32_t SignalBase::EliminateThis(const Slot & slot) noexcept {
+    const uint32_t count = RemoveIf(ThisMatch< Slot >(slot.mThis), m_Slots, m_Slots + m_Connected, m_Scope);
+    m_Connected -= count;
+    return count;
+}
+
+uint32_t SignalBase::EliminateExec(const Slot & slot) noexcept {
+    const uint32_t count = RemoveIf(ExecMatch< Slot >(slot.mExec), m_Slots, m_Slots + m_Connected, m_Scope);
+    m_Connected -= count;
+    return count;
+}
+
+void SignalBase::Clear() noexcept {
+    // The emissions in progress must not call any other slot
+    if (m_Scope != nullptr) m_Scope->Finish();
+    // The memory buffer is kept (a slot could be running from it)
+    m_Connected = 0;
+}
+
+void SignalBase::Scope::Descend(Slot * ptr) noexcept {
+    // Every nested emission of the signal iterates the same buffer
+    for (Scope * scope = this; scope != nullptr; scope = scope->mParent) {
+        // The slots after the removed one were moved one position back
+        if (scope->mItr > ptr) --scope->mItr;
+        if (scope->mEnd > ptr) --scope->mEnd;
+    }
+}
+
+void SignalBase::Scope::Lead(Slot * ptr) noexcept {
+    for (Scope * scope = this; scope != nullptr; scope = scope->mParent) {
+        // The slots before the moved one were moved one position forward,
+        // and the moved slot is not called in this emission if it was pending
+        if (scope->mItr <= ptr) ++scope->mItr;
+        if (scope->mEnd <= ptr) ++scope->mEnd;
+    }
+}
+
+void SignalBase::Scope::Tail(Slot * ptr) noexcept {
+    for (Scope * scope = this; scope != nullptr; scope = scope->mParent) {
+        // The slots after the moved one were moved one position back, and
+        // the moved slot is now after the end of the emission
+        if (scope->mItr > ptr) --scope->mItr;
+        if (scope->mEnd > ptr) --scope->mEnd;
+    }
+}
+
+void SignalBase::Scope::Finish() noexcept {
+    for (Scope * scope = this; scope != nullptr; scope = scope->mParent) {
+        scope->mItr = scope->mEnd;
+    }
+}
+
 } // Namespace:: Wg::detail
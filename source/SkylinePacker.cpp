@@ -0,0 +1,165 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/SkylinePacker.hpp"
+
+#include <climits>
+
+using namespace Wg;
+
+/**
+   Creates an empty packer for an area of the specified size.
+*/
+SkylinePacker::SkylinePacker(const Size& sz)
+  : m_size(sz)
+  , m_usedArea(0)
+{
+  clear();
+}
+
+SkylinePacker::~SkylinePacker()
+= default;
+
+/**
+   Returns the size of the whole area.
+*/
+Size SkylinePacker::getSize() const
+{
+  return m_size;
+}
+
+/**
+   Returns the fraction (from 0.0 to 1.0) of the area that is
+   covered by inserted rectangles.
+*/
+double SkylinePacker::getOccupancy() const
+{
+  long total = static_cast<long>(m_size.w) * m_size.h;
+  return total > 0 ? static_cast<double>(m_usedArea) / total: 0.0;
+}
+
+/**
+   Finds a place for a rectangle of the specified size.
+
+   @param sz
+     Size of the rectangle to be placed.
+
+   @param origin
+     Filled with the upper-left corner of the rectangle when it fits.
+
+   @return
+     False if there is no room left for the rectangle (@a origin is
+     not modified in that case).
+*/
+bool SkylinePacker::insert(const Size& sz, Point& origin)
+{
+  if (sz.w <= 0 || sz.h <= 0 ||
+      sz.w > m_size.w || sz.h > m_size.h)
+    return false;
+
+  int bestY = INT_MAX;
+  int bestW = INT_MAX;
+  size_t bestIndex = m_skyline.size();
+
+  for (size_t i=0; i<m_skyline.size(); ++i) {
+    int y;
+    if (fits(i, sz, y)) {
+      if (y + sz.h < bestY ||
+          (y + sz.h == bestY && m_skyline[i].w < bestW)) {
+        bestY = y + sz.h;
+        bestW = m_skyline[i].w;
+        bestIndex = i;
+        origin = Point(m_skyline[i].x, y);
+      }
+    }
+  }
+
+  if (bestIndex == m_skyline.size())
+    return false;
+
+  addLevel(bestIndex, origin, sz);
+  m_usedArea += static_cast<long>(sz.w) * sz.h;
+  return true;
+}
+
+/**
+   Forgets all inserted rectangles.
+*/
+void SkylinePacker::clear()
+{
+  m_skyline.clear();
+  m_skyline.push_back(Segment{0, 0, m_size.w});
+  m_usedArea = 0;
+}
+
+/**
+   Checks if a rectangle of size @a sz can be placed starting at the
+   segment @a index, and returns in @a y the vertical position where
+   it would rest.
+
+   @internal
+*/
+bool SkylinePacker::fits(size_t index, const Size& sz, int& y) const
+{
+  int x = m_skyline[index].x;
+  if (x + sz.w > m_size.w)
+    return false;
+
+  int widthLeft = sz.w;
+  y = m_skyline[index].y;
+
+  while (widthLeft > 0) {
+    if (index == m_skyline.size())
+      return false;
+
+    y = max_value(y, m_skyline[index].y);
+    if (y + sz.h > m_size.h)
+      return false;
+
+    widthLeft -= m_skyline[index].w;
+    ++index;
+  }
+  return true;
+}
+
+/**
+   Raises the skyline with the new rectangle placed at @a origin,
+   shrinking or removing the segments that are now below it.
+
+   @internal
+*/
+void SkylinePacker::addLevel(size_t index, const Point& origin, const Size& sz)
+{
+  Segment segment{origin.x, origin.y + sz.h, sz.w};
+  m_skyline.insert(m_skyline.begin() + index, segment);
+
+  // Shrink the segments covered by the new one
+  for (size_t i=index+1; i<m_skyline.size(); ) {
+    Segment& prev = m_skyline[i-1];
+    Segment& curr = m_skyline[i];
+
+    if (curr.x < prev.x + prev.w) {
+      int shrink = prev.x + prev.w - curr.x;
+      curr.x += shrink;
+      curr.w -= shrink;
+      if (curr.w <= 0) {
+        m_skyline.erase(m_skyline.begin() + i);
+        continue;
+      }
+    }
+    break;
+  }
+
+  // Merge adjacent segments at the same height
+  for (size_t i=0; i+1<m_skyline.size(); ) {
+    if (m_skyline[i].y == m_skyline[i+1].y) {
+      m_skyline[i].w += m_skyline[i+1].w;
+      m_skyline.erase(m_skyline.begin() + i + 1);
+    }
+    else
+      ++i;
+  }
+}
@@ -0,0 +1,218 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/Task.hpp"
+
+#ifdef VACA_HAS_COROUTINES
+
+#include "Wg/Thread.hpp"
+#include "Wg/Timer.hpp"
+
+#ifdef VACA_ON_WINDOWS
+#include "Wg/HttpRequest.hpp"
+#include "Wg/Widget.hpp"
+#endif
+
+using namespace Wg;
+using namespace Wg::details;
+
+bool TaskPromiseBase::isCanceled() const
+{
+  return m_token && m_token->isCanceled();
+}
+
+void TaskPromiseBase::throwIfCanceled() const
+{
+  if (isCanceled())
+    throw TaskCanceledException();
+}
+
+/**
+   Uses the token of the @a parent task (which awaits this one) if this
+   task does not have its own token.
+*/
+void TaskPromiseBase::inheritToken(const TaskPromiseBase& parent)
+{
+  if (!m_token && parent.m_token)
+    m_token = parent.m_token;
+}
+
+void TaskPromiseBase::rethrowException() const
+{
+  if (m_exception)
+    std::rethrow_exception(m_exception);
+}
+
+// Called when the coroutine finishes: the awaiting coroutine is
+// resumed, or the frame is destroyed if nobody waits it
+std::coroutine_handle<> TaskPromiseBase::finish(std::coroutine_handle<> handle) noexcept
+{
+  if (m_continuation)
+    return m_continuation;
+
+  if (m_detached) {
+    if (m_exception) {
+      try {
+        std::rethrow_exception(m_exception);
+      }
+      catch (TaskCanceledException&) {
+        // it is the expected way to finish a canceled task
+      }
+      catch (...) {
+        std::terminate();
+      }
+    }
+    handle.destroy();
+  }
+  return std::noop_coroutine();
+}
+
+// ======================================================================
+// PoolAwaiter
+
+void PoolAwaiter::post(std::coroutine_handle<> handle)
+{
+  m_pool.post([handle] { handle.resume(); }, m_priority);
+}
+
+void PoolAwaiter::await_resume() const
+{
+  if (m_promise)
+    m_promise->throwIfCanceled();
+}
+
+// ======================================================================
+// DelayAwaiter
+
+namespace {
+
+  // A timer that resumes a coroutine in its first tick
+  class DelayTimer : public Timer {
+    std::coroutine_handle<> m_handle;
+  public:
+    DelayTimer(int interval, int slack, std::coroutine_handle<> handle)
+      : Timer(interval, slack), m_handle(handle) { }
+
+  protected:
+    void onTick() override {
+      stop();
+      // the coroutine destroys the awaiter (and this timer), so the
+      // object cannot be used after resume()
+      m_handle.resume();
+    }
+  };
+
+}
+
+DelayAwaiter::~DelayAwaiter()
+{
+  delete m_timer;
+}
+
+void DelayAwaiter::startTimer(std::coroutine_handle<> handle)
+{
+  m_timer = new DelayTimer(m_msecs, m_slack, handle);
+  m_timer->start();
+}
+
+void DelayAwaiter::await_resume() const
+{
+  if (m_promise)
+    m_promise->throwIfCanceled();
+}
+
+// ======================================================================
+// CancelCheckAwaiter
+
+void CancelCheckAwaiter::await_resume() const
+{
+  if (m_promise)
+    m_promise->throwIfCanceled();
+}
+
+// ======================================================================
+
+#ifdef VACA_ON_WINDOWS
+
+bool ThreadAwaiter::await_ready() const
+{
+  return m_thread == CurrentThread::getId();
+}
+
+// Returns false (do not suspend) if the message could not be posted
+bool ThreadAwaiter::post(std::coroutine_handle<> handle)
+{
+  // the coroutine can be resumed (and this awaiter destroyed) before
+  // postToThread() returns
+  if (!ThreadPool::postToThread(m_thread, [handle] { handle.resume(); })) {
+    m_failed = true;
+    return false;
+  }
+  return true;
+}
+
+void ThreadAwaiter::await_resume() const
+{
+  if (m_failed)
+    throw TaskCanceledException();
+
+  if (m_promise)
+    m_promise->throwIfCanceled();
+}
+
+/**
+   Sends the @a request and reads its content in the default ThreadPool,
+   and then continues the awaiting coroutine in the current thread.
+
+   @param headers
+     See HttpRequest#send.
+
+   @param body
+     Data to send after the headers (e.g. for a POST request).
+
+   @throw HttpRequestException
+     It is thrown in the thread that awaits the task.
+
+   @warning
+     The @a request must exist until the task finishes.
+*/
+Task<HttpResponse> Wg::sendAsync(HttpRequest& request, String headers, std::string body)
+{
+  ThreadId thread = CurrentThread::getId();
+  HttpResponse response{ 0, std::string() };
+  std::exception_ptr error;
+
+  try {
+    co_await resumeOnPool();
+
+    response.statusCode = request.send(headers, body.empty() ? nullptr: body.c_str());
+
+    char buf[4096];
+    size_t size;
+    while ((size = request.read(buf, sizeof(buf))) > 0)
+      response.content.append(buf, size);
+  }
+  catch (...) {
+    // the exception is thrown in the thread of the caller
+    error = std::current_exception();
+  }
+
+  co_await resumeOnThread(thread);
+
+  if (error)
+    std::rethrow_exception(error);
+
+  co_return response;
+}
+
+CancellationToken details::get_lifetime_token(Widget* widget)
+{
+  return widget->getLifetimeToken();
+}
+
+#endif
+
+#endif // VACA_HAS_COROUTINES
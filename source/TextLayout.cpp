@@ -0,0 +1,447 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/TextLayout.hpp"
+#include "Wg/Graphics.hpp"
+#include "Wg/Pen.hpp"
+#include "Wg/System.hpp"
+
+using namespace Wg;
+
+static const Char ellipsis_text[] = L"...";
+
+// Gets the horizontal position of each character of "str" (with the
+// font selected in "hdc"). The result has str.size()+1 elements.
+static void get_positions(HDC hdc, const String& str, std::vector<int>& positions)
+{
+  const int n = static_cast<int>(str.size());
+
+  positions.resize(n+1);
+  positions[0] = 0;
+
+  if (n > 0) {
+    SIZE sz;
+    if (!GetTextExtentExPoint(hdc, str.c_str(), n, 0, nullptr, &positions[1], &sz))
+      std::fill(positions.begin(), positions.end(), 0);
+  }
+}
+
+// Removes the '&' prefixes from "str", returning the index of the
+// underlined character in "mnemonic" (or -1)
+static String remove_prefixes(const String& str, int& mnemonic)
+{
+  String res;
+  res.reserve(str.size());
+  mnemonic = -1;
+
+  for (size_t i=0; i<str.size(); ++i) {
+    if (str[i] == L'&' && i+1 < str.size()) {
+      ++i;
+      if (str[i] != L'&' && mnemonic < 0)
+        mnemonic = static_cast<int>(res.size());
+    }
+    res.push_back(str[i]);
+  }
+  return res;
+}
+
+TextLayout::TextLayout()
+  : m_width(0)
+  , m_wordWrap(false)
+  , m_prefix(true)
+  , m_ellipsis(TextEllipsis::None)
+  , m_valid(false)
+  , m_brokenLines(false)
+  , m_lineHeight(0)
+  , m_ascent(0)
+  , m_layoutCount(0)
+{
+}
+
+TextLayout::~TextLayout()
+= default;
+
+const String& TextLayout::getText() const
+{
+  return m_text;
+}
+
+void TextLayout::setText(const String& str)
+{
+  if (m_text != str) {
+    m_text = str;
+    invalidate();
+  }
+}
+
+Font TextLayout::getFont() const
+{
+  return m_font;
+}
+
+/**
+   Changes the font used to measure the text. The layout is invalidated
+   only if @a font is not the same font that is being used.
+*/
+void TextLayout::setFont(const Font& font)
+{
+  if (m_font.getHandle() != font.getHandle()) {
+    m_font = font;
+    invalidate();
+  }
+}
+
+/**
+   Returns the maximum width of the lines.
+*/
+int TextLayout::getWidth() const
+{
+  return m_width;
+}
+
+/**
+   Sets the maximum width of the lines. Zero (the default value) means
+   that there is no limit.
+*/
+void TextLayout::setWidth(int width)
+{
+  if (m_width != width) {
+    // the layout does not change if no line was broken or truncated
+    // and all of them fit in the new width (e.g. a label measured
+    // without a limit and then painted in its preferred size)
+    if (!m_valid || m_brokenLines ||
+        ((m_wordWrap || m_ellipsis != TextEllipsis::None) &&
+         width > 0 && m_size.w > width))
+      invalidate();
+
+    m_width = width;
+  }
+}
+
+bool TextLayout::getWordWrap() const
+{
+  return m_wordWrap;
+}
+
+/**
+   Indicates if lines wider than #getWidth should be broken in
+   spaces (like the @c DT_WORDBREAK flag of @msdn{DrawText}).
+*/
+void TextLayout::setWordWrap(bool state)
+{
+  if (m_wordWrap != state) {
+    m_wordWrap = state;
+    invalidate();
+  }
+}
+
+bool TextLayout::getPrefix() const
+{
+  return m_prefix;
+}
+
+/**
+   Indicates if the '&' characters should be processed as mnemonic
+   prefixes (true by default).
+*/
+void TextLayout::setPrefix(bool state)
+{
+  if (m_prefix != state) {
+    m_prefix = state;
+    invalidate();
+  }
+}
+
+TextEllipsis TextLayout::getEllipsis() const
+{
+  return m_ellipsis;
+}
+
+/**
+   Sets how the lines that do not fit in #getWidth are truncated. It is
+   only used when the word wrap is disabled.
+*/
+void TextLayout::setEllipsis(TextEllipsis ellipsis)
+{
+  if (m_ellipsis != ellipsis) {
+    m_ellipsis = ellipsis;
+    invalidate();
+  }
+}
+
+/**
+   Discards the calculated layout, so it is calculated again the next
+   time it is needed.
+*/
+void TextLayout::invalidate()
+{
+  m_valid = false;
+}
+
+const std::vector<TextLayout::Line>& TextLayout::getLines()
+{
+  if (!m_valid)
+    layout();
+
+  return m_lines;
+}
+
+/**
+   Returns the size of the text (like Graphics#measureString).
+*/
+Size TextLayout::getSize()
+{
+  if (!m_valid)
+    layout();
+
+  return m_size;
+}
+
+int TextLayout::getLineHeight()
+{
+  if (!m_valid)
+    layout();
+
+  return m_lineHeight;
+}
+
+/**
+   Returns how many times the layout was calculated. It is useful to
+   check that a widget is not invalidating its layout too often.
+*/
+unsigned TextLayout::getLayoutCount() const
+{
+  return m_layoutCount;
+}
+
+/**
+   Draws the lines inside the @a rc rectangle using the current font
+   of @a g (which should have the same metrics as #getFont, e.g. the
+   underlined version of the font).
+*/
+void TextLayout::draw(Graphics& g, const Color& color, const Rect& rc, TextAlign align)
+{
+  if (!m_valid)
+    layout();
+
+  Pen pen(color);
+  int y = rc.y;
+
+  for (const auto& line : m_lines) {
+    if (y >= rc.y+rc.h)
+      break;
+
+    int x = rc.x;
+    switch (align) {
+      case TextAlign::Center: x += rc.w/2 - line.getWidth()/2; break;
+      case TextAlign::Right:  x += rc.w - line.getWidth();     break;
+      default:
+        // do nothing
+        break;
+    }
+
+    g.drawString(line.text, color, x, y);
+
+    if (line.mnemonic >= 0)
+      g.drawLine(pen,
+                 x+line.positions[line.mnemonic], y+m_ascent+1,
+                 x+line.positions[line.mnemonic+1], y+m_ascent+1);
+
+    y += m_lineHeight;
+  }
+}
+
+/**
+   Draws the lines with the look of a disabled text (like
+   Graphics#drawDisabledString).
+*/
+void TextLayout::drawDisabled(Graphics& g, const Rect& rc, TextAlign align)
+{
+  draw(g, System::getColor(COLOR_3DHIGHLIGHT), Rect(rc.x+1, rc.y+1, rc.w, rc.h), align);
+  draw(g, System::getColor(COLOR_GRAYTEXT), rc, align);
+}
+
+/**
+   @internal
+*/
+void TextLayout::layout()
+{
+  ScreenGraphics g;
+  HDC hdc = g.getHandle();
+  HGDIOBJ oldFont = SelectObject(hdc, reinterpret_cast<HGDIOBJ>(m_font.getHandle()));
+  TEXTMETRIC tm;
+
+  GetTextMetrics(hdc, &tm);
+  m_lineHeight = tm.tmHeight;
+  m_ascent = tm.tmAscent;
+  m_lines.clear();
+  m_brokenLines = false;
+
+  if (m_text.empty()) {
+    // Like Graphics#measureString, the size of an empty text is the
+    // size of a space
+    SIZE sz;
+    if (!GetTextExtentPoint32(hdc, L" ", 1, &sz))
+      sz.cx = sz.cy = 0;
+    m_size = Size(sz.cx, sz.cy);
+  }
+  else {
+    size_t start = 0;
+    for (;;) {
+      size_t end = m_text.find(L'\n', start);
+      String paragraph = m_text.substr(start, end == String::npos ? String::npos: end-start);
+
+      if (!paragraph.empty() && paragraph[paragraph.size()-1] == L'\r')
+        paragraph.erase(paragraph.size()-1);
+
+      int mnemonic = -1;
+      if (m_prefix)
+        paragraph = remove_prefixes(paragraph, mnemonic);
+
+      addParagraph(hdc, paragraph, mnemonic);
+
+      if (end == String::npos)
+        break;
+      start = end+1;
+    }
+
+    int w = 0;
+    for (const auto& line : m_lines)
+      w = max_value(w, line.getWidth());
+
+    m_size = Size(w, static_cast<int>(m_lines.size()) * m_lineHeight);
+  }
+
+  SelectObject(hdc, oldFont);
+
+  m_valid = true;
+  ++m_layoutCount;
+}
+
+/**
+   Adds the lines of a paragraph (a text without '\\n'), breaking it
+   in words if it is wider than #getWidth.
+
+   @internal
+*/
+void TextLayout::addParagraph(HDC hdc, const String& text, int mnemonic)
+{
+  std::vector<int> positions;
+  get_positions(hdc, text, positions);
+
+  const int n = static_cast<int>(text.size());
+
+  if (m_width <= 0 || positions[n] <= m_width) {
+    m_lines.push_back(Line{text, positions, mnemonic});
+    return;
+  }
+
+  if (!m_wordWrap) {
+    if (m_ellipsis != TextEllipsis::None) {
+      addEllipsisLine(hdc, text, positions, mnemonic);
+      m_brokenLines = true;
+    }
+    else
+      m_lines.push_back(Line{text, positions, mnemonic});
+    return;
+  }
+
+  m_brokenLines = true;
+
+  int start = 0;
+  while (start < n) {
+    // Find the last space where the line can be broken
+    int i = start;
+    int lastBreak = -1;
+    while (i < n && positions[i+1] - positions[start] <= m_width) {
+      if (text[i] == L' ')
+        lastBreak = i;
+      ++i;
+    }
+
+    int end;
+    if (i == n)
+      end = n;
+    else if (text[i] == L' ')
+      end = i;
+    else if (lastBreak > start)
+      end = lastBreak;
+    else {
+      // A word wider than the whole line is not broken
+      end = i;
+      while (end < n && text[end] != L' ')
+        ++end;
+    }
+
+    // Trailing spaces do not take room in the line
+    int last = end;
+    while (last > start && text[last-1] == L' ')
+      --last;
+
+    Line line;
+    line.text = text.substr(start, last-start);
+    line.positions.assign(positions.begin()+start, positions.begin()+last+1);
+    for (auto& x : line.positions)
+      x -= positions[start];
+    line.mnemonic = (mnemonic >= start && mnemonic < last) ? mnemonic-start: -1;
+    m_lines.push_back(line);
+
+    // Skip spaces in the break
+    start = end;
+    while (start < n && text[start] == L' ')
+      ++start;
+  }
+}
+
+/**
+   Adds a line truncated with an ellipsis so it fits in #getWidth.
+
+   @internal
+*/
+void TextLayout::addEllipsisLine(HDC hdc, const String& text, const std::vector<int>& positions, int mnemonic)
+{
+  const int n = static_cast<int>(text.size());
+  int ellipsisWidth = 0;
+  SIZE sz;
+
+  if (GetTextExtentPoint32(hdc, ellipsis_text, 3, &sz))
+    ellipsisWidth = sz.cx;
+
+  // Keep the last component of the path
+  int suffix = n;
+  if (m_ellipsis == TextEllipsis::Path) {
+    size_t sep = text.find_last_of(L"\\/");
+    if (sep != String::npos)
+      suffix = static_cast<int>(sep);
+  }
+  const int suffixWidth = positions[n] - positions[suffix];
+
+  // Largest prefix that fits with the ellipsis
+  int k = 0;
+  while (k < suffix && positions[k+1] + ellipsisWidth + suffixWidth <= m_width)
+    ++k;
+
+  if (m_ellipsis == TextEllipsis::Word && k < suffix && text[k] != L' ') {
+    size_t space = text.find_last_of(L' ', k);
+    if (space != String::npos && space > 0)
+      k = static_cast<int>(space);
+  }
+  while (k > 0 && text[k-1] == L' ')
+    --k;
+
+  Line line;
+  line.text = text.substr(0, k) + ellipsis_text + text.substr(suffix);
+
+  if (mnemonic >= 0 && mnemonic < k)
+    line.mnemonic = mnemonic;
+  else if (mnemonic >= suffix)
+    line.mnemonic = mnemonic - suffix + k + 3;
+  else
+    line.mnemonic = -1;
+
+  get_positions(hdc, line.text, line.positions);
+  m_lines.push_back(line);
+}
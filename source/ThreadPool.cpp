@@ -0,0 +1,316 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/ThreadPool.hpp"
+#include "Wg/Debug.hpp"
+#include "Wg/ScopedLock.hpp"
+#include "Wg/Thread.hpp"
+
+#ifdef VACA_ON_WINDOWS
+#include "Wg/QueuedCall.hpp"
+#endif
+
+#include <thread>
+
+using namespace Wg;
+
+struct ThreadPool::Worker {
+  Mutex mutex;                  // for queues
+  Queue queues[Priorities];     // tasks posted from this worker
+  Thread* thread = nullptr;
+};
+
+// The pool and the index of the worker of the current thread (to add
+// the tasks that a worker posts to its own queues)
+static thread_local ThreadPool* current_pool = nullptr;
+static thread_local int current_worker = -1;
+
+/**
+   Creates a new token (not canceled).
+*/
+CancellationToken::CancellationToken()
+  : m_canceled(std::make_shared<std::atomic<bool> >(false))
+{
+}
+
+/**
+   Cancels the tasks that use this token (or a copy of it). The tasks
+   that did not start are not started, and the running ones can check
+   #isCanceled to stop.
+*/
+void CancellationToken::cancel()
+{
+  m_canceled->store(true);
+}
+
+bool CancellationToken::isCanceled() const
+{
+  return m_canceled->load();
+}
+
+// ======================================================================
+
+/**
+   Creates the pool and starts its threads.
+
+   @param workers
+     Number of threads, 0 means one for each processor.
+*/
+ThreadPool::ThreadPool(int workers)
+  : m_pending(0)
+  , m_outstanding(0)
+  , m_stop(false)
+{
+  if (workers <= 0)
+    workers = max_value(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+  m_workers.reserve(workers);
+  for (int i=0; i<workers; ++i)
+    m_workers.push_back(new Worker);
+
+  // the threads are started when all the workers exist (they steal
+  // from each other)
+  for (int i=0; i<workers; ++i)
+    m_workers[i]->thread = new Thread([this, i] { run(i); });
+}
+
+/**
+   Stops the threads. It waits the running tasks, but the tasks that
+   were not started are discarded (use #wait to run all of them).
+*/
+ThreadPool::~ThreadPool()
+{
+  assert(current_pool != this);
+
+  {
+    ScopedLock hold(m_mutex);
+    m_stop = true;
+    m_wakeUp.notifyAll();
+  }
+
+  // join all the threads before deleting the workers (a thread could
+  // be stealing from other worker)
+  for (Worker* worker : m_workers)
+    worker->thread->join();
+
+  for (Worker* worker : m_workers) {
+    delete worker->thread;
+    delete worker;
+  }
+}
+
+int ThreadPool::getWorkerCount() const
+{
+  return static_cast<int>(m_workers.size());
+}
+
+/**
+   Returns the number of tasks that were posted and did not start yet.
+*/
+int ThreadPool::getPendingCount() const
+{
+  return m_pending;
+}
+
+/**
+   Adds a task to the pool.
+*/
+void ThreadPool::post(const Task& task, TaskPriority priority)
+{
+  push(Item{ task, nullptr }, priority);
+}
+
+/**
+   Adds a task that is not started if the @a token is canceled.
+*/
+void ThreadPool::post(const Task& task, const CancellationToken& token,
+                      TaskPriority priority)
+{
+  push(Item{ task, token.m_canceled }, priority);
+}
+
+/**
+   Waits until all the posted tasks finish (including the tasks that
+   they post). It cannot be called from a task of this pool.
+*/
+void ThreadPool::wait()
+{
+  assert(current_pool != this);
+
+  ScopedLock hold(m_mutex);
+  m_idle.wait(hold, [this] { return m_outstanding == 0; });
+}
+
+/**
+   Returns a pool with one thread for each processor, shared by the
+   application (it is created the first time it is used).
+*/
+ThreadPool& ThreadPool::getDefault()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+/**
+   Returns the pool of the current thread if it is one of its workers,
+   or nullptr.
+*/
+ThreadPool* ThreadPool::getCurrent()
+{
+  return current_pool;
+}
+
+void ThreadPool::push(Item&& item, TaskPriority priority)
+{
+  // counted before it is in a queue, so wait() cannot see zero
+  // outstanding tasks while a task is posting other one
+  ++m_outstanding;
+
+  if (current_pool == this) {
+    Worker* worker = m_workers[current_worker];
+    ScopedLock hold(worker->mutex);
+    worker->queues[priority].push_back(std::move(item));
+    ++m_pending;
+  }
+  else {
+    ScopedLock hold(m_queueMutex);
+    m_queues[priority].push_back(std::move(item));
+    ++m_pending;
+  }
+
+  // wake up a worker (locking the mutex, so it cannot be between
+  // checking m_pending and starting to wait)
+  ScopedLock hold(m_mutex);
+  m_wakeUp.notifyOne();
+}
+
+// Takes the next task for the worker "index": the newest task of its
+// queues, or the oldest one of the pool queues or other workers
+bool ThreadPool::take(int index, Item& item)
+{
+  const int count = static_cast<int>(m_workers.size());
+
+  for (int priority=Priorities-1; priority>=0; --priority) {
+    {
+      Worker* worker = m_workers[index];
+      ScopedLock hold(worker->mutex);
+      Queue& queue = worker->queues[priority];
+      if (!queue.empty()) {
+        item = std::move(queue.back());
+        queue.pop_back();
+        --m_pending;
+        return true;
+      }
+    }
+
+    {
+      ScopedLock hold(m_queueMutex);
+      Queue& queue = m_queues[priority];
+      if (!queue.empty()) {
+        item = std::move(queue.front());
+        queue.pop_front();
+        --m_pending;
+        return true;
+      }
+    }
+
+    // steal
+    for (int i=1; i<count; ++i) {
+      Worker* victim = m_workers[(index+i) % count];
+      ScopedLock hold(victim->mutex);
+      Queue& queue = victim->queues[priority];
+      if (!queue.empty()) {
+        item = std::move(queue.front());
+        queue.pop_front();
+        --m_pending;
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+// Loop of the thread of a worker
+void ThreadPool::run(int index)
+{
+  current_pool = this;
+  current_worker = index;
+
+  for (;;) {
+    Item item;
+
+    if (take(index, item)) {
+      if (!item.canceled || !item.canceled->load())
+        item.task();
+      item = Item();            // destroy the task before it is finished
+
+      if (--m_outstanding == 0) {
+        ScopedLock hold(m_mutex);
+        m_idle.notifyAll();
+      }
+      continue;
+    }
+
+    ScopedLock hold(m_mutex);
+    if (m_stop)
+      break;
+    if (m_pending == 0)
+      m_wakeUp.wait(hold);
+    if (m_stop)
+      break;
+  }
+
+  current_pool = nullptr;
+  current_worker = -1;
+}
+
+// ======================================================================
+
+#ifdef VACA_ON_WINDOWS
+
+namespace {
+
+  // A task delivered by the message loop of a thread
+  class TaskCall : public QueuedCall {
+    ThreadPool::Task m_task;
+    std::shared_ptr<std::atomic<bool> > m_canceled;
+  public:
+    TaskCall(const ThreadPool::Task& task, const std::shared_ptr<std::atomic<bool> >& canceled)
+      : m_task(task), m_canceled(canceled) { }
+
+    void deliver() override {
+      if (!m_canceled || !m_canceled->load())
+        m_task();
+    }
+  };
+
+}
+
+/**
+   Runs @a task in the message loop of @a thread (e.g. to give the
+   result of a task to the UI thread). It uses a QueuedCall, so it is
+   delivered by CurrentThread#processMessage.
+
+   @return
+     False if the thread does not have a message queue.
+*/
+bool ThreadPool::postToThread(ThreadId thread, const Task& task)
+{
+  return QueuedCall::post(thread, new TaskCall(task, nullptr));
+}
+
+/**
+   Like #postToThread, but the task is not run if the @a token is
+   canceled before the message is delivered.
+*/
+bool ThreadPool::postToThread(ThreadId thread, const Task& task,
+                              const CancellationToken& token)
+{
+  return QueuedCall::post(thread, new TaskCall(task, token.m_canceled));
+}
+
+#endif
@@ -14,9 +14,8 @@ using namespace Wg;
    @see #elapsed
 */
 TimePoint::TimePoint()
+  : m_point(Clock::getCurrent().now())
 {
-  QueryPerformanceFrequency(&m_freq);
-  reset();
 }
 
 /**
@@ -35,7 +34,7 @@ TimePoint::~TimePoint()
 */
 void TimePoint::reset()
 {
-  QueryPerformanceCounter(&m_point);
+  m_point = Clock::getCurrent().now();
 }
 
 /**
@@ -48,8 +47,5 @@ void TimePoint::reset()
 */
 double TimePoint::elapsed() const
 {
-  LARGE_INTEGER now;
-  QueryPerformanceCounter(&now);
-  return static_cast<double>(now.QuadPart - m_point.QuadPart)
-    / static_cast<double>(m_freq.QuadPart);
+  return std::chrono::duration<double>(Clock::getCurrent().now() - m_point).count();
 }
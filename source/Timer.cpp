@@ -5,35 +5,80 @@
 // please read LICENSE.txt for more information.
 
 #include "Wg/Timer.hpp"
+#include "Wg/Clock.hpp"
 #include "Wg/Thread.hpp"
 #include "Wg/Debug.hpp"
 #include "Wg/Mutex.hpp"
 #include "Wg/ScopedLock.hpp"
+#include "Wg/ThreadPool.hpp"
 #include "Wg/TimePoint.hpp"
 #include "Wg/ConditionVariable.hpp"
 
-#include <limits>
-#include <climits>		// because MSVC
+#include <cstdlib>
+#include <deque>
+#include <map>
 
 using namespace Wg;
 
-static Mutex               timer_mutex;		// monitor
+// Resolution of the timers (1 millisecond)
+#define TIMER_RESOLUTION 1000000
+
+static TimerWheel::Nanoseconds get_time()
+{
+  return static_cast<TimerWheel::Nanoseconds>(Clock::getCurrent().now().count());
+}
+
+static inline TimerWheel::Nanoseconds msecs_to_nsecs(int msecs)
+{
+  return static_cast<TimerWheel::Nanoseconds>(msecs) * 1000000;
+}
+
+// Timers with ticks to be fired by a thread
+struct PendingTimers {
+  std::deque<Timer*> timers;
+  bool notified = false;        // a WM_NULL was posted and it was not processed yet
+};
+
+static Mutex               timer_mutex;         // monitor
 static Thread*             timer_thread = nullptr; // the thread that process timers
-static std::vector<Timer*> timers;              // list of timers to be processed
+static TimerWheel          timer_wheel(TIMER_RESOLUTION); // deadlines of the running timers
+static Clock*              timer_clock = nullptr; // the clock of the running timers
+static std::map<ThreadId, PendingTimers> pending_timers; // timers with ticks for each thread
+static std::map<ThreadPool*, PendingTimers> pool_pending_timers; // timers with ticks for each pool
 static bool                timer_break = false; // break the loop in timer_thread_proc()
 static ConditionVariable   wakeup_condition;    // wake-up the timer thread loop
 
+// Timer that is generating its ticks in the current thread (it is
+// set to nullptr if the timer is stopped from its onTick)
+static thread_local Timer* firing_timer = nullptr;
+
+// Returns the timers with ticks of a thread, or of a pool if the
+// timers were created in its workers
+static PendingTimers& get_pending_timers(ThreadId thread, ThreadPool* pool)
+{
+  if (pool != nullptr)
+    return pool_pending_timers[pool];
+  else
+    return pending_timers[thread];
+}
+
 /**
    @param interval In milliseconds.
+   @param slack In milliseconds (see #setSlack).
 */
-Timer::Timer(int interval)
-  : m_threadOwnerId(::GetCurrentThreadId())
+Timer::Timer(int interval, int slack)
+  : m_threadOwnerId(CurrentThread::getId())
+  , m_pool(ThreadPool::getCurrent())
   , m_running(false)
+  , m_pending(false)
   , m_interval(interval)
-  , m_timeCounter(0)
+  , m_slack(slack)
   , m_tickCounter(0)
+  , m_deadline(0)
 {
+  m_entry.data = this;
   assert(interval > 0);
+  assert(slack >= 0);
 }
 
 Timer::~Timer()
@@ -66,6 +111,38 @@ void Timer::setInterval(int interval)
   if (running) start();
 }
 
+/**
+   Returns the time that each tick can be delayed.
+
+   @see #setSlack
+*/
+int Timer::getSlack() const
+{
+  return m_slack;
+}
+
+/**
+   Sets the time (in milliseconds) that each tick can be delayed to be
+   fired together with the ticks of other timers. By default it is 0 (the
+   tick is fired as soon as possible).
+
+   The ticks do not drift: the next tick is calculated from the time of
+   the previous one without the delay.
+*/
+void Timer::setSlack(int slack)
+{
+  assert(slack >= 0);
+
+  ScopedLock hold(timer_mutex);
+
+  m_slack = slack;
+
+  if (m_running) {
+    timer_wheel.schedule(&m_entry, m_deadline, msecs_to_nsecs(m_slack));
+    wakeup_condition.notifyOne();
+  }
+}
+
 /**
    Returns true if the timer is running (generating ticks).
 */
@@ -87,15 +164,28 @@ void Timer::start()
   {
     ScopedLock hold(timer_mutex);
 
-    if (!m_running) {
-      // add timer
-      timers.push_back(this);
-      m_running = true;
+    // discard the ticks of the previous run
+    if (m_pending) {
+      remove_from_container(get_pending_timers(m_threadOwnerId, m_pool).timers, this);
+      m_pending = false;
     }
 
-    m_firstTick = true;
-    m_timeCounter = m_interval;
+    // the time of the wheel is the time of the clock (which could
+    // be replaced while there were not running timers)
+    Clock& clock = Clock::getCurrent();
+    if (timer_wheel.empty()) {
+      timer_wheel.reset(clock.now().count());
+      timer_clock = &clock;
+    }
+    else {
+      // the clock cannot be replaced with running timers
+      assert(&clock == timer_clock);
+    }
+
+    m_running = true;
     m_tickCounter = 0;
+    m_deadline = get_time() + msecs_to_nsecs(m_interval);
+    timer_wheel.schedule(&m_entry, m_deadline, msecs_to_nsecs(m_slack));
 
     // wake up timer thread
     wakeup_condition.notifyOne();
@@ -107,13 +197,8 @@ void Timer::start()
 */
 void Timer::stop()
 {
-  if (m_running) {
+  if (m_running)
     Timer::remove_timer(this);
-
-    m_running = false;
-    m_timeCounter = 0;
-    m_tickCounter = 0;
-  }
 }
 
 /**
@@ -122,7 +207,13 @@ void Timer::stop()
    Fires all events for each Timer that belong to the current thread.
    It's used from Thread#getMessage when process the WM_NULL message,
    but it's safe to call this routine from anywhere (for example, in a
-   do-while block).
+   do-while block). In platforms without message queues (not Win32),
+   each thread with timers has to call it periodically.
+
+   If the current Clock is not the real time (e.g. a VirtualClock),
+   the timers that expired until its current time are processed here
+   too, so a test can advance the clock and call this function to get
+   the ticks without waiting for the timer thread.
 */
 void Timer::pollTimers()
 {
@@ -150,76 +241,95 @@ void Timer::onTick()
 void Timer::run_timer_thread()
 {
   ScopedLock hold(timer_mutex);
-  unsigned int start, end, period, delay;
-  unsigned int inf = UINT_MAX; // std::numeric_limits<unsigned int>::max();
-  std::vector<Timer*>::iterator it;
-  Timer* timer;
 
   // is it needed?
   // ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
 
-  start = timeGetTime();
-
   while (!timer_break) {
-    // yield
-    ::Sleep(0);
-
-    end = timeGetTime();
-    period = end-start;    // how much time pass from the last event
-    start = end;
-
-    // "delay" will contain the minimum account of time to reach
-    // the next Timer's event
-    delay = inf;
-
-    // threads to send a NULL message to wake up
-    std::vector<int> threads;
-
-    // timers loop
-    for (it = timers.begin(); it != timers.end(); ++it) {
-      timer = *it;
-
-      // decrement "mTimeCounter" to known that we pass a "period"
-      // amount of time
-      if (!timer->m_firstTick)
-	timer->m_timeCounter -= period;
-      else
-	timer->m_firstTick = false;
-
-      // if we accomplish one (or more) interval(s) of this timer...
-      if (timer->m_timeCounter <= 0) {
-	// ...we must to generate ticks for each time that we
-	// accomplish the time interval
-	while (timer->m_timeCounter <= 0) {
-	  // generate one tick for each "m_interval" period of time
-	  timer->m_tickCounter++;
-	  timer->m_timeCounter += timer->m_interval;
-	}
-
-	// thread owner ID
-	int id = timer->m_threadOwnerId;
-
-	// wake up message queue of the thread which creates this
-	// timer (to process through Timer::pollTimers() all
-	// ticks of this timer from its thread)
-	if (std::find(threads.begin(), threads.end(), id) == threads.end()) {
-	  threads.push_back(id);
-	  ::PostThreadMessage(static_cast<DWORD>(id), WM_NULL, 0, 0);
-	}
+    expire_timers(get_time());
+
+    // wait wake-up condition or the next deadline (the time of a
+    // virtual clock is not waited, it is advanced by the user)
+    if (timer_wheel.empty() || !Clock::getCurrent().isRealTime())
+      wakeup_condition.wait(hold);
+    else {
+      TimerWheel::Nanoseconds next = timer_wheel.getNextWakeup();
+      TimerWheel::Nanoseconds now = get_time();
+      if (next > now) {
+	// round up to milliseconds, so we do not wake up before the
+	// deadline
+	TimerWheel::Nanoseconds msecs = (next - now + 999999) / 1000000;
+	wakeup_condition.waitFor(hold, (static_cast<double>(msecs) + 0.5) / 1000.0);
       }
+    }
+  }
+}
+
+/**
+   Generates the ticks of the timers that expired until @a now, and
+   wakes up the threads of those timers. The timer_mutex must be
+   locked.
 
-      // maybe the "delay" is too big to reach the next event
-      if (delay == inf ||
-	  delay > static_cast<unsigned int>(timer->m_timeCounter))
-	delay = static_cast<unsigned int>(timer->m_timeCounter);
+   @internal
+*/
+void Timer::expire_timers(TimerWheel::Nanoseconds now)
+{
+  // (they are static to reuse their memory, the mutex protects them)
+  static std::vector<TimerWheel::Entry*> expired;
+  static std::vector<ThreadId> threads;
+  static std::vector<ThreadPool*> pools;
+
+  expired.clear();
+  timer_wheel.advance(now, expired);
+
+  // threads to send a NULL message to wake up, and pools to post a
+  // task that fires the ticks
+  threads.clear();
+  pools.clear();
+
+  for (TimerWheel::Entry* entry : expired) {
+    auto timer = static_cast<Timer*>(entry->data);
+    TimerWheel::Nanoseconds interval = msecs_to_nsecs(timer->m_interval);
+
+    // generate one tick for each "m_interval" period of time that
+    // has passed, and schedule the next one
+    TimerWheel::Nanoseconds ticks = 1 + (now - timer->m_deadline) / interval;
+    timer->m_tickCounter += static_cast<int>(ticks);
+    timer->m_deadline += ticks * interval;
+    timer_wheel.schedule(entry, timer->m_deadline, msecs_to_nsecs(timer->m_slack));
+
+    // the ticks are fired by the thread that created the timer
+    if (!timer->m_pending) {
+      PendingTimers& pending = get_pending_timers(timer->m_threadOwnerId, timer->m_pool);
+
+      timer->m_pending = true;
+      pending.timers.push_back(timer);
+
+      // only one WM_NULL until the thread processes it (or one task
+      // until the pool fires all its timers)
+      if (!pending.notified) {
+	pending.notified = true;
+	if (timer->m_pool != nullptr)
+	  pools.push_back(timer->m_pool);
+	else
+	  threads.push_back(timer->m_threadOwnerId);
+      }
     }
+  }
 
-    // wait wake-up condition or the "delay" to process the next timer-event
-    if (delay == inf)
-      wakeup_condition.wait(hold);
-    else
-      wakeup_condition.waitFor(hold, delay / 1000.0);
+  // the workers of a pool do not process timers
+  for (ThreadPool* pool : pools)
+    pool->post([pool] { fire_timers(0, pool); });
+
+#ifdef VACA_ON_WINDOWS
+  // wake up message queue of the thread which creates each timer
+  // (to process through Timer::pollTimers() all ticks of its
+  // timers from its thread)
+  for (ThreadId id : threads) {
+    if (!::PostThreadMessage(static_cast<DWORD>(id), WM_NULL, 0, 0))
+      pending_timers[id].notified = false; // try again in the next tick
   }
+#endif
 }
 
 /**
@@ -229,8 +339,19 @@ void Timer::start_timer_thread()
 {
   ScopedLock hold(timer_mutex);
 
-  if (timer_thread == nullptr)
+  if (timer_thread == nullptr) {
     timer_thread = new Thread(&run_timer_thread);
+
+#ifdef VACA_ON_UNIXLIKE
+    // there is no Application to stop the thread, and the static
+    // condition cannot be destroyed while the thread waits it
+    static bool registered = false;
+    if (!registered) {
+      std::atexit(&Timer::stop_timer_thread);
+      registered = true;
+    }
+#endif
+  }
 }
 
 /**
@@ -268,7 +389,19 @@ void Timer::remove_timer(Timer* t)
 {
   ScopedLock hold(timer_mutex);
 
-  remove_from_container(timers, t);
+  timer_wheel.cancel(&t->m_entry);
+
+  if (t->m_pending) {
+    remove_from_container(get_pending_timers(t->m_threadOwnerId, t->m_pool).timers, t);
+    t->m_pending = false;
+  }
+
+  t->m_running = false;
+  t->m_tickCounter = 0;
+
+  // discard the rest of ticks that are being fired
+  if (firing_timer == t)
+    firing_timer = nullptr;
 }
 
 /**
@@ -276,45 +409,83 @@ void Timer::remove_timer(Timer* t)
 */
 void Timer::fire_timers_for_thread()
 {
-  ThreadId currentThreadId = ::GetCurrentThreadId();
-  std::vector<Timer*> timers_for_thread;
-  std::vector<Timer*>::iterator it;
-  Timer* timer;
+  Timer::fire_timers(CurrentThread::getId(), nullptr);
+}
+
+/**
+   Fires the ticks of the timers of the @a thread, or of the @a pool
+   (from a task of the pool) if it is not nullptr.
 
-  // make a copy of timers for this thread only
+   @internal
+*/
+void Timer::fire_timers(ThreadId thread, ThreadPool* pool)
+{
+  // the WM_NULL was processed, the next expired timer has to post
+  // another one
   {
     ScopedLock hold(timer_mutex);
 
-    for (it = timers.begin(); it != timers.end(); ) {
-      timer = *(it++);
+    // nobody else advances the time of a virtual clock
+    if (!Clock::getCurrent().isRealTime())
+      expire_timers(get_time());
 
-      // is it for this thread?
-      if (timer->m_threadOwnerId == currentThreadId)
-	timers_for_thread.push_back(timer);
+    if (pool == nullptr) {
+      auto it = pending_timers.find(thread);
+      if (it != pending_timers.end())
+	it->second.notified = false;
     }
   }
 
-  // iterate timers for this thread
-  for (it = timers_for_thread.begin();
-       it != timers_for_thread.end(); ) {
-    timer = *(it++);
+  for (;;) {
+    Timer* timer;
+    int ticks;
+
+    // take the next timer of this thread with ticks
+    {
+      ScopedLock hold(timer_mutex);
+
+      PendingTimers* pending = nullptr;
+      if (pool != nullptr)
+	pending = &pool_pending_timers[pool];
+      else {
+	auto it = pending_timers.find(thread);
+	if (it != pending_timers.end())
+	  pending = &it->second;
+      }
+
+      if (pending == nullptr || pending->timers.empty()) {
+	// the task of the pool fires the ticks that expire while it
+	// runs, so the ticks of the pool are never fired concurrently
+	if (pending != nullptr && pool != nullptr)
+	  pending->notified = false;
+	break;
+      }
+
+      timer = pending->timers.front();
+      pending->timers.pop_front();
+
+      ticks = timer->m_tickCounter;
+      timer->m_tickCounter = 0;
+      timer->m_pending = false;
+    }
 
     TimePoint warning_time;
     double timeout = timer->m_interval / 1000.0;
 
-    // for each accumulated tick
-    while (timer->m_tickCounter > 0) {
-      timer->m_tickCounter--;
+    // for each accumulated tick (the timer can be stopped or deleted
+    // in its onTick)
+    firing_timer = timer;
+    while (ticks > 0 && firing_timer == timer) {
+      ticks--;
 
       // fire event
       timer->onTick();
 
       // warning! if this is taking to long, we have to force a break
-      // of the loop discarding the rest of ticks (m_tickCounter)
-      if (warning_time.elapsed() > timeout)
-	timer->m_tickCounter = 0;
+      // of the loop discarding the rest of ticks
+      if (firing_timer == timer && warning_time.elapsed() > timeout)
+	ticks = 0;
     }
+    firing_timer = nullptr;
   }
-
-  CurrentThread::yield();
 }
@@ -0,0 +1,302 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include "Wg/TimerWheel.hpp"
+#include "Wg/Debug.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+using namespace Wg;
+
+#define NO_EVENT (std::numeric_limits<std::uint64_t>::max())
+
+// Returns the position of the least significant bit of "bits" (which
+// cannot be zero)
+static inline int find_first_bit(std::uint64_t bits)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll(bits);
+#elif defined(_MSC_VER)
+  unsigned long index;
+  if (_BitScanForward(&index, static_cast<unsigned long>(bits)))
+    return static_cast<int>(index);
+  _BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+  return static_cast<int>(index) + 32;
+#else
+  int index = 0;
+  for (; (bits & 1) == 0; bits >>= 1)
+    ++index;
+  return index;
+#endif
+}
+
+// Returns the slot of "tick" in the specified level
+static inline int get_slot(std::uint64_t tick, int level)
+{
+  return static_cast<int>((tick >> (level*TimerWheel::SlotBits)) & (TimerWheel::Slots-1));
+}
+
+/**
+   Creates an empty wheel.
+
+   @param resolution
+     Nanoseconds of each tick.
+
+   @param now
+     Current time (in nanoseconds).
+*/
+TimerWheel::TimerWheel(Nanoseconds resolution, Nanoseconds now)
+  : m_resolution(resolution)
+  , m_now(now / resolution)
+  , m_size(0)
+{
+  assert(resolution > 0);
+
+  std::fill(&m_slots[0][0], &m_slots[0][0] + Levels*Slots, nullptr);
+  std::fill(&m_bitmap[0][0], &m_bitmap[0][0] + Levels*Slots/64, 0);
+}
+
+/**
+   Unschedules the entries that are still in the wheel.
+*/
+TimerWheel::~TimerWheel()
+{
+  for (auto& level : m_slots)
+    for (Entry* entry : level)
+      for (; entry != nullptr; entry = entry->next)
+        entry->pprev = nullptr;
+}
+
+/**
+   Returns the current time of the wheel (the time given to the last
+   #advance rounded down to a tick).
+*/
+TimerWheel::Nanoseconds TimerWheel::getTime() const
+{
+  return m_now * m_resolution;
+}
+
+/**
+   Changes the current time of an empty wheel (e.g. to use the time of
+   other clock). Unlike #advance, the time can go backward.
+*/
+void TimerWheel::reset(Nanoseconds now)
+{
+  assert(empty());
+
+  m_now = now / m_resolution;
+}
+
+/**
+   Adds @a entry to expire at @a deadline (in nanoseconds). If the
+   entry was already scheduled, its previous deadline is replaced. A
+   deadline in the past expires in the next tick.
+*/
+void TimerWheel::schedule(Entry* entry, Nanoseconds deadline)
+{
+  schedule(entry, deadline, 0);
+}
+
+/**
+   Adds @a entry to expire between @a deadline and @a deadline + @a slack.
+
+   The deadline is rounded up to a multiple of the greatest power of two
+   ticks that fits in the slack, so deadlines near in time expire in the
+   same tick (even if they have different slacks, because a multiple of
+   a power of two is a multiple of the smaller ones too).
+*/
+void TimerWheel::schedule(Entry* entry, Nanoseconds deadline, Nanoseconds slack)
+{
+  if (entry->isScheduled())
+    cancel(entry);
+
+  // Round up, so the entry never expires before its deadline
+  std::uint64_t tick = deadline / m_resolution + (deadline % m_resolution != 0 ? 1: 0);
+
+  std::uint64_t granularity = slack / m_resolution;
+  if (granularity > 1) {
+    while ((granularity & (granularity-1)) != 0)
+      granularity &= granularity-1;   // clear the lowest bit
+
+    tick = (tick + granularity-1) & ~(granularity-1);
+  }
+
+  entry->tick = max_value<std::uint64_t>(tick, m_now+1);
+  insert(entry);
+  ++m_size;
+}
+
+/**
+   Removes @a entry from the wheel. It does nothing if the entry is not
+   scheduled.
+*/
+void TimerWheel::cancel(Entry* entry)
+{
+  if (entry->isScheduled()) {
+    unlink(entry);
+    --m_size;
+  }
+}
+
+/**
+   Moves the time to @a now (in nanoseconds) and adds to @a expired the
+   entries whose deadline was reached (they are not scheduled anymore).
+*/
+void TimerWheel::advance(Nanoseconds now, std::vector<Entry*>& expired)
+{
+  const std::uint64_t target = now / m_resolution;
+
+  while (m_now < target) {
+    std::uint64_t next = getNextEvent();
+    if (next > target) {
+      m_now = target;
+      break;
+    }
+    m_now = next;
+
+    // Cascade the slots of the upper levels that begin in this tick
+    for (int level=Levels-1; level>0; --level) {
+      if ((m_now & ((std::uint64_t(1) << (level*SlotBits)) - 1)) != 0)
+        continue;
+
+      int slot = get_slot(m_now, level);
+      Entry* entry = m_slots[level][slot];
+      if (entry == nullptr)
+        continue;
+
+      m_slots[level][slot] = nullptr;
+      m_bitmap[level][slot/64] &= ~(std::uint64_t(1) << (slot%64));
+
+      while (entry != nullptr) {
+        Entry* next = entry->next;
+        if (entry->tick == m_now) {
+          entry->pprev = nullptr;
+          --m_size;
+          expired.push_back(entry);
+        }
+        else
+          insert(entry);
+        entry = next;
+      }
+    }
+
+    // The entries of this tick
+    int slot = get_slot(m_now, 0);
+    Entry* entry = m_slots[0][slot];
+    if (entry != nullptr) {
+      m_slots[0][slot] = nullptr;
+      m_bitmap[0][slot/64] &= ~(std::uint64_t(1) << (slot%64));
+
+      for (; entry != nullptr; entry = entry->next) {
+        entry->pprev = nullptr;
+        --m_size;
+        expired.push_back(entry);
+      }
+    }
+  }
+}
+
+/**
+   Returns the time (in nanoseconds) when #advance should be called
+   again: the deadline of the next entry, or a time before it when the
+   wheel has to cascade a slot. Returns the maximum value of
+   @c uint64_t if the wheel is empty.
+*/
+TimerWheel::Nanoseconds TimerWheel::getNextWakeup() const
+{
+  std::uint64_t next = getNextEvent();
+  return next == NO_EVENT ? NO_EVENT: next * m_resolution;
+}
+
+void TimerWheel::insert(Entry* entry)
+{
+  assert(entry->tick > m_now);
+
+  // The level is the highest digit where the deadline and the current
+  // tick are different
+  std::uint64_t diff = entry->tick ^ m_now;
+  int level = 0;
+  while (level < Levels-1 && (diff >> ((level+1)*SlotBits)) != 0)
+    ++level;
+
+  int slot = get_slot(entry->tick, level);
+  Entry*& head = m_slots[level][slot];
+
+  entry->next = head;
+  entry->pprev = &head;
+  if (head != nullptr)
+    head->pprev = &entry->next;
+  head = entry;
+
+  m_bitmap[level][slot/64] |= std::uint64_t(1) << (slot%64);
+}
+
+void TimerWheel::unlink(Entry* entry)
+{
+  *entry->pprev = entry->next;
+  if (entry->next != nullptr)
+    entry->next->pprev = entry->pprev;
+
+  // The slot is empty, we have to find it to clear its bit
+  if (*entry->pprev == nullptr) {
+    for (int level=0; level<Levels; ++level) {
+      int slot = get_slot(entry->tick, level);
+      if (entry->pprev == &m_slots[level][slot]) {
+        m_bitmap[level][slot/64] &= ~(std::uint64_t(1) << (slot%64));
+        break;
+      }
+    }
+  }
+
+  entry->next = nullptr;
+  entry->pprev = nullptr;
+}
+
+// Returns the next tick where a slot begins (an entry expires or it is
+// cascaded to a lower level)
+std::uint64_t TimerWheel::getNextEvent() const
+{
+  if (m_size == 0)
+    return NO_EVENT;
+
+  // The slots of a level are always after the slots of the lower
+  // levels, so the first non-empty slot is the next event
+  for (int level=0; level<Levels; ++level) {
+    int slot = findSlot(level, get_slot(m_now, level)+1);
+    if (slot >= 0) {
+      const int shift = level*SlotBits;
+      std::uint64_t upper = (level+1 < Levels ? (m_now >> (shift+SlotBits)) << (shift+SlotBits): 0);
+      return upper | (static_cast<std::uint64_t>(slot) << shift);
+    }
+  }
+
+  assert(false);
+  return NO_EVENT;
+}
+
+// Returns the first non-empty slot of the level from the slot "from",
+// or -1 if there is not one
+int TimerWheel::findSlot(int level, int from) const
+{
+  if (from >= Slots)
+    return -1;
+
+  int word = from / 64;
+  std::uint64_t bits = m_bitmap[level][word] & (~std::uint64_t(0) << (from % 64));
+
+  for (;;) {
+    if (bits != 0)
+      return word*64 + find_first_bit(bits);
+    if (++word == Slots/64)
+      return -1;
+    bits = m_bitmap[level][word];
+  }
+}
@@ -14,6 +14,7 @@
 #include "Wg/DockFrame.hpp"
 #include "Wg/Command.hpp"
 #include "Wg/CommandEvent.hpp"
+#include "Wg/MessageMap.hpp"
 #include "Wg/PreferredSizeEvent.hpp"
 #include "Wg/Win32.hpp"
 
@@ -108,6 +109,8 @@ ToolSet::ToolSet(Widget* parent, const Style& style)
   // 	      TBSTYLE_EX_MIXEDBUTTONS
   // 	      // | TBSTYLE_EX_DOUBLEBUFFER
   // 	      );
+
+  setMessageMap(getBaseMessageMap());
 }
 
 ToolSet::~ToolSet()
@@ -409,6 +412,23 @@ bool ToolSet::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lResu
   return Widget::wndProc(message, wParam, lParam, lResult);
 }
 
+/**
+   Returns the map with the messages that ToolSet#wndProc handles (and
+   the ones of Widget). It is the base map for the maps of the classes
+   derived from ToolSet.
+
+   @see MessageMap, Widget#setMessageMap
+*/
+const MessageMap& ToolSet::getBaseMessageMap()
+{
+  // the same messages of the switch in wndProc
+  static const MessageMap map(typeid(ToolSet), Widget::getBaseMessageMap(), {
+      MessageMap::forward(WM_SIZE),
+      MessageMap::forward(WM_LBUTTONDOWN),
+    });
+  return map;
+}
+
 /**
    Updates the preferred sizes of the tool-set when it has different
    number of rows.
@@ -0,0 +1,43 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/ScopedLock.hpp"
+
+#include <chrono>
+#include <condition_variable>
+
+// std::condition_variable_any can wait any lockable object, so it
+// releases the Mutex of the ScopedLock directly
+class Wg::ConditionVariable::ConditionVariableImpl
+{
+  std::condition_variable_any m_cond;
+
+public:
+
+  void notifyOne()
+  {
+    m_cond.notify_one();
+  }
+
+  void notifyAll()
+  {
+    m_cond.notify_all();
+  }
+
+  void wait(ScopedLock& lock)
+  {
+    m_cond.wait(lock.getMutex());
+  }
+
+  bool waitFor(ScopedLock& lock, double seconds)
+  {
+    return m_cond.wait_for(lock.getMutex(), std::chrono::duration<double>(seconds))
+      == std::cv_status::no_timeout;
+  }
+
+};
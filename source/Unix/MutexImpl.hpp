@@ -9,7 +9,7 @@
 #include <pthread.h>
 #include <errno.h>
 
-class vaca::Mutex::MutexImpl
+class Wg::Mutex::MutexImpl
 {
   pthread_mutex_t m_handle;
 
@@ -0,0 +1,253 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Debug.hpp"
+#include "Wg/Mutex.hpp"
+#include "Wg/ScopedLock.hpp"
+#include "Wg/Slot.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <memory>
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+// Linux does not have static priorities for SCHED_OTHER, but each
+// thread has its own nice value (setpriority() with the kernel ID of
+// the thread instead of a process ID)
+#ifdef __linux__
+  #define VACA_THREAD_NICE
+  #include <sys/resource.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+// The IDs of the threads are a counter (pthread_t is not an integer
+// in all platforms), 0 is not used
+static std::atomic<Wg::ThreadId> thread_id_counter(0);
+static thread_local Wg::ThreadId current_thread_id = 0;
+
+static Wg::ThreadId get_current_thread_id()
+{
+  if (current_thread_id == 0)
+    current_thread_id = ++thread_id_counter;
+  return current_thread_id;
+}
+
+static void yield_current_thread()
+{
+  sched_yield();
+}
+
+#ifdef VACA_THREAD_NICE
+static pid_t get_current_tid()
+{
+  return static_cast<pid_t>(syscall(SYS_gettid));
+}
+#endif
+
+static void sleep_current_thread(int msecs)
+{
+  timespec time;
+  time.tv_sec = msecs / 1000;
+  time.tv_nsec = (msecs % 1000) * 1000000L;
+
+  while (nanosleep(&time, &time) == -1 && errno == EINTR)
+    ;
+}
+
+class Wg::Thread::ThreadImpl
+{
+  // The nice value of the thread. The kernel ID of a new thread is
+  // known when it starts, so a value set before that is applied by the
+  // thread itself (it is shared because the thread can outlive this
+  // object)
+  struct NiceValue {
+    Mutex mutex;
+    pid_t tid = 0;              // 0 if the thread is not running
+    int value = 0;
+    bool changed = false;
+  };
+
+  // What the new thread needs to start
+  struct StartData {
+    Slot0<void>* slot;
+    ThreadId id;
+    std::shared_ptr<NiceValue> nice;
+  };
+
+  pthread_t m_handle;
+  ThreadId m_id;
+  bool m_current;               // it is not a thread created by us
+  bool m_joined;
+  std::shared_ptr<NiceValue> m_nice;
+
+  static void* threadProxy(void* data)
+  {
+    std::unique_ptr<StartData> start(reinterpret_cast<StartData*>(data));
+    std::unique_ptr<Slot0<void> > slot_ptr(start->slot);
+
+    current_thread_id = start->id;
+
+#ifdef VACA_THREAD_NICE
+    {
+      ScopedLock hold(start->nice->mutex);
+      start->nice->tid = get_current_tid();
+      if (start->nice->changed)
+	setpriority(PRIO_PROCESS, start->nice->tid, start->nice->value);
+    }
+#endif
+
+    (*slot_ptr)();
+
+#ifdef VACA_THREAD_NICE
+    // the ID can be reused by other thread
+    {
+      ScopedLock hold(start->nice->mutex);
+      start->nice->tid = 0;
+    }
+#endif
+    return nullptr;
+  }
+
+public:
+
+  ThreadImpl()
+    : m_handle(pthread_self())
+    , m_id(get_current_thread_id())
+    , m_current(true)
+    , m_joined(false)
+    , m_nice(std::make_shared<NiceValue>())
+  {
+#ifdef VACA_THREAD_NICE
+    m_nice->tid = get_current_tid();
+#endif
+  }
+
+  explicit ThreadImpl(Slot0<void>* slot)
+    : m_id(++thread_id_counter)
+    , m_current(false)
+    , m_joined(false)
+    , m_nice(std::make_shared<NiceValue>())
+  {
+    auto start = new StartData{ slot, m_id, m_nice };
+
+    int error = pthread_create(&m_handle, nullptr, threadProxy, start);
+    if (error != 0) {
+      delete start;
+      delete slot;
+      errno = error;            // for the message of the exception
+      throw CreateThreadException();
+    }
+  }
+
+  ~ThreadImpl()
+  {
+    // the thread continues running without this object
+    if (!m_current && !m_joined)
+      pthread_detach(m_handle);
+  }
+
+  ThreadId getId() const
+  {
+    return m_id;
+  }
+
+  void join()
+  {
+    assert(!m_joined);
+
+    pthread_join(m_handle, nullptr);
+    m_joined = true;
+  }
+
+  // The priorities are distributed in the range of the scheduling
+  // policy of the thread, or in the nice values on Linux (where
+  // SCHED_OTHER does not have a range)
+  void setPriority(ThreadPriority priority)
+  {
+    // the pthread_t of a joined thread cannot be used
+    assert(!m_joined);
+    if (m_joined)
+      return;
+
+    int policy;
+    sched_param param;
+    if (pthread_getschedparam(m_handle, &policy, &param) != 0)
+      return;
+
+#ifdef SCHED_IDLE
+    if (priority == ThreadPriority::Idle) {
+      param.sched_priority = 0;
+      pthread_setschedparam(m_handle, SCHED_IDLE, &param);
+      return;
+    }
+    if (policy == SCHED_IDLE)
+      policy = SCHED_OTHER;
+#endif
+
+    // real-time priority (it needs privileges, in other case the
+    // priority of the thread is not changed)
+    if (priority == ThreadPriority::TimeCritical) {
+      param.sched_priority = sched_get_priority_max(SCHED_FIFO);
+      if (pthread_setschedparam(m_handle, SCHED_FIFO, &param) == 0)
+	return;
+    }
+    if (policy == SCHED_FIFO || policy == SCHED_RR)
+      policy = SCHED_OTHER;
+
+    int level;
+    switch (priority) {
+      case ThreadPriority::Idle:         level = 0; break;
+      case ThreadPriority::Lowest:       level = 1; break;
+      case ThreadPriority::Low:          level = 2; break;
+      case ThreadPriority::Normal:       level = 3; break;
+      case ThreadPriority::High:         level = 4; break;
+      case ThreadPriority::Highest:      level = 5; break;
+      case ThreadPriority::TimeCritical: level = 6; break;
+      default:
+	assert(false);	      // TODO throw invalid argument exception
+	return;
+    }
+
+#ifdef VACA_THREAD_NICE
+    if (policy == SCHED_OTHER) {
+      // a negative value needs privileges (or RLIMIT_NICE), in other
+      // case the nice value is not changed
+      static const int nice_values[] = { 19, 10, 5, 0, -5, -10, -20 };
+
+      param.sched_priority = 0;
+      pthread_setschedparam(m_handle, SCHED_OTHER, &param);
+      setNice(nice_values[level]);
+      return;
+    }
+#endif
+
+    int min = sched_get_priority_min(policy);
+    int max = sched_get_priority_max(policy);
+    param.sched_priority = min + (max - min) * level / 6;
+    pthread_setschedparam(m_handle, policy, &param);
+  }
+
+private:
+
+#ifdef VACA_THREAD_NICE
+  void setNice(int value)
+  {
+    ScopedLock hold(m_nice->mutex);
+
+    m_nice->value = value;
+    m_nice->changed = true;
+    if (m_nice->tid != 0)
+      setpriority(PRIO_PROCESS, m_nice->tid, value);
+  }
+#endif
+
+};
@@ -11,17 +11,23 @@
 #include "Wg/Cursor.hpp"
 #include "Wg/Debug.hpp"
 #include "Wg/Dialog.hpp"
+#include "Wg/DispatchProfiler.hpp"
 #include "Wg/DropFilesEvent.hpp"
 #include "Wg/Font.hpp"
 #include "Wg/Frame.hpp"
+#include "Wg/HangWatchdog.hpp"
 #include "Wg/Image.hpp"
 #include "Wg/KeyEvent.hpp"
 #include "Wg/Layout.hpp"
+#include "Wg/MessageMap.hpp"
 #include "Wg/MouseEvent.hpp"
 #include "Wg/PaintEvent.hpp"
+#include "Wg/PaintProfiler.hpp"
 #include "Wg/Point.hpp"
 #include "Wg/Region.hpp"
 #include "Wg/System.hpp"
+#include "Wg/Thread.hpp"
+#include "Wg/ThreadPool.hpp"
 #include "Wg/Mutex.hpp"
 #include "Wg/ScopedLock.hpp"
 #include "Wg/Command.hpp"
@@ -64,6 +70,14 @@ static void create_atom()
   }
 }
 
+// Returns the message that is posted to call onResize when the input
+// coalescing is enabled (see CurrentThread::setInputCoalescing)
+static UINT get_deferred_resize_message()
+{
+  static const UINT message = ::RegisterWindowMessage(L"Wg.DeferredResize");
+  return message;
+}
+
 // ============================================================
 // CTOR & DTOR
 // ============================================================
@@ -181,10 +195,14 @@ void Widget::initialize()
   m_hasMouse          = false;
   m_deleteAfterEvent  = false;
   m_doubleBuffered    = false;
+  m_opaque            = false;
+  m_opaqueChildren    = 0;
+  m_resizePending     = false;
   m_preferredSize     = nullptr;
   m_defWndProc        = ::DefWindowProc;
   m_destroyHandleProc = Widget_DestroyHandleProc;
   m_hbrush            = nullptr;
+  m_messageMap        = &getBaseMessageMap();
 }
 
 /**
@@ -204,6 +222,20 @@ Widget::~Widget()
 {
   assert(::IsWindow(m_handle));
 
+  // the tasks of this widget must not use it anymore
+  if (m_lifetimeToken) {
+    m_lifetimeToken->cancel();
+    delete m_lifetimeToken;
+    m_lifetimeToken = nullptr;
+  }
+
+  // the handlers of the map are members of the derived classes (which
+  // are already destroyed)
+  m_messageMap = nullptr;
+
+  // other widget can be created in the same address
+  PaintProfiler::getInstance().removeWidget(this);
+
   // Lost the focus. WARNING: if we do not make this, Dialogs will die
   // suddenly in an infinite loop when TAB key is pressed. It seems
   // like Win32 cannot handle dialog boxes, the keyboard focus, and
@@ -250,6 +282,22 @@ Widget::~Widget()
   m_handle = nullptr;
 }
 
+/**
+   Returns a token that is canceled when the widget is destroyed, so
+   the tasks that use the widget (e.g. a Task bound with Task#bindTo, or
+   the ThreadPool#postToThread calls that give the results to it) are
+   not run after its destruction.
+
+   It must be called from the thread of the widget.
+*/
+CancellationToken Widget::getLifetimeToken()
+{
+  if (!m_lifetimeToken)
+    m_lifetimeToken = new CancellationToken;
+
+  return *m_lifetimeToken;
+}
+
 // ============================================================
 // PARENT & CHILDREN RELATIONSHIP
 // ============================================================
@@ -1052,6 +1100,187 @@ void Widget::setDoubleBuffered(bool doubleBuffered)
   m_doubleBuffered = doubleBuffered;
 }
 
+/**
+   Returns true if the widget was marked as opaque.
+
+   @see setOpaque
+*/
+bool Widget::isOpaque() const
+{
+  return m_opaque;
+}
+
+/**
+   Indicates if the widget paints all the pixels of its bounds (its
+   client area in #onPaint, and its non-client area). The siblings
+   that are completely covered by opaque widgets above them (in the
+   z-order) are not painted nor invalidated.
+
+   For example, the pages of a tab control, MDI children, or panels
+   that fill their area with a background color should be opaque.
+
+   @see isOccluded
+*/
+void Widget::setOpaque(bool opaque)
+{
+  if (m_opaque == opaque)
+    return;
+
+  m_opaque = opaque;
+
+  if (m_parent != nullptr)
+    m_parent->m_opaqueChildren += (opaque ? 1: -1);
+}
+
+namespace {
+
+  // Parts of a rectangle that are not covered by other rectangles yet,
+  // kept in a fixed array (isOccluded is called in each invalidation,
+  // so it must not allocate memory)
+  class UncoveredArea {
+    enum { MaxParts = 32 };
+
+    Rect m_parts[MaxParts];
+    int m_count;
+    bool m_overflow;            // too many parts, nothing is discarded
+
+  public:
+    explicit UncoveredArea(const Rect& rc)
+      : m_count(rc.isEmpty() ? 0: 1)
+      , m_overflow(false) {
+      m_parts[0] = rc;
+    }
+
+    bool isEmpty() const {
+      return m_count == 0;
+    }
+
+    void intersect(const Rect& rc) {
+      int n = 0;
+      for (int i=0; i<m_count; ++i) {
+        Rect part = m_parts[i].createIntersect(rc);
+        if (!part.isEmpty())
+          m_parts[n++] = part;
+      }
+      m_count = n;
+    }
+
+    void subtract(const Rect& rc) {
+      if (m_overflow)
+        return;
+
+      Rect parts[MaxParts];
+      int n = 0;
+
+      for (int i=0; i<m_count; ++i) {
+        const Rect& part = m_parts[i];
+
+        if (rc.x >= part.x+part.w || part.x >= rc.x+rc.w ||
+            rc.y >= part.y+part.h || part.y >= rc.y+rc.h) {
+          if (!add(parts, n, part))
+            return;
+          continue;
+        }
+
+        // pieces above, below, on the left and on the right of "rc"
+        int y1 = max_value(part.y, rc.y);
+        int y2 = min_value(part.y+part.h, rc.y+rc.h);
+        if (!add(parts, n, Rect(part.x, part.y, part.w, y1-part.y)) ||
+            !add(parts, n, Rect(part.x, y2, part.w, part.y+part.h-y2)) ||
+            !add(parts, n, Rect(part.x, y1, rc.x-part.x, y2-y1)) ||
+            !add(parts, n, Rect(rc.x+rc.w, y1, part.x+part.w-rc.x-rc.w, y2-y1)))
+          return;
+      }
+
+      std::copy(parts, parts+n, m_parts);
+      m_count = n;
+    }
+
+  private:
+    bool add(Rect* parts, int& n, const Rect& rc) {
+      if (rc.w <= 0 || rc.h <= 0)
+        return true;
+      if (n == MaxParts) {
+        // keep the current parts (the area is considered visible)
+        m_overflow = true;
+        return false;
+      }
+      parts[n++] = rc;
+      return true;
+    }
+  };
+
+}
+
+/**
+   Returns true if the whole client area of the widget is covered by
+   opaque siblings (of the widget or of its parents) above it in the
+   z-order, or is outside the client area of its parents.
+
+   A hidden widget is not occluded (see #isVisible).
+
+   @see setOpaque
+*/
+bool Widget::isOccluded() const
+{
+  return isOccluded(Rect(getClientBounds().getSize()));
+}
+
+/**
+   Returns true if the @a rc rectangle (in client coordinates) of the
+   widget is not visible because it is covered by opaque siblings.
+
+   The z-order is not walked if neither the widget nor its parents have
+   opaque siblings (the common case), so widgets that are only clipped
+   by the client area of their parents are not occluded in that case.
+
+   @see isOccluded()
+*/
+bool Widget::isOccluded(const Rect& rc) const
+{
+  assert(::IsWindow(m_handle));
+
+  // fast exit: the number of opaque children of each parent tells us
+  // if there are opaque siblings without using the Win32 API
+  const Widget* level = this;
+  while (level->m_parent != nullptr &&
+         level->m_parent->m_opaqueChildren == (level->m_opaque ? 1: 0))
+    level = level->m_parent;
+  if (level->m_parent == nullptr)
+    return false;
+
+  // visible bounds (in screen coordinates) without the area covered
+  // by opaque siblings
+  UncoveredArea area(Rect(getAbsoluteClientBounds().getOrigin() + rc.getOrigin(), rc.getSize()));
+  HWND hwnd = m_handle;
+
+  while (!area.isEmpty() &&
+         (::GetWindowLong(hwnd, GWL_STYLE) & WS_CHILD) != 0) {
+    HWND parent = ::GetParent(hwnd);
+    if (parent == nullptr)
+      break;
+
+    // siblings above "hwnd" in the z-order
+    for (HWND sibling = ::GetWindow(hwnd, GW_HWNDPREV);
+         sibling != nullptr && !area.isEmpty();
+         sibling = ::GetWindow(sibling, GW_HWNDPREV)) {
+      Widget* widget = Widget::fromHandle(sibling);
+      if (widget != nullptr && widget->m_opaque && ::IsWindowVisible(sibling))
+        area.subtract(widget->getAbsoluteBounds());
+    }
+
+    // clip with the client area of the parent
+    RECT parentRc;
+    ::GetClientRect(parent, &parentRc);
+    ::MapWindowPoints(parent, nullptr, reinterpret_cast<LPPOINT>(&parentRc), 2);
+    area.intersect(convert_to<Rect>(parentRc));
+
+    hwnd = parent;
+  }
+
+  return area.isEmpty();
+}
+
 /**
    Validates the entire widget.
 
@@ -1092,11 +1321,19 @@ void Widget::validate(const Rect& _rc)
        true means that the background should be erased
        (with a WM_ERASEBKGND message).
 
+   Nothing is invalidated if the widget is covered by opaque siblings
+   (see #isOccluded). Hidden widgets are invalidated as usual.
+
    @see validate, invalidate(const Rect&, bool), update
 */
 void Widget::invalidate(bool eraseBg)
 {
   assert(::IsWindow(m_handle));
+
+  // a covered widget does not need to be repainted
+  if (isOccluded())
+    return;
+
   ::InvalidateRect(m_handle, nullptr, eraseBg);
 }
 
@@ -1116,6 +1353,9 @@ void Widget::invalidate(bool eraseBg)
        the background color specified by #getBgColor (with a
        WM_ERASEBKGND message for example).
 
+   Nothing is invalidated if the area is covered by opaque siblings
+   (see #isOccluded(const Rect&) const).
+
    @see invalidate(bool), #update
 */
 void Widget::invalidate(const Rect& _rc, bool eraseBg)
@@ -1123,6 +1363,11 @@ void Widget::invalidate(const Rect& _rc, bool eraseBg)
   RECT rc = convert_to<RECT>(_rc);
 
   assert(::IsWindow(m_handle));
+
+  // a covered area does not need to be repainted
+  if (isOccluded(_rc))
+    return;
+
   ::InvalidateRect(m_handle, &rc, eraseBg);
 }
 
@@ -2283,6 +2528,8 @@ void Widget::addChildWin32(Widget* child, bool setParent)
 
   m_children.push_back(child);
   child->m_parent = this;
+  if (child->m_opaque)
+    ++m_opaqueChildren;
 
   if (setParent) {
     child->addStyle(Style(WS_CHILD, 0));
@@ -2320,6 +2567,8 @@ void Widget::removeChildWin32(Widget* child, bool setParent)
   }
 
   child->m_parent = nullptr;
+  if (child->m_opaque)
+    --m_opaqueChildren;
 }
 
 /**
@@ -2534,6 +2783,21 @@ bool Widget::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lResul
 {
   bool ret = false;
 
+  // the last WM_SIZE of a sequence
+  if (message == get_deferred_resize_message()) {
+    if (m_resizePending) {
+      m_resizePending = false;
+
+      RECT rc;
+      ::GetClientRect(m_handle, &rc);
+      ResizeEvent ev(this, Size(rc.right, rc.bottom));
+      onResize(ev);
+    }
+    lResult = 0;
+    return true;
+  }
+
+  // the messages of this switch are forwarded by getBaseMessageMap()
   switch (message) {
 
     case WM_ERASEBKGND:
@@ -2563,6 +2827,15 @@ bool Widget::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lResul
       if (m_baseWndProc == nullptr) {
 	// ...we have to paint its content through an explicit onPaint event
 
+	// if the widget is completely covered by opaque siblings, we
+	// validate it without painting it
+	if (isOccluded()) {
+	  ::ValidateRect(m_handle, nullptr);
+	  lResult = 0;
+	  ret = true;
+	  break;
+	}
+
 	PAINTSTRUCT ps;
 	bool painted = false;
 	HDC hdc = ::BeginPaint(m_handle, &ps);
@@ -2579,6 +2852,13 @@ bool Widget::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lResul
 	  ret = true;
 	}
       }
+      // a wrapped widget is painted by its original WNDPROC, here we
+      // can only record the area that will be painted
+      else if (PaintProfiler::getInstance().isEnabled()) {
+	RECT rc;
+	if (::GetUpdateRect(m_handle, &rc, FALSE))
+	  PaintProfiler::getInstance().addPaint(this, convert_to<Rect>(rc), 0.0);
+      }
       break;
 
     case WM_DRAWITEM: {
@@ -2600,6 +2880,16 @@ bool Widget::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lResul
     }
 
     case WM_SIZE: {
+      // consecutive resizes are collapsed in one onResize (the
+      // deferred message is posted only once)
+      if (CurrentThread::isInputCoalescing()) {
+	if (!m_resizePending) {
+	  m_resizePending = true;
+	  ::PostMessage(m_handle, get_deferred_resize_message(), 0, 0);
+	}
+	break;
+      }
+
       ResizeEvent ev(this, Size(LOWORD(lParam), HIWORD(lParam)));
       onResize(ev);
       break;
@@ -2712,6 +3002,12 @@ bool Widget::wndProc(UINT message, WPARAM wParam, LPARAM lParam, LRESULT& lResul
 	   wParam,				    // flags
 	   MouseButton::None);			    // button
 
+      // positions of the mouse of a coalesced message
+      const std::vector<Point>* history =
+	CurrentThread::details::getMouseHistory(m_handle, lParam);
+      if (history != nullptr)
+	ev.setHistory(&history->front(), static_cast<int>(history->size()));
+
       if (!m_hasMouse) {
 	m_hasMouse = true;
 	onMouseEnter(ev);
@@ -3017,6 +3313,8 @@ LRESULT Widget::defWndProc(UINT message, WPARAM wParam, LPARAM lParam)
 */
 bool Widget::doPaint(Graphics& g)
 {
+  // measure this paint (only if the PaintProfiler is enabled)
+  PaintProfiler::Scope profilerScope(this, g);
   bool painted = false;
 
   // use double-buffering technique?
@@ -3104,6 +3402,79 @@ void Widget::setDestroyHandleProc(void (*proc)(HWND))
   m_destroyHandleProc = proc;
 }
 
+/**
+   Sets the table used to dispatch the messages of this widget. It
+   should be called from the constructor of the class of @a map, and
+   @a map must live while the widget exists (usually it is a static
+   variable). The map is not used if the widget is of a class derived
+   from the class of the map (see MessageMap#isMapOf).
+
+   @see MessageMap, getBaseMessageMap
+*/
+void Widget::setMessageMap(const MessageMap& map)
+{
+  m_messageMap = &map;
+}
+
+/**
+   Returns the map used to dispatch the messages of this widget, or
+   nullptr if all the messages are passed to #wndProc.
+*/
+const MessageMap* Widget::getMessageMap() const
+{
+  return m_messageMap;
+}
+
+/**
+   Returns the map with the messages that Widget#wndProc handles. It is
+   used by the widgets of the Widget class, and it is the base map for
+   the maps of the classes derived from Widget.
+
+   @see MessageMap
+*/
+const MessageMap& Widget::getBaseMessageMap()
+{
+  // the same messages of the switch in wndProc
+  static const MessageMap map(typeid(Widget), {
+      MessageMap::forward(WM_ERASEBKGND),
+      MessageMap::forward(WM_PAINT),
+      MessageMap::forward(WM_DRAWITEM),
+      MessageMap::forward(WM_SIZE),
+      MessageMap::forward(WM_SETCURSOR),
+      MessageMap::forward(WM_LBUTTONDOWN),
+      MessageMap::forward(WM_RBUTTONDOWN),
+      MessageMap::forward(WM_MBUTTONDOWN),
+      MessageMap::forward(WM_LBUTTONUP),
+      MessageMap::forward(WM_MBUTTONUP),
+      MessageMap::forward(WM_RBUTTONUP),
+      MessageMap::forward(WM_LBUTTONDBLCLK),
+      MessageMap::forward(WM_MBUTTONDBLCLK),
+      MessageMap::forward(WM_RBUTTONDBLCLK),
+      MessageMap::forward(WM_MOUSEMOVE),
+      MessageMap::forward(WM_MOUSEWHEEL),
+      MessageMap::forward(WM_MOUSELEAVE),
+      MessageMap::forward(WM_KEYDOWN),
+      MessageMap::forward(WM_CHAR),
+      MessageMap::forward(WM_KEYUP),
+      MessageMap::forward(WM_COMMAND),
+      MessageMap::forward(WM_NOTIFY),
+      MessageMap::forward(WM_SETFOCUS),
+      MessageMap::forward(WM_KILLFOCUS),
+      MessageMap::forward(WM_CTLCOLORBTN),
+      MessageMap::forward(WM_CTLCOLORDLG),
+      MessageMap::forward(WM_CTLCOLOREDIT),
+      MessageMap::forward(WM_CTLCOLORLISTBOX),
+      MessageMap::forward(WM_CTLCOLORMSGBOX),
+      MessageMap::forward(WM_CTLCOLORSCROLLBAR),
+      MessageMap::forward(WM_CTLCOLORSTATIC),
+      MessageMap::forward(WM_VSCROLL),
+      MessageMap::forward(WM_HSCROLL),
+      MessageMap::forward(WM_DROPFILES),
+      MessageMap::forward(get_deferred_resize_message()),
+    });
+  return map;
+}
+
 /**
    Sends a message to the widget.
 
@@ -3331,6 +3702,20 @@ LRESULT CALLBACK Widget::globalWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARA
 
     MakeWidgetRef ref(widget);
 
+#ifdef VACA_DISPATCH_PROFILER
+    DispatchProfiler::Scope profile(msg, typeid(*widget));
+#endif
+
+    // heartbeat of the UI thread (the RTTI lookup is done only if a
+    // watchdog is attached)
+    HangWatchdog::Scope watch(msg, wParam, lParam, widget,
+                              HangWatchdog::getCurrent() != nullptr ? &typeid(*widget): nullptr);
+
+    // the class of the widget knows which messages it handles
+    if (widget->m_messageMap != nullptr &&
+        widget->m_messageMap->isMapOf(widget))
+      return widget->m_messageMap->dispatch(widget, msg, wParam, lParam);
+
     // window procedures
     used = widget->wndProc(msg, wParam, lParam, lResult);
     if (!used)
@@ -0,0 +1,127 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#ifndef _WIN32_WINNT
+#define _WIN32_WINNT 0x0400
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include "Wg/Font.hpp"
+#include "Wg/Rect.hpp"
+
+#include <vector>
+
+namespace Wg {
+
+// Selects the font in a memory DC for the lifetime of the object
+class GlyphDC
+{
+  HDC m_hdc;
+  HGDIOBJ m_oldFont;
+
+public:
+
+  explicit GlyphDC(const Font& font)
+  {
+    m_hdc = CreateCompatibleDC(nullptr);
+    m_oldFont = SelectObject(m_hdc, font.getHandle());
+  }
+
+  ~GlyphDC()
+  {
+    SelectObject(m_hdc, m_oldFont);
+    DeleteDC(m_hdc);
+  }
+
+  HDC getHandle() const { return m_hdc; }
+
+};
+
+// Division rounding towards negative infinity
+static inline int floor_div(int a, int b)
+{
+  return (a >= 0) ? a / b: -((-a + b - 1) / b);
+}
+
+static void get_glyph_font_metrics(const Font& font, int& ascent, int& height)
+{
+  GlyphDC dc(font);
+  TEXTMETRIC tm;
+
+  if (GetTextMetrics(dc.getHandle(), &tm)) {
+    ascent = tm.tmAscent;
+    height = tm.tmHeight;
+  }
+  else
+    ascent = height = 0;
+}
+
+// Rasterizes the character "chr" scaled horizontally by "steps" with
+// GetGlyphOutline(GGO_GRAY8_BITMAP), and reduces it to its real width
+// shifted "subpixel" steps to the right. The mask is returned in
+// "mask" (one byte per pixel, "bounds.w" bytes per row), "bounds"
+// is relative to the pen position (the pen on the baseline) and
+// "advance" is in 1/steps pixel units.
+static bool rasterize_glyph_impl(const Font& font, Char chr, int subpixel, int steps,
+                                 Rect& bounds, int& advance, std::vector<unsigned char>& mask)
+{
+  GlyphDC dc(font);
+  GLYPHMETRICS gm;
+  MAT2 mat;
+
+  ZeroMemory(&mat, sizeof(MAT2));
+  mat.eM11.value = static_cast<short>(steps);
+  mat.eM22.value = 1;
+
+  DWORD size = GetGlyphOutlineW(dc.getHandle(), chr, GGO_GRAY8_BITMAP,
+                                &gm, 0, nullptr, &mat);
+  if (size == GDI_ERROR)
+    return false;
+
+  advance = gm.gmCellIncX;
+  bounds = Rect();
+  mask.clear();
+
+  // Blank glyph (e.g. space)
+  if (size == 0)
+    return true;
+
+  std::vector<BYTE> hires(size);
+  if (GetGlyphOutlineW(dc.getHandle(), chr, GGO_GRAY8_BITMAP,
+                       &gm, size, &hires[0], &mat) == GDI_ERROR)
+    return false;
+
+  const int hiresW = gm.gmBlackBoxX;
+  const int hiresH = gm.gmBlackBoxY;
+  const int pitch = (hiresW + 3) & ~3; // Rows are DWORD aligned
+  const int x0 = gm.gmptGlyphOrigin.x + subpixel;
+  const int u0 = floor_div(x0, steps);
+  const int u1 = floor_div(x0 + hiresW - 1, steps);
+
+  bounds = Rect(u0, -gm.gmptGlyphOrigin.y, u1 - u0 + 1, hiresH);
+
+  // Each output pixel sums "steps" samples from 0 to 64
+  std::vector<int> sum(bounds.w * bounds.h, 0);
+  for (int y=0; y<hiresH; ++y) {
+    const BYTE* src = &hires[y*pitch];
+    int* dst = &sum[y*bounds.w];
+
+    for (int x=0; x<hiresW; ++x)
+      dst[floor_div(x0 + x, steps) - u0] += src[x];
+  }
+
+  const int maxSum = 64 * steps;
+  mask.resize(sum.size());
+  for (size_t i=0; i<sum.size(); ++i)
+    mask[i] = static_cast<unsigned char>(min_value(sum[i], maxSum) * 255 / maxSum);
+
+  return true;
+}
+
+} // namespace Wg
@@ -0,0 +1,150 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#pragma once
+
+#include "Wg/Debug.hpp"
+#include "Wg/QueuedCall.hpp"
+#include "Wg/Slot.hpp"
+
+#include <memory>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+static Wg::ThreadId get_current_thread_id()
+{
+  return ::GetCurrentThreadId();
+}
+
+static void yield_current_thread()
+{
+  ::Sleep(0);
+}
+
+static void sleep_current_thread(int msecs)
+{
+  ::Sleep(static_cast<DWORD>(msecs));
+}
+
+class Wg::Thread::ThreadImpl
+{
+  HANDLE m_handle;
+  ThreadId m_id;
+  bool m_current;               // m_handle is the pseudo-handle of the current thread
+
+  // What the constructor gives to the new thread
+  struct StartData {
+    Slot0<void>* slot;
+    HANDLE queueReady;          // signaled when the thread has a message queue
+  };
+
+  static DWORD WINAPI threadProxy(LPVOID param)
+  {
+    // The StartData lives in the stack of the constructor, it is
+    // valid only until queueReady is signaled
+    Slot0<void>* slot = reinterpret_cast<StartData*>(param)->slot;
+
+    // Force the creation of a message queue in this new thread (so
+    // the calls and messages posted after the constructor returns are
+    // not lost)...
+    {
+      MSG msg;
+      PeekMessage(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+      SetEvent(reinterpret_cast<StartData*>(param)->queueReady);
+    }
+
+    // ...and free the queued calls that were not delivered when it
+    // finishes (even if the slot throws an exception)
+    struct DiscardPending {
+      ~DiscardPending() { QueuedCall::discardPending(); }
+    } discardPending;
+
+    std::unique_ptr<Slot0<void> > slot_ptr(slot);
+    (*slot_ptr)();
+    return 0;
+  }
+
+public:
+
+  ThreadImpl()
+    : m_handle(::GetCurrentThread())
+    , m_id(::GetCurrentThreadId())
+    , m_current(true)
+  {
+  }
+
+  explicit ThreadImpl(Slot0<void>* slot)
+    : m_current(false)
+  {
+    DWORD id;
+    StartData data = { slot, CreateEvent(nullptr, TRUE, FALSE, nullptr) };
+    if (!data.queueReady) {
+      delete slot;
+      throw CreateThreadException();
+    }
+
+    m_handle = CreateThread(nullptr, 0,
+			    threadProxy,
+			    reinterpret_cast<LPVOID>(&data),
+			    CREATE_SUSPENDED, &id);
+    if (!m_handle) {
+      CloseHandle(data.queueReady);
+      delete slot;
+      throw CreateThreadException();
+    }
+
+    m_id = id;
+    ResumeThread(m_handle);
+
+    // Wait the message queue of the thread, so QueuedCall::post() and
+    // Thread::enqueueMessage() work as soon as the Thread exists
+    WaitForSingleObject(data.queueReady, INFINITE);
+    CloseHandle(data.queueReady);
+  }
+
+  ~ThreadImpl()
+  {
+    if (!m_current && m_handle != nullptr)
+      CloseHandle(m_handle);
+  }
+
+  ThreadId getId() const
+  {
+    return m_id;
+  }
+
+  void join()
+  {
+    assert(m_handle != nullptr);
+
+    WaitForSingleObject(m_handle, INFINITE);
+    CloseHandle(m_handle);
+    m_handle = nullptr;
+  }
+
+  void setPriority(ThreadPriority priority)
+  {
+    assert(m_handle != nullptr);
+
+    int nPriority;
+    switch (priority) {
+      case ThreadPriority::Idle:         nPriority = THREAD_PRIORITY_IDLE; break;
+      case ThreadPriority::Lowest:       nPriority = THREAD_PRIORITY_LOWEST; break;
+      case ThreadPriority::Low:          nPriority = THREAD_PRIORITY_BELOW_NORMAL; break;
+      case ThreadPriority::Normal:       nPriority = THREAD_PRIORITY_NORMAL; break;
+      case ThreadPriority::High:         nPriority = THREAD_PRIORITY_ABOVE_NORMAL; break;
+      case ThreadPriority::Highest:      nPriority = THREAD_PRIORITY_HIGHEST; break;
+      case ThreadPriority::TimeCritical: nPriority = THREAD_PRIORITY_TIME_CRITICAL; break;
+      default:
+	assert(false);	      // TODO throw invalid argument exception
+	return;
+    }
+
+    ::SetThreadPriority(m_handle, nPriority);
+  }
+
+};
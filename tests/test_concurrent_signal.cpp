@@ -0,0 +1,187 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+#include "Wg/ConcurrentSignal.hpp"
+#include "Wg/Thread.hpp"
+
+using namespace Wg;
+
+typedef ConcurrentSignal<void(int)> IntSignal;
+
+// A slot that checks that it is not called after it was disconnected
+struct Receiver {
+  IntSignal* signal = nullptr;
+  std::atomic<bool> disconnected{ false };
+  std::atomic<int> running{ 0 };
+  std::atomic<int> calls{ 0 };
+  std::atomic<int> lateCalls{ 0 };  // calls after disconnect() returned
+
+  void onValue(int) {
+    ++running;
+    if (disconnected)
+      ++lateCalls;
+    ++calls;
+    CurrentThread::yield();     // make the calls longer
+    --running;
+  }
+
+  void onValueOnce(int value) {
+    onValue(value);
+    signal->disconnect(&Receiver::onValueOnce, this);
+  }
+};
+
+static void test_connect_and_emit()
+{
+  IntSignal signal;
+  Receiver a, b;
+
+  assert(signal.empty());
+  signal.connect(&Receiver::onValue, &a);
+  signal.connect(&Receiver::onValue, &b);
+  assert(signal.getSlotCount() == 2);
+
+  signal(1);
+  assert(a.calls == 1 && b.calls == 1);
+
+  signal.disconnect(&Receiver::onValue, &a);
+  signal(1);
+  assert(a.calls == 1 && b.calls == 2);
+
+  signal.disconnectAll();
+  assert(signal.empty());
+
+  ConcurrentSignal<int(int)> result;
+  assert(result(1) == 0);
+  result.connect([](int value) { return value + 1; });
+  result.connect([](int value) { return value * 10; });
+  assert(result(4) == 40);
+}
+
+// A slot that disconnects itself is not called again, and the other
+// slots of the emission are called
+static void test_disconnect_itself()
+{
+  IntSignal signal;
+  Receiver once, other;
+  once.signal = &signal;
+
+  signal.connect(&Receiver::onValueOnce, &once);
+  signal.connect(&Receiver::onValue, &other);
+
+  signal(1);
+  assert(once.calls == 1 && other.calls == 1);
+  assert(signal.getSlotCount() == 1);
+
+  signal(1);
+  assert(once.calls == 1 && other.calls == 2);
+}
+
+// Several threads emit the signal while other thread connects and
+// disconnects slots: a slot is never called (or running) after
+// disconnect() returns
+static void test_emit_while_connecting()
+{
+  const int Emitters = 4;
+  const int Rounds = 200;
+
+  IntSignal signal;
+  Receiver permanent;
+  std::atomic<bool> done(false);
+  std::atomic<int> emissions(0);
+
+  signal.connect(&Receiver::onValue, &permanent);
+
+  std::vector<Thread*> emitters;
+  for (int i=0; i<Emitters; ++i) {
+    emitters.push_back(new Thread([&signal, &done, &emissions] {
+      while (!done) {
+        signal(1);
+        ++emissions;
+      }
+    }));
+  }
+
+  for (int round=0; round<Rounds; ++round) {
+    std::vector<Receiver> receivers(4);
+    for (Receiver& receiver : receivers) {
+      receiver.signal = &signal;
+      signal.connect(&Receiver::onValue, &receiver);
+    }
+
+    // wait some emissions with the new slots
+    int start = emissions;
+    while (emissions - start < Emitters * 2)
+      CurrentThread::yield();
+
+    for (Receiver& receiver : receivers) {
+      signal.disconnect(&Receiver::onValue, &receiver);
+      receiver.disconnected = true;
+      assert(receiver.running == 0);
+    }
+
+    // let the emitters run with the old snapshots
+    start = emissions;
+    while (emissions - start < Emitters * 2)
+      CurrentThread::yield();
+
+    for (Receiver& receiver : receivers)
+      assert(receiver.lateCalls == 0);
+  }
+
+  done = true;
+  for (Thread* thread : emitters) {
+    thread->join();
+    delete thread;
+  }
+
+  assert(permanent.calls == emissions);
+  assert(signal.getSlotCount() == 1);
+}
+
+// Slots that disconnect themselves from several threads at the same
+// time
+static void test_disconnect_itself_concurrently()
+{
+  const int Emitters = 4;
+
+  for (int round=0; round<100; ++round) {
+    IntSignal signal;
+    std::vector<Receiver> receivers(8);
+    for (Receiver& receiver : receivers) {
+      receiver.signal = &signal;
+      signal.connect(&Receiver::onValueOnce, &receiver);
+    }
+
+    std::vector<Thread*> emitters;
+    for (int i=0; i<Emitters; ++i)
+      emitters.push_back(new Thread([&signal] { signal(1); }));
+
+    for (Thread* thread : emitters) {
+      thread->join();
+      delete thread;
+    }
+
+    assert(signal.empty());
+    for (Receiver& receiver : receivers) {
+      assert(receiver.calls >= 0 && receiver.calls <= Emitters);
+      assert(receiver.running == 0);
+    }
+  }
+}
+
+int main()
+{
+  test_connect_and_emit();
+  test_disconnect_itself();
+  test_emit_while_connecting();
+  test_disconnect_itself_concurrently();
+  return 0;
+}
@@ -0,0 +1,304 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <cassert>
+#include <vector>
+
+#include "Wg/Connection.hpp"
+#include "Wg/Referenceable.hpp"
+#include "Wg/SignalN.hpp"
+
+using namespace Wg;
+
+typedef SignalN<void(int)> IntSignal;
+
+// Records the IDs of the slots that were called
+struct Recorder {
+  std::vector<int>* log;
+  int id;
+
+  void operator()(int) { log->push_back(id); }
+};
+
+static void test_disconnect()
+{
+  std::vector<int> log;
+  IntSignal signal;
+
+  Connection a = signal.connect(Recorder{ &log, 1 });
+  Connection b = signal.connect(Recorder{ &log, 2 });
+  assert(a.isConnected() && b.isConnected());
+
+  // a copy is a handle of the same slot
+  Connection copy = a;
+  copy.disconnect();
+  assert(!copy.isConnected());
+  assert(!a.isConnected());
+  assert(b.isConnected());
+  assert(signal.getSlotCount() == 1);
+
+  // disconnecting again does nothing
+  a.disconnect();
+  assert(signal.getSlotCount() == 1);
+
+  signal(0);
+  assert((log == std::vector<int>{ 2 }));
+
+  Connection empty;
+  assert(!empty.isConnected());
+  empty.disconnect();
+}
+
+// The handle of a disconnected slot does not match the new slot that
+// reuses its index
+static void test_generation()
+{
+  std::vector<int> log;
+  IntSignal signal;
+
+  Connection stale = signal.connect(Recorder{ &log, 1 });
+  Connection copy = stale;
+  stale.disconnect();
+
+  Connection reused = signal.connect(Recorder{ &log, 2 });
+  assert(reused.isConnected());
+  assert(!copy.isConnected());
+
+  copy.disconnect();            // it must not remove the new slot
+  assert(reused.isConnected());
+  assert(signal.getSlotCount() == 1);
+
+  signal(0);
+  assert((log == std::vector<int>{ 2 }));
+
+  // many generations of the same index
+  for (int i=0; i<100; ++i) {
+    Connection old = reused;
+    reused.disconnect();
+    reused = signal.connect(Recorder{ &log, 3 });
+    assert(!old.isConnected());
+    old.disconnect();
+    assert(reused.isConnected());
+  }
+  assert(signal.getSlotCount() == 1);
+}
+
+// Disconnecting most slots compacts the table, the handles of the
+// other slots still work
+static void test_compaction()
+{
+  std::vector<int> log;
+  IntSignal signal;
+  std::vector<Connection> connections;
+
+  for (int i=0; i<100; ++i)
+    connections.push_back(signal.connect(Recorder{ &log, i }));
+
+  for (int i=0; i<100; ++i)
+    if (i % 10 != 0)
+      connections[i].disconnect();
+  assert(signal.getSlotCount() == 10);
+
+  for (int i=0; i<100; ++i)
+    assert(connections[i].isConnected() == (i % 10 == 0));
+
+  signal(0);
+  assert((log == std::vector<int>{ 0, 10, 20, 30, 40, 50, 60, 70, 80, 90 }));
+
+  connections[50].disconnect();
+  log.clear();
+  signal(0);
+  assert((log == std::vector<int>{ 0, 10, 20, 30, 40, 60, 70, 80, 90 }));
+}
+
+// A slot that disconnects the other slots while the signal is
+// emitted: the slots are not called and the table is compacted when
+// the emission finishes
+struct Disconnector {
+  std::vector<Connection>* connections;
+  std::vector<int>* log;
+
+  void operator()(int) {
+    log->push_back(-1);
+    for (std::size_t i=0; i<connections->size(); ++i)
+      if (i % 4 != 0)
+        (*connections)[i].disconnect();
+  }
+};
+
+static void test_compaction_while_emitting()
+{
+  std::vector<int> log;
+  IntSignal signal;
+  std::vector<Connection> connections;
+
+  Connection disconnector = signal.connect(Disconnector{ &connections, &log });
+  for (int i=0; i<40; ++i)
+    connections.push_back(signal.connect(Recorder{ &log, i }));
+
+  signal(0);
+  assert(log.size() == 11);
+  assert(log[0] == -1);
+  for (int i=0; i<10; ++i)
+    assert(log[i+1] == i*4);
+  assert(signal.getSlotCount() == 11);
+
+  // the handles are still valid after the compaction
+  assert(disconnector.isConnected());
+  disconnector.disconnect();
+  for (int i=0; i<40; ++i)
+    assert(connections[i].isConnected() == (i % 4 == 0));
+
+  connections[0].disconnect();
+  log.clear();
+  signal(0);
+  assert((log == std::vector<int>{ 4, 8, 12, 16, 20, 24, 28, 32, 36 }));
+}
+
+// A slot that disconnects itself during the emission
+struct Once {
+  Connection* self;
+  std::vector<int>* log;
+
+  void operator()(int) {
+    log->push_back(0);
+    self->disconnect();
+  }
+};
+
+static void test_disconnect_itself()
+{
+  std::vector<int> log;
+  IntSignal signal;
+
+  Connection once;
+  once = signal.connect(Once{ &once, &log });
+  signal.connect(Recorder{ &log, 1 });
+
+  signal(0);
+  signal(0);
+  assert((log == std::vector<int>{ 0, 1, 1 }));
+  assert(signal.getSlotCount() == 1);
+}
+
+static void test_scoped_connection()
+{
+  std::vector<int> log;
+  IntSignal signal;
+
+  {
+    ScopedConnection scoped(signal.connect(Recorder{ &log, 1 }));
+    assert(scoped.isConnected());
+    assert(signal.getSlotCount() == 1);
+  }
+  assert(signal.getSlotCount() == 0);
+
+  // the assignment disconnects the previous slot
+  Connection second;
+  {
+    ScopedConnection scoped;
+    assert(!scoped.isConnected());
+    scoped = signal.connect(Recorder{ &log, 1 });
+    Connection first = scoped.getConnection();
+    scoped = signal.connect(Recorder{ &log, 2 });
+    assert(!first.isConnected());
+    second = scoped.getConnection();
+    assert(second.isConnected());
+  }
+  assert(!second.isConnected());
+  assert(signal.empty());
+
+  // a released connection is not disconnected
+  Connection released;
+  {
+    ScopedConnection scoped(signal.connect(Recorder{ &log, 3 }));
+    released = scoped.release();
+    assert(!scoped.isConnected());
+  }
+  assert(released.isConnected());
+
+  signal(0);
+  assert((log == std::vector<int>{ 3 }));
+}
+
+struct View : public Referenceable {
+  std::vector<int>* log;
+
+  explicit View(std::vector<int>* log) : log(log) { }
+  void onValue(int value) { log->push_back(value); }
+};
+
+// The connections that track a Referenceable are disconnected when it
+// is destroyed
+static void test_track()
+{
+  std::vector<int> log;
+  IntSignal signal;
+  IntSignal other;
+
+  View* view = new View(&log);
+  Connection conn = signal.connect(&View::onValue, view).track(view);
+  other.connect(&View::onValue, view).track(view);
+  Connection untracked = signal.connect(Recorder{ &log, 2 });
+
+  signal(1);
+  other(3);
+  assert((log == std::vector<int>{ 1, 2, 3 }));
+
+  delete view;
+  assert(!conn.isConnected());
+  assert(untracked.isConnected());
+  assert(signal.getSlotCount() == 1);
+  assert(other.empty());
+
+  log.clear();
+  signal(1);
+  other(3);
+  assert((log == std::vector<int>{ 2 }));
+
+  // the tracked connection of a signal that was already destroyed
+  View* view2 = new View(&log);
+  {
+    IntSignal temporal;
+    temporal.connect(&View::onValue, view2).track(view2);
+  }
+  delete view2;
+}
+
+// A connection can be kept after its signal is destroyed
+static void test_outlive_signal()
+{
+  std::vector<int> log;
+  Connection conn;
+  ScopedConnection scoped;
+  {
+    IntSignal signal;
+    conn = signal.connect(Recorder{ &log, 1 });
+    scoped = signal.connect(Recorder{ &log, 2 });
+    assert(conn.isConnected());
+  }
+  assert(!conn.isConnected());
+  assert(!scoped.isConnected());
+
+  Connection copy = conn;
+  conn.disconnect();
+  assert(!copy.isConnected());
+  copy.disconnect();
+  // scoped is destroyed after the signal (it does nothing)
+}
+
+int main()
+{
+  test_disconnect();
+  test_generation();
+  test_compaction();
+  test_compaction_while_emitting();
+  test_disconnect_itself();
+  test_scoped_connection();
+  test_track();
+  test_outlive_signal();
+  return 0;
+}
@@ -0,0 +1,64 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <cassert>
+
+#include "Wg/GraphicsPath.hpp"
+#include "Wg/PathRasterizer.hpp"
+
+using namespace Wg;
+
+static void make_triangle(GraphicsPath &path)
+{
+  path.moveTo(1, 1);
+  path.lineTo(20, 4);
+  path.lineTo(8, 16);
+  path.closeFigure();
+}
+
+// Each access to the cache counts just one hit or one miss (the
+// figures used to rasterize the path are not counted again)
+static void test_cache_counters()
+{
+  GraphicsPath path;
+  make_triangle(path);
+
+  path.getFillRasterizer();
+  assert(path.getCacheMisses() == 1);
+  assert(path.getCacheHits() == 0);
+
+  path.getFillRasterizer();
+  assert(path.getCacheMisses() == 1);
+  assert(path.getCacheHits() == 1);
+
+  path.getStrokeRasterizer(2.0, PenJoin::Miter, PenEndCap::Flat);
+  assert(path.getCacheMisses() == 2);
+  assert(path.getCacheHits() == 1);
+
+  // the figures were flattened by the first rasterizer
+  path.getFigures();
+  assert(path.getCacheMisses() == 2);
+  assert(path.getCacheHits() == 2);
+}
+
+// Modifying the path discards the cached cells
+static void test_invalidation()
+{
+  GraphicsPath path;
+  make_triangle(path);
+
+  int cells = path.getFillRasterizer().getCellCount();
+  path.lineTo(30, 30);
+  assert(path.getFillRasterizer().getCellCount() != cells);
+  assert(path.getCacheMisses() == 2);
+}
+
+int main()
+{
+  test_cache_counters();
+  test_invalidation();
+  return 0;
+}
@@ -0,0 +1,257 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Wg/HangWatchdog.hpp"
+#include "Wg/Thread.hpp"
+
+using namespace Wg;
+using namespace std::chrono_literals;
+
+typedef HangWatchdog::Nanoseconds Nanoseconds;
+
+// Simulated time of the watchdogs (it is read from the watchdog
+// thread in test_thread)
+static std::atomic<long long> fake_now(0);
+
+static Nanoseconds fake_clock()
+{
+  return Nanoseconds(fake_now.load());
+}
+
+static void advance(Nanoseconds time)
+{
+  fake_now += time.count();
+}
+
+// A message loop that processes the messages that it is given, the
+// time of each message is simulated with the fake clock
+struct FakePump {
+  HangWatchdog& watchdog;
+
+  // Processes a message that takes "time" without nested messages
+  void process(unsigned message, Nanoseconds time) {
+    watchdog.beginMessage(message, 0, 0);
+    advance(time);
+    watchdog.endMessage();
+  }
+
+  void idle(Nanoseconds time) {
+    advance(time);
+  }
+};
+
+// Records the reports of the Stall signal
+struct StallLog {
+  std::vector<StallReport> reports;
+
+  explicit StallLog(HangWatchdog& watchdog) {
+    watchdog.Stall.connect([this](const StallReport& report) {
+      reports.push_back(report);
+    });
+  }
+};
+
+static void test_under_threshold()
+{
+  HangWatchdog watchdog(fake_clock);
+  watchdog.setThreshold(100ms);
+  StallLog log(watchdog);
+  FakePump pump{ watchdog };
+
+  for (int i=0; i<10; ++i) {
+    pump.process(1, 50ms);
+    assert(!watchdog.check());
+    pump.idle(500ms);            // idle time is not a stall
+    assert(!watchdog.check());
+  }
+
+  watchdog.beginMessage(2, 0, 0);
+  advance(99ms);
+  assert(!watchdog.check());
+  watchdog.endMessage();
+
+  assert(watchdog.getStallCount() == 0);
+  assert(log.reports.empty());
+}
+
+static void test_stall_reported_once()
+{
+  HangWatchdog watchdog(fake_clock);
+  watchdog.setThreshold(100ms);
+  StallLog log(watchdog);
+  FakePump pump{ watchdog };
+
+  pump.process(1, 10ms);
+  pump.process(1, 10ms);
+  pump.idle(30ms);
+
+  watchdog.beginMessage(7, 8, -9);
+  advance(150ms);
+  assert(watchdog.check());
+  advance(150ms);
+  assert(!watchdog.check());     // the same stall is not reported again
+  watchdog.endMessage();
+  assert(!watchdog.check());
+
+  assert(watchdog.getStallCount() == 1);
+  assert(log.reports.size() == 1);
+
+  const StallReport& report = log.reports[0];
+  assert(report.duration == 150ms);
+  assert(report.idleBefore == 30ms);
+  assert(report.messageCount == 2);
+  assert(report.frames.size() == 1);
+  assert(report.frames[0].message == 7);
+  assert(report.frames[0].wParam == 8);
+  assert(report.frames[0].lParam == -9);
+  assert(report.frames[0].elapsed == 150ms);
+  assert(report.frames[0].self == 150ms);
+
+  // a new message that stalls is a new report
+  watchdog.beginMessage(3, 0, 0);
+  advance(200ms);
+  assert(watchdog.check());
+  watchdog.endMessage();
+
+  assert(watchdog.getStallCount() == 2);
+  assert(log.reports.size() == 2);
+  assert(log.reports[1].messageCount == 3);
+  assert(log.reports[1].idleBefore == 0ms);
+}
+
+static void test_nested_messages()
+{
+  HangWatchdog watchdog(fake_clock);
+  watchdog.setThreshold(100ms);
+  StallLog log(watchdog);
+  int widget = 0;
+
+  watchdog.beginMessage(1, 0, 0, &widget, &typeid(widget));
+  advance(20ms);
+  watchdog.beginMessage(2, 0, 0);      // e.g. a modal loop
+  advance(30ms);
+  watchdog.beginMessage(3, 0, 0);
+  advance(60ms);
+
+  assert(watchdog.check());
+  assert(log.reports.size() == 1);
+
+  const StallReport& report = log.reports[0];
+  assert(report.duration == 110ms);
+  assert(report.frames.size() == 3);
+  assert(report.frames[0].widget == &widget);
+  assert(report.frames[0].className == typeid(widget).name());
+  assert(report.frames[1].className.empty());
+  assert(report.frames[0].elapsed == 110ms);
+  assert(report.frames[0].self == 20ms);
+  assert(report.frames[1].elapsed == 90ms);
+  assert(report.frames[1].self == 30ms);
+  assert(report.frames[2].elapsed == 60ms);
+  assert(report.frames[2].self == 60ms);
+
+  watchdog.endMessage();
+  watchdog.endMessage();
+  // the first message is still in process, it was already reported
+  advance(100ms);
+  assert(!watchdog.check());
+  watchdog.endMessage();
+
+  // nested messages count as one message of the loop
+  watchdog.beginMessage(4, 0, 0);
+  advance(100ms);
+  assert(watchdog.check());
+  watchdog.endMessage();
+  assert(log.reports[1].messageCount == 1);
+}
+
+static void test_json()
+{
+  HangWatchdog watchdog(fake_clock);
+  watchdog.setThreshold(1ms);
+  StallLog log(watchdog);
+
+  watchdog.beginMessage(15, 1, 2);
+  advance(2500us);
+  assert(watchdog.check());
+  watchdog.endMessage();
+
+  std::string json = log.reports[0].getJson();
+  assert(json.front() == '{' && json.back() == '}');
+  assert(json.find("\"duration_ms\":2.500") != std::string::npos);
+  assert(json.find("\"message\":15") != std::string::npos);
+  assert(json.find("\"wparam\":1") != std::string::npos);
+  assert(json.find("\"lparam\":2") != std::string::npos);
+}
+
+static void test_scope()
+{
+  HangWatchdog watchdog(fake_clock);
+  watchdog.setThreshold(10ms);
+  StallLog log(watchdog);
+
+  assert(HangWatchdog::getCurrent() == nullptr);
+  {
+    // without a watchdog in the thread it does nothing
+    HangWatchdog::Scope scope(1, 0, 0, nullptr, nullptr);
+  }
+
+  watchdog.attach();
+  assert(HangWatchdog::getCurrent() == &watchdog);
+  {
+    HangWatchdog::Scope scope(2, 0, 0, nullptr, nullptr);
+    advance(20ms);
+    assert(watchdog.check());
+  }
+  assert(!watchdog.check());
+  assert(log.reports[0].frames[0].message == 2);
+
+  watchdog.detach();
+  assert(HangWatchdog::getCurrent() == nullptr);
+}
+
+// The watchdog thread reports a stall of the current thread
+static void test_thread()
+{
+  HangWatchdog watchdog(fake_clock);
+  std::atomic<int> stalls(0);
+  watchdog.Stall.connect([&stalls](const StallReport&) { ++stalls; });
+
+  watchdog.start(10ms);
+  assert(watchdog.isRunning());
+
+  watchdog.beginMessage(1, 0, 0);
+  advance(20ms);
+  for (int i=0; i<5000 && stalls == 0; ++i)
+    CurrentThread::sleep(1);
+  watchdog.endMessage();
+
+  watchdog.stop();
+  assert(!watchdog.isRunning());
+  assert(stalls == 1);
+  assert(watchdog.getStallCount() == 1);
+
+  // it can be started again
+  watchdog.start(10ms);
+  watchdog.stop();
+  assert(!watchdog.isRunning());
+}
+
+int main()
+{
+  test_under_threshold();
+  test_stall_reported_once();
+  test_nested_messages();
+  test_json();
+  test_scope();
+  test_thread();
+  return 0;
+}
@@ -0,0 +1,53 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <cassert>
+
+#include "Wg/ImageComparison.hpp"
+#include "Wg/ImagePixels.hpp"
+
+using namespace Wg;
+
+static ImagePixels make_gradient(int w, int h)
+{
+  ImagePixels pixels(w, h);
+  for (int y = 0; y < h; ++y)
+    for (int x = 0; x < w; ++x)
+      pixels.setPixel(x, y, ImagePixels::makePixel(x * 255 / w, y * 255 / h, (x ^ y) & 0xff, 255));
+  return pixels;
+}
+
+static void test_ssim_of_identical_images()
+{
+  ImagePixels a = make_gradient(32, 24);
+  ImagePixels b = a.clone();
+
+  ImageComparison cmp;
+  cmp.setMetric(ImageMetric::Ssim);
+  assert(cmp.compare(a, b));
+  assert(cmp.getSsim() == 1.0);
+  assert(cmp.getDifferentPixels() == 0);
+}
+
+static void test_ssim_of_different_images()
+{
+  ImagePixels a = make_gradient(32, 24);
+  ImagePixels b = a.clone();
+  for (int x = 0; x < 32; ++x)
+    b.setPixel(x, 12, ImagePixels::makePixel(0, 0, 0, 255));
+
+  ImageComparison cmp;
+  cmp.setMetric(ImageMetric::Ssim);
+  cmp.compare(a, b);
+  assert(cmp.getSsim() < 1.0);
+}
+
+int main()
+{
+  test_ssim_of_identical_images();
+  test_ssim_of_different_images();
+  return 0;
+}
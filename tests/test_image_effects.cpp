@@ -0,0 +1,63 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <cassert>
+
+#include "Wg/ImageEffects.hpp"
+#include "Wg/ImagePixels.hpp"
+
+using namespace Wg;
+
+// A blurred point must spread in the same way to all directions
+static void check_symmetry(const ImagePixels &pixels, int cx, int cy)
+{
+  for (int d = 0; d <= cx; ++d) {
+    ImagePixels::pixel_type c = pixels.getPixel(cx + d, cy);
+    assert(pixels.getPixel(cx - d, cy) == c);
+    assert(pixels.getPixel(cx, cy + d) == c);
+    assert(pixels.getPixel(cx, cy - d) == c);
+  }
+  for (int d = 1; d <= cx; ++d) {
+    ImagePixels::pixel_type c = pixels.getPixel(cx + d, cy + d);
+    assert(pixels.getPixel(cx - d, cy - d) == c);
+    assert(pixels.getPixel(cx + d, cy - d) == c);
+    assert(pixels.getPixel(cx - d, cy + d) == c);
+  }
+}
+
+static ImagePixels make_point_image()
+{
+  ImagePixels pixels(17, 17);
+  pixels.setPixel(8, 8, ImagePixels::makePixel(255, 255, 255, 255));
+  return pixels;
+}
+
+static void test_box_blur_symmetry()
+{
+  ImagePixels pixels = make_point_image();
+  ImageEffects::boxBlur(pixels, 2);
+
+  check_symmetry(pixels, 8, 8);
+  assert(ImagePixels::getA(pixels.getPixel(8, 8)) > 0);
+  assert(ImagePixels::getA(pixels.getPixel(8, 8)) < 255);
+}
+
+static void test_gaussian_blur_symmetry()
+{
+  ImagePixels pixels = make_point_image();
+  ImageEffects::gaussianBlur(pixels, 1.5);
+
+  check_symmetry(pixels, 8, 8);
+  assert(ImagePixels::getA(pixels.getPixel(8, 8)) > ImagePixels::getA(pixels.getPixel(9, 8)));
+  assert(ImagePixels::getA(pixels.getPixel(0, 0)) == 0);
+}
+
+int main()
+{
+  test_box_blur_symmetry();
+  test_gaussian_blur_symmetry();
+  return 0;
+}
@@ -0,0 +1,73 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <cassert>
+#include <cstdlib>
+
+#include "Wg/Color.hpp"
+#include "Wg/ImagePixels.hpp"
+#include "Wg/PathRasterizer.hpp"
+
+using namespace Wg;
+
+static int alpha_at(const ImagePixels &pixels, int x, int y)
+{
+  return ImagePixels::getA(pixels.getPixel(x, y));
+}
+
+static void add_rect(PathRasterizer &ras, double x1, double y1, double x2, double y2)
+{
+  ras.moveTo(x1, y1);
+  ras.lineTo(x2, y1);
+  ras.lineTo(x2, y2);
+  ras.lineTo(x1, y2);
+  ras.closeFigure();
+}
+
+// A vertical edge in the middle of a pixel covers half of it
+static void test_half_pixel_edge()
+{
+  ImagePixels pixels(8, 8);
+  PathRasterizer ras;
+  add_rect(ras, 1, 1, 4.5, 7);
+  ras.fill(pixels, Color::Black, FillRule::Winding);
+
+  for (int y = 1; y < 7; ++y) {
+    assert(alpha_at(pixels, 0, y) == 0);
+    assert(alpha_at(pixels, 1, y) == 255);
+    assert(alpha_at(pixels, 3, y) == 255);
+    assert(std::abs(alpha_at(pixels, 4, y) - 128) <= 1);
+    assert(alpha_at(pixels, 5, y) == 0);
+  }
+  assert(alpha_at(pixels, 2, 0) == 0);
+  assert(alpha_at(pixels, 2, 7) == 0);
+}
+
+// Two overlapped squares with the same orientation: the intersection
+// is a hole with the even-odd rule and it is filled with winding
+static void test_even_odd_vs_winding()
+{
+  for (int i = 0; i < 2; ++i) {
+    FillRule rule = (i == 0 ? FillRule::EvenOdd: FillRule::Winding);
+    ImagePixels pixels(10, 10);
+    PathRasterizer ras;
+    add_rect(ras, 0, 0, 6, 6);
+    add_rect(ras, 3, 3, 9, 9);
+    ras.fill(pixels, Color::Black, rule);
+
+    assert(alpha_at(pixels, 1, 1) == 255);
+    assert(alpha_at(pixels, 7, 7) == 255);
+    assert(alpha_at(pixels, 4, 4) == (rule == FillRule::EvenOdd ? 0: 255));
+    assert(alpha_at(pixels, 8, 1) == 0);
+  }
+}
+
+int main()
+{
+  test_half_pixel_edge();
+  test_even_odd_vs_winding();
+  return 0;
+}
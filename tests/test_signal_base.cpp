@@ -0,0 +1,226 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "Wg/Signal2.hpp"
+
+using namespace Wg;
+
+typedef UniqueSignal<void(int)> IntSignal;
+typedef Callback<void(int)> IntCallback;
+
+// Records the calls of its slot, and can modify the signal while it
+// is being emitted
+struct Receiver {
+  int id;
+  std::vector<int>* log;
+  IntSignal* signal;
+  void (*action)(Receiver&);
+
+  void onValue(int value) {
+    log->push_back(id * 100 + value);
+    if (action != nullptr)
+      action(*this);
+  }
+
+  IntCallback callback() {
+    IntCallback cb;
+    cb.Use<Receiver, &Receiver::onValue>(this);
+    return cb;
+  }
+};
+
+static void make_receivers(std::vector<Receiver>& receivers, int count,
+                           std::vector<int>& log, IntSignal& signal)
+{
+  for (int i=0; i<count; ++i)
+    receivers.push_back(Receiver{ i+1, &log, &signal, nullptr });
+}
+
+static void test_connect_and_emit()
+{
+  IntSignal signal;
+  std::vector<int> log;
+  std::vector<Receiver> r;
+  make_receivers(r, 3, log, signal);
+
+  assert(signal.Empty());
+  for (auto& receiver : r)
+    assert(signal.Connect(receiver.callback()));
+  assert(!signal.Empty());
+
+  signal.Emit(5);
+  assert((log == std::vector<int>{ 105, 205, 305 }));
+
+  assert(signal.Exists(r[1].callback()));
+  assert(signal.Count(r[1].callback()) == 1);
+  assert(signal.CountExec(r[1].callback()) == 3);
+  assert(signal.Disconnect(r[1].callback()) == 1);
+  assert(!signal.Exists(r[1].callback()));
+
+  log.clear();
+  signal.Emit(1);
+  assert((log == std::vector<int>{ 101, 301 }));
+}
+
+// More slots than the local buffer (the heap buffer grows)
+static void test_expand()
+{
+  IntSignal signal;
+  std::vector<int> log;
+  std::vector<Receiver> r;
+  make_receivers(r, 20, log, signal);
+
+  for (auto& receiver : r)
+    signal.Connect(receiver.callback());
+
+  signal.Emit(0);
+  assert(log.size() == 20);
+  for (int i=0; i<20; ++i)
+    assert(log[i] == (i+1) * 100);
+}
+
+// A slot that disconnects the next one during the emission
+static void test_disconnect_while_emitting()
+{
+  IntSignal signal;
+  std::vector<int> log;
+  std::vector<Receiver> r;
+  make_receivers(r, 4, log, signal);
+
+  r[1].action = [](Receiver& self) {
+    Receiver* next = &self + 1;
+    self.signal->Disconnect(next->callback());
+  };
+  for (auto& receiver : r)
+    signal.Connect(receiver.callback());
+
+  signal.Emit(0);
+  assert((log == std::vector<int>{ 100, 200, 400 }));
+}
+
+// A slot that disconnects itself (the following slots must be called)
+static void test_disconnect_itself_while_emitting()
+{
+  IntSignal signal;
+  std::vector<int> log;
+  std::vector<Receiver> r;
+  make_receivers(r, 3, log, signal);
+
+  r[0].action = [](Receiver& self) {
+    self.signal->Disconnect(self.callback());
+  };
+  for (auto& receiver : r)
+    signal.Connect(receiver.callback());
+
+  signal.Emit(0);
+  assert((log == std::vector<int>{ 100, 200, 300 }));
+
+  log.clear();
+  signal.Emit(0);
+  assert((log == std::vector<int>{ 200, 300 }));
+}
+
+// Slots connected during an emission are called in the next one, even
+// if the buffer has to be reallocated
+static void test_connect_while_emitting()
+{
+  IntSignal signal;
+  std::vector<int> log;
+  std::vector<Receiver> r;
+  r.reserve(10);
+  make_receivers(r, 10, log, signal);
+
+  r[0].action = [](Receiver& self) {
+    for (int i=1; i<10; ++i)
+      self.signal->Connect((&self + i)->callback());
+    self.action = nullptr;
+  };
+  signal.Connect(r[0].callback());
+
+  signal.Emit(0);
+  assert((log == std::vector<int>{ 100 }));
+
+  log.clear();
+  signal.Emit(0);
+  assert(log.size() == 10);
+}
+
+static void test_clear_while_emitting()
+{
+  IntSignal signal;
+  std::vector<int> log;
+  std::vector<Receiver> r;
+  make_receivers(r, 3, log, signal);
+
+  r[0].action = [](Receiver& self) { self.signal->Clear(); };
+  for (auto& receiver : r)
+    signal.Connect(receiver.callback());
+
+  signal.Emit(0);
+  assert((log == std::vector<int>{ 100 }));
+  assert(signal.Empty());
+}
+
+static void test_lead_and_tail()
+{
+  IntSignal signal;
+  std::vector<int> log;
+  std::vector<Receiver> r;
+  make_receivers(r, 4, log, signal);
+
+  for (auto& receiver : r)
+    signal.Connect(receiver.callback());
+
+  signal.Lead(r[2].callback());
+  signal.Emit(0);
+  assert((log == std::vector<int>{ 300, 100, 200, 400 }));
+
+  log.clear();
+  signal.Tail(r[0].callback());
+  signal.Emit(0);
+  assert((log == std::vector<int>{ 300, 200, 400, 100 }));
+}
+
+// The moved signal keeps the slots (local buffer and heap buffer)
+static void test_move()
+{
+  for (int count : { 1, 8 }) {
+    IntSignal signal;
+    std::vector<int> log;
+    std::vector<Receiver> r;
+    make_receivers(r, count, log, signal);
+
+    for (auto& receiver : r)
+      signal.Connect(receiver.callback());
+
+    IntSignal moved(std::move(signal));
+    assert(signal.Empty());
+
+    moved.Emit(0);
+    assert(static_cast<int>(log.size()) == count);
+
+    log.clear();
+    signal.Emit(0);
+    assert(log.empty());
+  }
+}
+
+int main()
+{
+  test_connect_and_emit();
+  test_expand();
+  test_disconnect_while_emitting();
+  test_disconnect_itself_while_emitting();
+  test_connect_while_emitting();
+  test_clear_while_emitting();
+  test_lead_and_tail();
+  test_move();
+  return 0;
+}
@@ -0,0 +1,214 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <cassert>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Wg/SignalN.hpp"
+
+using namespace Wg;
+
+typedef SignalN<void(int)> IntSignal;
+
+// A small functor that is not trivially copyable, it counts its live
+// copies
+struct Counted {
+  static int alive;
+
+  std::vector<int>* log;
+  int id;
+
+  Counted(std::vector<int>* log, int id) : log(log), id(id) { ++alive; }
+  Counted(const Counted& other) : log(other.log), id(other.id) { ++alive; }
+  ~Counted() { --alive; }
+
+  void operator()(int value) {
+    log->push_back(id * 100 + value);
+  }
+};
+
+int Counted::alive = 0;
+
+static_assert(sizeof(Counted) <= IntSignal::InlineSize, "Counted must be inline");
+static_assert(!std::is_trivially_copyable<Counted>::value, "Counted needs a manager");
+
+// A big functor that is not trivially copyable
+struct Named {
+  std::vector<int>* log;
+  std::string name;
+
+  void operator()(int value) {
+    log->push_back(static_cast<int>(name.size()) * 100 + value);
+  }
+};
+
+// A functor bigger than the inline storage of a slot
+struct Big {
+  std::vector<int>* log;
+  int data[16];
+
+  void operator()(int value) {
+    int sum = 0;
+    for (int x : data)
+      sum += x;
+    log->push_back(sum + value);
+  }
+};
+
+static_assert(sizeof(Big) > IntSignal::InlineSize, "Big must be allocated");
+static_assert(sizeof(Named) > IntSignal::InlineSize, "Named must be allocated");
+
+struct Receiver {
+  std::vector<int>* log;
+  int id;
+
+  void onValue(int value) { log->push_back(id * 100 + value); }
+};
+
+static void test_size()
+{
+  // an empty signal does not have the state of the connections
+  static_assert(sizeof(IntSignal) == 2 * sizeof(void*) + 2 * sizeof(unsigned),
+                "an empty SignalN must be two pointers and two integers");
+
+  IntSignal signal;
+  assert(signal.empty());
+  assert(signal.getSlotCount() == 0);
+  signal(1);                    // nothing to call
+
+  SignalN<int(int)> result;
+  assert(result(1) == 0);
+}
+
+static void test_inline_and_heap_slots()
+{
+  std::vector<int> log;
+  Receiver receiver{ &log, 3 };
+  Big big{ &log, {} };
+  for (int i=0; i<16; ++i)
+    big.data[i] = 1000;
+
+  {
+    IntSignal signal;
+    signal.connect([&log](int value) { log.push_back(value); });      // inline lambda
+    signal.connect(&Receiver::onValue, &receiver);                     // inline binding
+    signal.connect(big);                                               // allocated
+    signal.connect(Counted(&log, 2));                                  // inline with a manager
+    signal.connect(Named{ &log, "name" });                             // allocated with a manager
+    assert(signal.getSlotCount() == 5);
+    assert(Counted::alive == 1);
+
+    signal(5);
+    assert((log == std::vector<int>{ 5, 305, 16005, 205, 405 }));
+
+    // the copy of a signal copies the functors
+    IntSignal copy(signal);
+    assert(Counted::alive == 2);
+    log.clear();
+    copy(1);
+    assert((log == std::vector<int>{ 1, 301, 16001, 201, 401 }));
+
+    copy.disconnect(&Receiver::onValue, &receiver);
+    assert(copy.getSlotCount() == 4);
+    assert(signal.getSlotCount() == 5);
+  }
+  assert(Counted::alive == 0);
+}
+
+// The functors that are not trivially copyable are copied with their
+// copy constructor when the array grows or is compacted
+static void test_relocation()
+{
+  std::vector<int> log;
+  std::vector<Connection> connections;
+
+  {
+    IntSignal signal;
+    for (int i=0; i<40; ++i)
+      connections.push_back(signal.connect(Counted(&log, i+1)));
+    assert(Counted::alive == 40);
+
+    // disconnect the even slots (it compacts the array)
+    for (int i=0; i<40; i+=2)
+      connections[i].disconnect();
+    assert(signal.getSlotCount() == 20);
+    assert(Counted::alive == 20);
+
+    signal(0);
+    assert(log.size() == 20);
+    for (int i=0; i<20; ++i)
+      assert(log[i] == (2*i+2) * 100);
+  }
+  assert(Counted::alive == 0);
+}
+
+// A slot that connects so many slots that the array grows: the old
+// array (where the running slot lives) is kept until the emission
+// finishes
+struct Grower {
+  IntSignal* signal;
+  std::vector<int>* log;
+  int tag;
+
+  void operator()(int value) {
+    for (int i=0; i<64; ++i)
+      signal->connect(Counted(log, 3));
+    // the members of this functor (stored inline in the old array)
+    // must be still valid
+    log->push_back(tag + value);
+  }
+};
+
+static_assert(sizeof(Grower) <= IntSignal::InlineSize, "Grower must be inline");
+
+static void test_growth_while_emitting()
+{
+  std::vector<int> log;
+
+  {
+    IntSignal signal;
+    Connection grower = signal.connect(Grower{ &signal, &log, 6 });
+    signal.connect(Counted(&log, 1));
+
+    signal(1000);
+    // the new slots are called in the next emission
+    assert((log == std::vector<int>{ 1006, 1100 }));
+    assert(signal.getSlotCount() == 66);
+    assert(Counted::alive == 65);
+
+    grower.disconnect();
+    log.clear();
+    signal(0);
+    assert(log.size() == 65);
+    assert(log[0] == 100);
+    assert(log[1] == 300);
+  }
+  assert(Counted::alive == 0);
+}
+
+// The value returned by the last slot
+static void test_return_value()
+{
+  SignalN<int(int)> signal;
+  signal.connect([](int value) { return value + 1; });
+  Connection last = signal.connect([](int value) { return value * 10; });
+
+  assert(signal(4) == 40);
+  last.disconnect();
+  assert(signal(4) == 5);
+}
+
+int main()
+{
+  test_size();
+  test_inline_and_heap_slots();
+  test_relocation();
+  test_growth_while_emitting();
+  test_return_value();
+  return 0;
+}
@@ -0,0 +1,67 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <cassert>
+#include <vector>
+
+#include "Wg/Point.hpp"
+#include "Wg/Rect.hpp"
+#include "Wg/Size.hpp"
+#include "Wg/SkylinePacker.hpp"
+
+using namespace Wg;
+
+// Rect::intersects() is true for rectangles that only share an edge
+static bool overlap(const Rect &a, const Rect &b)
+{
+  return
+    a.x < b.x+b.w && b.x < a.x+a.w &&
+    a.y < b.y+b.h && b.y < a.y+a.h;
+}
+
+// Inserts rectangles of different sizes until the packer is full, no
+// rectangle can be outside the bounds or overlap other one
+static void test_no_overlaps()
+{
+  SkylinePacker packer(Size(128, 128));
+  Rect bounds(0, 0, 128, 128);
+  std::vector<Rect> rects;
+
+  for (int i = 0; i < 200; ++i) {
+    Size sz(4 + (i * 7) % 23, 3 + (i * 11) % 17);
+    Point origin;
+    if (!packer.insert(sz, origin))
+      continue;
+
+    Rect rc(origin, sz);
+    assert(bounds.contains(rc));
+    for (const Rect &other : rects)
+      assert(!overlap(rc, other));
+    rects.push_back(rc);
+  }
+
+  assert(!rects.empty());
+  assert(packer.getOccupancy() > 0.0 && packer.getOccupancy() <= 1.0);
+}
+
+static void test_clear()
+{
+  SkylinePacker packer(Size(16, 16));
+  Point origin;
+  assert(packer.insert(Size(16, 16), origin));
+  assert(origin == Point(0, 0));
+  assert(!packer.insert(Size(1, 1), origin));
+
+  packer.clear();
+  assert(packer.insert(Size(16, 16), origin));
+}
+
+int main()
+{
+  test_no_overlaps();
+  test_clear();
+  return 0;
+}
@@ -0,0 +1,125 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <atomic>
+#include <cassert>
+
+#include "Wg/Clock.hpp"
+#include "Wg/Task.hpp"
+#include "Wg/Timer.hpp"
+
+using namespace Wg;
+
+#ifdef VACA_HAS_COROUTINES
+
+using namespace std::chrono_literals;
+
+// The delays use the time of a virtual clock
+static VirtualClock virtual_clock;
+
+// Where each part of a coroutine was run
+struct Trace {
+  std::atomic<int> step{ 0 };
+  ThreadPool* pool = nullptr;
+  ThreadId thread = 0;
+};
+
+static Task<void> delay_in_thread(Trace& trace)
+{
+  trace.step = 1;
+  co_await delay(100);
+  trace.thread = CurrentThread::getId();
+  trace.step = 2;
+}
+
+static Task<void> delay_on_pool(ThreadPool& pool, Trace& trace)
+{
+  co_await resumeOnPool(pool);
+  trace.step = 1;
+  co_await delay(100);
+  trace.pool = ThreadPool::getCurrent();
+  trace.step = 2;
+}
+
+static void test_delay_in_thread()
+{
+  Trace trace;
+  delay_in_thread(trace).start();
+  assert(trace.step == 1);
+
+  virtual_clock.advance(99ms);
+  Timer::pollTimers();
+  assert(trace.step == 1);
+
+  virtual_clock.advance(1ms);
+  Timer::pollTimers();
+  assert(trace.step == 2);
+  assert(trace.thread == CurrentThread::getId());
+}
+
+// The workers do not process timers, the delay is resumed by a task
+// of the pool
+static void test_delay_on_pool()
+{
+  ThreadPool pool(2);
+  Trace trace;
+
+  delay_on_pool(pool, trace).start();
+  pool.wait();                  // the coroutine is waiting the delay
+  assert(trace.step == 1);
+
+  virtual_clock.advance(99ms);
+  Timer::pollTimers();
+  pool.wait();
+  assert(trace.step == 1);
+
+  virtual_clock.advance(1ms);
+  Timer::pollTimers();          // it only expires the timer
+  pool.wait();
+  assert(trace.step == 2);
+  assert(trace.pool == &pool);
+}
+
+// Many coroutines that wait in the pool at the same time
+static void test_many_delays_on_pool()
+{
+  ThreadPool pool(4);
+  Trace traces[100];
+
+  for (Trace& trace : traces)
+    delay_on_pool(pool, trace).start();
+  pool.wait();
+
+  virtual_clock.advance(100ms);
+  Timer::pollTimers();
+  pool.wait();
+
+  for (Trace& trace : traces) {
+    assert(trace.step == 2);
+    assert(trace.pool == &pool);
+  }
+}
+
+int main()
+{
+  Clock::setCurrent(&virtual_clock);
+
+  test_delay_in_thread();
+  test_delay_on_pool();
+  test_many_delays_on_pool();
+
+  Clock::setCurrent(nullptr);
+  return 0;
+}
+
+#else
+
+int main()
+{
+  return 0;
+}
+
+#endif
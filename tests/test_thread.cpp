@@ -0,0 +1,93 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <atomic>
+#include <cassert>
+
+#include "Wg/Thread.hpp"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+using namespace Wg;
+
+static void test_run_and_join()
+{
+  std::atomic<int> value(0);
+  ThreadId id = 0;
+
+  Thread thread([&value, &id] {
+    id = CurrentThread::getId();
+    value = 1;
+  });
+  assert(thread.isJoinable());
+  thread.join();
+
+  assert(value == 1);
+  assert(id == thread.getId());
+  assert(id != CurrentThread::getId());
+}
+
+#ifdef __linux__
+
+// Returns the nice value of the current thread
+static int get_current_nice()
+{
+  return getpriority(PRIO_PROCESS, 0);
+}
+
+// The priority is a nice value of the thread (and not of the process)
+static void test_priority()
+{
+  int base = get_current_nice();
+  std::atomic<bool> go(false);
+  int nice = 0;
+
+  Thread thread([&go, &nice] {
+    while (!go)
+      CurrentThread::yield();
+    nice = get_current_nice();
+  });
+
+  // it can be called before or after the thread starts
+  thread.setThreadPriority(ThreadPriority::Lowest);
+  go = true;
+  thread.join();
+
+  // (a lower value than the one of the process needs privileges)
+  assert(nice == 10 || base > 10);
+  assert(get_current_nice() == base);
+}
+
+// The current thread changes its own priority
+static void test_current_thread_priority()
+{
+  int base = get_current_nice();
+  int nice = 0;
+
+  Thread thread([&nice] {
+    Thread current;
+    current.setThreadPriority(ThreadPriority::Low);
+    nice = get_current_nice();
+  });
+  thread.join();
+
+  assert(nice == 5 || base > 5);
+  assert(get_current_nice() == base);
+}
+
+#endif
+
+int main()
+{
+  test_run_and_join();
+#ifdef __linux__
+  test_priority();
+  test_current_thread_priority();
+#endif
+  return 0;
+}
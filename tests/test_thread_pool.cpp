@@ -0,0 +1,192 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+#include "Wg/Mutex.hpp"
+#include "Wg/ScopedLock.hpp"
+#include "Wg/Thread.hpp"
+#include "Wg/ThreadPool.hpp"
+
+using namespace Wg;
+
+// The IDs of the tasks in the order they were run
+struct RunLog {
+  Mutex mutex;
+  std::vector<int> ids;
+
+  void add(int id) {
+    ScopedLock hold(mutex);
+    ids.push_back(id);
+  }
+};
+
+// A task that keeps a worker busy until it is released
+struct Blocker {
+  std::atomic<bool> started{ false };
+  std::atomic<bool> released{ false };
+
+  void post(ThreadPool& pool) {
+    pool.post([this] {
+      started = true;
+      while (!released)
+        CurrentThread::yield();
+    });
+    while (!started)
+      CurrentThread::yield();
+  }
+};
+
+// A task is not started while there are tasks with a higher priority
+static void test_priorities()
+{
+  ThreadPool pool(1);
+  Blocker blocker;
+  RunLog log;
+
+  blocker.post(pool);
+  pool.post([&log] { log.add(1); }, TaskPriority::Low);
+  pool.post([&log] { log.add(2); }, TaskPriority::Normal);
+  pool.post([&log] { log.add(3); }, TaskPriority::High);
+  pool.post([&log] { log.add(4); }, TaskPriority::Low);
+  pool.post([&log] { log.add(5); }, TaskPriority::High);
+  assert(pool.getPendingCount() == 5);
+
+  blocker.released = true;
+  pool.wait();
+  assert(pool.getPendingCount() == 0);
+
+  // the tasks of the same priority are run in the order they were
+  // posted
+  assert((log.ids == std::vector<int>{ 3, 5, 2, 1, 4 }));
+}
+
+// The tasks of a canceled token are not started
+static void test_cancellation()
+{
+  ThreadPool pool(1);
+  Blocker blocker;
+  RunLog log;
+  CancellationToken token;
+  CancellationToken other;
+
+  blocker.post(pool);
+  for (int i=0; i<10; ++i)
+    pool.post([&log] { log.add(1); }, token);
+  pool.post([&log] { log.add(2); }, other);
+  pool.post([&log] { log.add(3); });
+
+  token.cancel();
+  assert(token.isCanceled());
+  assert(!other.isCanceled());
+
+  blocker.released = true;
+  pool.wait();
+  assert((log.ids == std::vector<int>{ 2, 3 }));
+
+  // a running task can check the token to stop
+  CancellationToken running;
+  std::atomic<bool> started(false);
+  std::atomic<bool> stopped(false);
+  pool.post([&started, &stopped, running] {
+    started = true;
+    while (!running.isCanceled())
+      CurrentThread::yield();
+    stopped = true;
+  }, running);
+  while (!started)
+    CurrentThread::yield();
+  running.cancel();
+  pool.wait();
+  assert(stopped);
+}
+
+// The tasks posted from a worker go to its own queues: it takes the
+// newest one first, and other workers steal the oldest ones
+static void test_own_queues()
+{
+  {
+    ThreadPool pool(1);
+    RunLog log;
+
+    pool.post([&pool, &log] {
+      assert(ThreadPool::getCurrent() == &pool);
+      for (int i=1; i<=4; ++i)
+        pool.post([&log, i] { log.add(i); });
+    });
+    pool.wait();
+    assert((log.ids == std::vector<int>{ 4, 3, 2, 1 }));
+  }
+
+  {
+    ThreadPool pool(2);
+    RunLog log;
+    std::atomic<ThreadId> parent(0);
+    std::atomic<int> stolen(0);
+
+    // the parent does not return until its children are finished, so
+    // the other worker must steal them (oldest first)
+    pool.post([&] {
+      parent = CurrentThread::getId();
+      for (int i=1; i<=4; ++i) {
+        pool.post([&, i] {
+          if (CurrentThread::getId() != parent)
+            ++stolen;
+          log.add(i);
+        });
+      }
+      while (stolen < 4)
+        CurrentThread::yield();
+    });
+    pool.wait();
+    assert(stolen == 4);
+    assert((log.ids == std::vector<int>{ 1, 2, 3, 4 }));
+  }
+
+  assert(ThreadPool::getCurrent() == nullptr);
+}
+
+// Posts a tree of tasks: each task posts "children" tasks until the
+// given depth
+static void post_tree(ThreadPool& pool, std::atomic<int>& count,
+                      int children, int depth)
+{
+  pool.post([&pool, &count, children, depth] {
+    ++count;
+    if (depth > 0) {
+      for (int i=0; i<children; ++i)
+        post_tree(pool, count, children, depth-1);
+    }
+  });
+}
+
+// wait() does not return while a task can post other tasks
+static void test_wait_nested()
+{
+  ThreadPool pool(4);
+
+  for (int round=0; round<200; ++round) {
+    std::atomic<int> count(0);
+    post_tree(pool, count, 3, 3);       // 1 + 3 + 9 + 27 tasks
+    pool.wait();
+    assert(count == 40);
+    assert(pool.getPendingCount() == 0);
+  }
+
+  // an empty pool does not wait
+  pool.wait();
+}
+
+int main()
+{
+  test_priorities();
+  test_cancellation();
+  test_own_queues();
+  test_wait_nested();
+  return 0;
+}
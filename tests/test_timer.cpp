@@ -0,0 +1,190 @@
+// Vaca - Visual Application Components Abstraction
+// Copyright (c) 2005-2010 David Capello
+//
+// This file is distributed under the terms of the MIT license,
+// please read LICENSE.txt for more information.
+
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+#include "Wg/Clock.hpp"
+#include "Wg/TimePoint.hpp"
+#include "Wg/Timer.hpp"
+
+using namespace Wg;
+using namespace std::chrono_literals;
+
+// The time of all the tests is a virtual clock, so they do not wait
+static VirtualClock virtual_clock;
+
+// A timer that counts its ticks and can run an action in each tick
+class TestTimer : public Timer {
+public:
+  int ticks = 0;
+  void (*action)(TestTimer&) = nullptr;
+
+  TestTimer(int interval, int slack = 0)
+    : Timer(interval, slack) { }
+
+protected:
+  void onTick() override {
+    ++ticks;
+    if (action != nullptr)
+      action(*this);
+  }
+};
+
+// Advances the clock and fires the expired timers
+static void advance(std::chrono::nanoseconds time)
+{
+  virtual_clock.advance(time);
+  Timer::pollTimers();
+}
+
+static void test_clock()
+{
+  virtual_clock.setTime(1s);
+  assert(Clock::getCurrent().now() == 1s);
+  assert(!Clock::getCurrent().isRealTime());
+
+  TimePoint point;
+  virtual_clock.advance(250ms);
+  assert(point.elapsed() == 0.25);
+  point.reset();
+  assert(point.elapsed() == 0.0);
+}
+
+static void test_ticks()
+{
+  TestTimer timer(100);
+  timer.start();
+
+  advance(99ms);
+  assert(timer.ticks == 0);
+  advance(1ms);
+  assert(timer.ticks == 1);
+
+  // the ticks of a late poll are accumulated and the deadlines do not
+  // drift
+  advance(250ms);
+  assert(timer.ticks == 3);
+  advance(50ms);
+  assert(timer.ticks == 4);
+
+  // restarting the timer starts the interval again
+  advance(50ms);
+  timer.start();
+  advance(99ms);
+  assert(timer.ticks == 4);
+  advance(1ms);
+  assert(timer.ticks == 5);
+
+  timer.stop();
+  advance(1s);
+  assert(timer.ticks == 5);
+}
+
+static void test_coalescing()
+{
+  // the wheel starts in the time of the clock, a multiple of 128 ms
+  // aligns the rounded deadlines of the timers with slack
+  virtual_clock.setTime(128s);
+
+  TestTimer precise(128);
+  TestTimer lazy(120, 16);      // its deadline can be delayed until 128 ms
+  TestTimer exact(120);         // without slack it expires at 120 ms
+  precise.start();
+  lazy.start();
+  exact.start();
+
+  advance(120ms);
+  assert(exact.ticks == 1);
+  assert(lazy.ticks == 0);
+  assert(precise.ticks == 0);
+
+  advance(7ms);
+  assert(lazy.ticks == 0);
+  assert(precise.ticks == 0);
+
+  // the lazy timer expires together with the precise one
+  advance(1ms);
+  assert(lazy.ticks == 1);
+  assert(precise.ticks == 1);
+
+  // the slack does not accumulate: the next deadline is 240 ms
+  advance(112ms);
+  assert(lazy.ticks == 2);
+  assert(exact.ticks == 2);
+  assert(precise.ticks == 1);
+
+  lazy.stop();
+  exact.stop();
+  precise.stop();
+}
+
+// A timer whose ticks take too much time does not keep the thread
+// firing its accumulated ticks, the other timers get their ticks too
+static void test_fairness()
+{
+  TestTimer slow(10);
+  TestTimer fast(10);
+  slow.action = [](TestTimer&) { virtual_clock.advance(20ms); };
+  slow.start();
+  fast.start();
+
+  virtual_clock.advance(50ms);
+  Timer::pollTimers();
+  assert(slow.ticks == 1);      // the other 4 ticks were discarded
+  assert(fast.ticks == 5);
+
+  slow.stop();
+  fast.stop();
+}
+
+// All the expired timers of the thread are fired in the same poll
+static void test_many_timers()
+{
+  std::vector<TestTimer*> timers;
+  for (int i=0; i<1000; ++i) {
+    timers.push_back(new TestTimer(1 + i % 10));
+    timers.back()->start();
+  }
+
+  advance(10ms);
+  for (int i=0; i<1000; ++i)
+    assert(timers[i]->ticks == 10 / (1 + i % 10));
+
+  for (TestTimer* timer : timers)
+    delete timer;
+}
+
+static void test_stop_in_tick()
+{
+  TestTimer timer(10);
+  timer.action = [](TestTimer& self) { self.stop(); };
+  timer.start();
+
+  // the rest of accumulated ticks are discarded
+  advance(100ms);
+  assert(timer.ticks == 1);
+  assert(!timer.isRunning());
+
+  advance(100ms);
+  assert(timer.ticks == 1);
+}
+
+int main()
+{
+  Clock::setCurrent(&virtual_clock);
+
+  test_clock();
+  test_ticks();
+  test_coalescing();
+  test_fairness();
+  test_many_timers();
+  test_stop_in_tick();
+
+  Clock::setCurrent(nullptr);
+  return 0;
+}